@@ -16,6 +16,8 @@
 #include "TPeak.h"
 #include "TCanvas.h"
 
+class TAngularCorrelationAccumulator;
+
 class TAngularCorrelation : public TObject {
 private:
    TH1D* fIndexCorrelation;   /// 1D plot of counts vs. angular index
@@ -111,6 +113,7 @@ public:
    //----------------- functions that do most of the work
    TH2D*              Create2DSlice(THnSparse* hst, Double_t min, Double_t max, Bool_t fold, Bool_t group);
    TH2D*              Create2DSlice(TObjArray* hstarray, Double_t min, Double_t max, Bool_t fold, Bool_t group);
+   TH2D*              Create2DSlice(const TAngularCorrelationAccumulator* accumulator, Double_t min, Double_t max, Bool_t fold, Bool_t group, const char* name = "AngularCorrelation");
    TH2D*              Modify2DSlice(TH2* hst, Bool_t fold, Bool_t group);
    TH1D*              IntegralSlices(TH2* hst, Double_t min, Double_t max);
    TH1D*              FitSlices(TH2* hst, TPeak* peak, Bool_t visualization);
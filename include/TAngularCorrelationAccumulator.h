@@ -0,0 +1,118 @@
+#ifndef TANGULARCORRELATIONACCUMULATOR_H
+#define TANGULARCORRELATIONACCUMULATOR_H
+
+/** \addtogroup Analysis
+ *  @{
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class TAngularCorrelationAccumulator
+///
+/// Accumulates the gamma-gamma matrices of all angular indices of an
+/// angular correlation, as a replacement for a THnSparse (or an array
+/// of TH2) of angular index vs. energy vs. energy.
+///
+/// The matrices are symmetric, so only the upper triangle is stored,
+/// packed row by row, with 16 bit counts per cell. Cells exceeding
+/// that are carried into a small overflow map. A pair of two
+/// different bins is equivalent to filling a TH2 with (E1, E2) and
+/// (E2, E1), a pair within the same bin adds two counts to the
+/// diagonal, exactly as for the TH2.
+///
+/// Fill can be called from many threads at once: each thread collects
+/// its cells in a small buffer of its own (owned by the accumulator),
+/// which is only added to the matrices (under a lock) when it is full,
+/// and by Flush.
+///
+/// Projections for an energy gate sum the gated rows of the matrix.
+/// After BuildPrefixSums (which needs a full nBins x nBins table of
+/// 32 bit sums per index) they only need the difference of two rows,
+/// independent of the gate width, which makes scanning many gates
+/// fast.
+///
+/// The matrices can be exported as TH2D (per index), as a TObjArray
+/// of those, or as a THnSparse, and TAngularCorrelation::Create2DSlice
+/// accepts the accumulator directly.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "TH1D.h"
+#include "TH2D.h"
+#include "THnSparse.h"
+#include "TObjArray.h"
+
+#include "TPerThread.h"
+
+class TAngularCorrelationAccumulator {
+public:
+   TAngularCorrelationAccumulator(int nofIndices, int nofBins, double low, double high);
+   TAngularCorrelationAccumulator(const TAngularCorrelationAccumulator&)                = delete;
+   TAngularCorrelationAccumulator(TAngularCorrelationAccumulator&&) noexcept            = delete;
+   TAngularCorrelationAccumulator& operator=(const TAngularCorrelationAccumulator&)     = delete;
+   TAngularCorrelationAccumulator& operator=(TAngularCorrelationAccumulator&&) noexcept = delete;
+   ~TAngularCorrelationAccumulator()                                                    = default;
+
+   int    NumberOfIndices() const { return fNofIndices; }
+   int    NumberOfBins() const { return fNofBins; }
+   double Low() const { return fLow; }
+   double High() const { return fHigh; }
+   /// Bin of the energy (starting at zero), -1 if it is outside of the range.
+   int32_t Bin(double energy) const;
+
+   /// Adds the pair of energies to the matrix of the angular index, pairs outside of the range are ignored. Thread-safe.
+   void Fill(int index, double energy1, double energy2);
+   /// Adds the buffered pairs of all threads to the matrices. Must not be called while any thread is still filling.
+   void Flush();
+
+   /// Counts in the cell (bin1, bin2) of the matrix of the index (bins starting at zero), only includes flushed pairs.
+   uint64_t Counts(int index, int32_t bin1, int32_t bin2) const;
+
+   /// Builds the prefix sums used by Project, has to be called again after more pairs have been added.
+   void BuildPrefixSums();
+   void ClearPrefixSums() { fPrefixSums.clear(); }
+   bool HasPrefixSums() const { return !fPrefixSums.empty(); }
+
+   /// Counts of the matrix of the index projected onto one axis, with the other axis gated on the bins from min to max.
+   std::vector<uint64_t> Project(int index, double min, double max) const;
+   TH1D*                 Projection(int index, double min, double max, const char* name = "AngularCorrelationProjection") const;
+
+   //----------------- exporters, the caller owns the histograms
+   TH2D*      Matrix(int index, const char* baseName = "AngularCorrelation") const;   ///< matrix of one index, named <baseName><index>
+   TObjArray* Matrices(const char* baseName = "AngularCorrelation") const;            ///< matrices of all indices (owning the histograms)
+   THnSparse* Sparse(const char* name = "AngularCorrelation") const;                  ///< angular index vs. energy vs. energy
+
+private:
+   struct TFillBuffer {
+      std::vector<uint64_t> fCells;   ///< cells to increment, the highest bit marks diagonal cells (two counts)
+   };
+
+   static constexpr uint64_t kDiagonal   = 1ULL << 63;
+   static constexpr size_t   kBufferSize = 1 << 14;
+
+   size_t Cell(int index, int32_t bin1, int32_t bin2) const;
+   size_t RowStart(int32_t row) const { return static_cast<size_t>(row) * (2 * static_cast<size_t>(fNofBins) - row + 1) / 2; }
+
+   TFillBuffer& Buffer();
+   void         Add(const std::vector<uint64_t>& cells);   ///< needs fMutex to be locked
+
+   int     fNofIndices;
+   int32_t fNofBins;
+   double  fLow;
+   double  fHigh;
+   size_t  fCellsPerIndex;   ///< nBins*(nBins+1)/2
+
+   mutable std::mutex                   fMutex;
+   std::vector<uint16_t>                fCounts;       ///< [index][packed upper triangle]
+   std::unordered_map<size_t, uint64_t> fOverflow;     ///< multiples of 2^16 carried out of fCounts
+   TPerThread<TFillBuffer>              fBuffers;
+   std::vector<std::vector<uint32_t>>   fPrefixSums;   ///< [index][(row+1)*nBins+column] = sum of the rows up to row
+};
+/*! @} */
+#endif
@@ -32,6 +32,7 @@
 #include "TDetector.h"
 #include "TCSMHit.h"
 #include "TGRSIMnemonic.h"
+#include "TStripMatcher.h"
 
 class TCSM : public TDetector {
 public:
@@ -53,19 +54,30 @@ public:
    void BuildHits() override;
 
 private:
-   std::map<int16_t, std::vector<std::vector<std::vector<std::pair<TFragment, TGRSIMnemonic>>>>> fFragments;   //!<!
-   double                                                                                        fAlmostEqualWindow;
+   /// The parts of a fragment and its mnemonic that are needed to build the hits.
+   struct TCSMStrip {
+      double   fEnergy{0.};
+      Float_t  fCharge{0.};
+      Float_t  fCfd{0.};
+      Long64_t fTimeStamp{0};
+      int16_t  fDetector{0};
+      char     fPosition{0};   ///< 'D' or 'E'
+      int      fSegment{0};
+   };
+
+   std::map<int16_t, std::vector<std::vector<std::vector<TCSMStrip>>>> fStrips;   //!<!
+   double                                                               fAlmostEqualWindow;
 
    static int fCfdBuildDiff;   //!<! largest acceptable time difference between events (clock ticks)  (50 ns)
 
-   void     BuildVH(std::vector<std::vector<std::pair<TFragment, TGRSIMnemonic>>>&, std::vector<TDetectorHit*>&);
+   void     BuildVH(std::vector<std::vector<TCSMStrip>>&, std::vector<TDetectorHit*>&);
    void     BuilddEE(std::vector<std::vector<TDetectorHit*>>&, std::vector<TDetectorHit*>&);
    void     OldBuilddEE(std::vector<TDetectorHit*>&, std::vector<TDetectorHit*>&, std::vector<TDetectorHit*>&);
    void     MakedEE(std::vector<TDetectorHit*>& DHitVec, std::vector<TDetectorHit*>& EHitVec, std::vector<TDetectorHit*>& BuiltHits);
-   TCSMHit* MakeHit(std::pair<TFragment, TGRSIMnemonic>&, std::pair<TFragment, TGRSIMnemonic>&);
-   TCSMHit* MakeHit(std::vector<std::pair<TFragment, TGRSIMnemonic>>&, std::vector<std::pair<TFragment, TGRSIMnemonic>>&);
+   TCSMHit* MakeHit(const TCSMStrip&, const TCSMStrip&);
+   TCSMHit* MakeHit(const std::vector<const TCSMStrip*>&, const std::vector<const TCSMStrip*>&);
    TCSMHit* CombineHits(TDetectorHit*, TDetectorHit*);
-   void     RecoverHit(char, std::pair<TFragment, TGRSIMnemonic>&, std::vector<TDetectorHit*>&);
+   void     RecoverHit(char, const TCSMStrip&, std::vector<TDetectorHit*>&);
    bool     AlmostEqual(int, int) const;
    bool     AlmostEqual(double, double) const;
 
@@ -0,0 +1,121 @@
+#ifndef TCOUNTERRANDOM_H
+#define TCOUNTERRANDOM_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TCounterRandom
+///
+/// Counter-based random number generator (Philox4x32-10, see
+/// Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+/// SC11) used for the dithering and smearing of hits.
+///
+/// Unlike gRandom this has no shared state: the random numbers
+/// of a stream are a pure function of its key and counter. The
+/// key is derived from the run and subrun number, the counter
+/// from indices identifying the hit (e.g. its time stamp and
+/// address). The same hit therefore always gets the same random
+/// numbers, no matter which thread processes it or in which
+/// order the events are sorted.
+///
+/// For code that has no hit to identify, ThreadLocal() returns a
+/// per-thread stream. That is thread-safe, but only reproducible
+/// if all events are processed by one thread.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "TRunInfo.h"
+
+class TCounterRandom {
+public:
+   /// Separate streams for the different uses, so that e.g. the time and position smearing of a hit are independent.
+   enum class EStream : uint16_t { kDefault,
+                                   kTime,
+                                   kCfd,
+                                   kPosition,
+                                   kThread };
+
+   /// Stream of a hit identified by two indices (e.g. time stamp and address), the key is derived from the current
+   /// run and subrun number.
+   explicit TCounterRandom(uint64_t index0, uint32_t index1 = 0, EStream stream = EStream::kDefault) : TCounterRandom(RunKey(), index0, index1, stream) {}
+   TCounterRandom(uint64_t key, uint64_t index0, uint32_t index1, EStream stream)
+      : fKey{static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)},
+        fCounter{static_cast<uint32_t>(index0), static_cast<uint32_t>(index0 >> 32), index1, static_cast<uint32_t>(stream)}
+   {
+   }
+
+   /// Uniformly distributed number in [0, 1) with 53 random bits.
+   double Uniform()
+   {
+      if(fUsed >= fBuffer.size()) {
+         fBuffer     = Philox(fCounter, fKey);
+         fCounter[3] += 0x10000u;   // next block, the lower 16 bits are the stream
+         fUsed       = 0;
+      }
+      uint64_t bits = (static_cast<uint64_t>(fBuffer[fUsed]) << 32) | fBuffer[fUsed + 1];
+      fUsed += 2;
+      return static_cast<double>(bits >> 11) * 0x1.0p-53;
+   }
+   /// Uniformly distributed number in [low, high).
+   double Uniform(double low, double high) { return low + (high - low) * Uniform(); }
+   /// Random point on a circle with radius r (same as TRandom::Circle).
+   void Circle(double& x, double& y, double r)
+   {
+      double phi = Uniform(0., 2. * M_PI);
+      x          = r * std::cos(phi);
+      y          = r * std::sin(phi);
+   }
+
+   /// Key for the current run and subrun.
+   static uint64_t RunKey()
+   {
+      return Mix((static_cast<uint64_t>(static_cast<uint32_t>(TRunInfo::RunNumber())) << 32) | static_cast<uint32_t>(TRunInfo::SubRunNumber()));
+   }
+
+   /// Stream of the calling thread, seeded with the run key at the time of its first use and a unique thread index.
+   static TCounterRandom& ThreadLocal()
+   {
+      static std::atomic<uint64_t> threadCounter{0};
+      thread_local TCounterRandom  random(RunKey(), threadCounter.fetch_add(1, std::memory_order_relaxed), ~0U, EStream::kThread);
+      return random;
+   }
+
+   /// splitmix64 finalizer, used to spread the bits of the seeds.
+   static uint64_t Mix(uint64_t value)
+   {
+      value += 0x9e3779b97f4a7c15ULL;
+      value  = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      value  = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+      return value ^ (value >> 31);
+   }
+
+   /// One Philox4x32-10 block: ten rounds of multiplications and key additions.
+   static std::array<uint32_t, 4> Philox(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+   {
+      for(int round = 0; round < 10; ++round) {
+         uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+         uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+         counter           = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                              static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+         key[0] += 0x9E3779B9u;
+         key[1] += 0xBB67AE85u;
+      }
+      return counter;
+   }
+
+private:
+   std::array<uint32_t, 2> fKey;
+   std::array<uint32_t, 4> fCounter;
+   std::array<uint32_t, 4> fBuffer{};
+   size_t                  fUsed{4};   ///< number of words of the buffer already used
+};
+/*! @} */
+#endif
@@ -0,0 +1,85 @@
+#ifndef TDOPPLERTABLE_H
+#define TDOPPLERTABLE_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TDopplerTable
+///
+/// Table of the unit direction vectors of all positions of a
+/// detector array (e.g. all detector/crystal/segment combinations
+/// of TIGRESS), stored as separate x, y, and z arrays. Correct
+/// calculates the Doppler corrected energies of many hits in a
+/// single loop without any TVector3 math, which the compiler can
+/// vectorize.
+///
+/// The table has one additional entry at the end with a null
+/// vector, for hits with an invalid position. Those are only
+/// corrected for the time dilation.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "TVector3.h"
+
+class TDopplerTable {
+public:
+   TDopplerTable() = default;
+   explicit TDopplerTable(size_t size) { Resize(size); }
+
+   void Resize(size_t size)
+   {
+      fX.assign(size + 1, 0.);
+      fY.assign(size + 1, 0.);
+      fZ.assign(size + 1, 0.);
+   }
+   size_t Size() const { return fX.empty() ? 0 : fX.size() - 1; }
+   /// Index of the entry with the null vector.
+   int32_t InvalidIndex() const { return static_cast<int32_t>(Size()); }
+
+   /// Stores the direction of the position, a null vector stays null.
+   void Set(size_t index, const TVector3& position)
+   {
+      double mag = position.Mag();
+      if(mag > 0.) {
+         fX[index] = position.X() / mag;
+         fY[index] = position.Y() / mag;
+         fZ[index] = position.Z() / mag;
+      } else {
+         fX[index] = 0.;
+         fY[index] = 0.;
+         fZ[index] = 0.;
+      }
+   }
+
+   /// Calculates corrected[i] = energy[i] * gamma * (1 - beta * cos(theta)) for the position index[i] and the recoil
+   /// velocity beta (in units of c). This is the same as TTigressHit::GetDoppler with beta = |beta| and the beam direction
+   /// along beta.
+   void Correct(size_t n, const int32_t* index, const double* energy, const TVector3& beta, double* corrected) const
+   {
+      const double  gamma = 1. / std::sqrt(1. - beta.Mag2());
+      const double  bx    = gamma * beta.X();
+      const double  by    = gamma * beta.Y();
+      const double  bz    = gamma * beta.Z();
+      const double* x     = fX.data();
+      const double* y     = fY.data();
+      const double* z     = fZ.data();
+      for(size_t i = 0; i < n; ++i) {
+         const int32_t j = index[i];
+         corrected[i]    = energy[i] * (gamma - (bx * x[j] + by * y[j] + bz * z[j]));
+      }
+   }
+
+private:
+   std::vector<double> fX;
+   std::vector<double> fY;
+   std::vector<double> fZ;
+};
+/*! @} */
+#endif
@@ -0,0 +1,140 @@
+#ifndef TGRF4FRAGMENTTABLE_H
+#define TGRF4FRAGMENTTABLE_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TGRF4FragmentTable
+///
+/// Dense per-address table of in-flight GRF4 multi-integration
+/// fragments (module type 1). A fragment with more than one
+/// charge opens a group for its address, which is closed by the
+/// next fragment of the same address with a single charge. Only
+/// complete groups are handed to the TFragmentMap, so that it
+/// never has to keep fragments waiting for partners.
+///
+/// Each address has a fixed number of slots, ordered by arrival
+/// (and therefore time stamp). Groups that would exceed the
+/// capacity, or whose first fragment is older than the maximum
+/// age, are evicted according to the eviction policy. The age of
+/// all open groups is checked against the time stamp of every new
+/// fragment (using a queue ordered by the time stamps of the first
+/// fragments), so groups of quiet addresses are evicted as well.
+/// This keeps the memory bounded even if partner fragments never
+/// arrive.
+///
+/// By default evicted groups are forwarded to the fragment map as
+/// they are, which gives the same fragments as adding them to the
+/// fragment map directly. Note that the fragment map then keeps
+/// those fragments waiting for partners just as before, so only
+/// the drop policy actually bounds the memory. The forward and
+/// drop callbacks are called for each fragment that leaves the
+/// table, so the parser can count them as good or bad fragments.
+///
+/// The parser reads the eviction policy and maximum age from the
+/// user settings "GRF4.EvictionPolicy" ("forward" or "drop") and
+/// "GRF4.MaxAge" (in time stamp units).
+///
+/////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "TFragment.h"
+#include "TFragmentMap.h"
+
+class TGRF4FragmentTable {
+public:
+   enum class EEvictionPolicy {
+      kDrop,     ///< discard the fragments of an incomplete group (handing them to the drop callback)
+      kForward   ///< hand the fragments of an incomplete group to the fragment map as they are
+   };
+
+   using TCallback = std::function<void(const std::shared_ptr<TFragment>&)>;
+
+   static constexpr size_t fCapacity     = 8;         ///< maximum number of fragments in one group
+   static constexpr size_t fNofAddresses = 0x10000;   ///< GRF4 addresses are 16 bits
+
+   TGRF4FragmentTable()                                         = default;
+   TGRF4FragmentTable(const TGRF4FragmentTable&)                = default;
+   TGRF4FragmentTable(TGRF4FragmentTable&&) noexcept            = default;
+   TGRF4FragmentTable& operator=(const TGRF4FragmentTable&)     = default;
+   TGRF4FragmentTable& operator=(TGRF4FragmentTable&&) noexcept = default;
+   ~TGRF4FragmentTable()                                        = default;
+
+   void Add(const std::shared_ptr<TFragment>& frag, std::vector<Int_t>& charge, std::vector<Short_t>& intLength, TFragmentMap& fragmentMap);
+   void Flush(TFragmentMap& fragmentMap);   ///< evicts all open groups, e.g. at the end of a run
+
+   void OnForward(TCallback val) { fOnForward = std::move(val); }   ///< called for each fragment handed to the fragment map
+   void OnDrop(TCallback val) { fOnDrop = std::move(val); }         ///< called for each fragment that is dropped
+
+   void            EvictionPolicy(EEvictionPolicy val) { fEvictionPolicy = val; }
+   EEvictionPolicy EvictionPolicy() const { return fEvictionPolicy; }
+   void            MaxAge(Long64_t val) { fMaxAge = val; }
+   Long64_t        MaxAge() const { return fMaxAge; }
+
+   size_t OpenGroups() const { return fOpenGroups; }
+   size_t Passed() const { return fPassed; }
+   size_t Completed() const { return fCompleted; }
+   size_t EvictedByCapacity() const { return fEvictedByCapacity; }
+   size_t EvictedByAge() const { return fEvictedByAge; }
+   size_t EvictedAtFlush() const { return fEvictedAtFlush; }
+   size_t DroppedFragments() const { return fDroppedFragments; }
+
+   void Print() const;
+
+private:
+   struct TEntry {
+      std::shared_ptr<TFragment> fFragment;
+      std::vector<Int_t>         fCharge;
+      std::vector<Short_t>       fIntLength;
+   };
+
+   struct TSlot {
+      std::array<TEntry, fCapacity> fEntries;
+      size_t                        fSize{0};
+      uint32_t                      fGroup{0};   ///< number of the current group, to recognize outdated entries in the age queue
+   };
+
+   struct TOpenGroup {
+      Long64_t fTimeStamp;   ///< time stamp of the first fragment of the group
+      int32_t  fSlot;
+      uint32_t fGroup;
+      bool     operator>(const TOpenGroup& rhs) const { return fTimeStamp > rhs.fTimeStamp; }
+   };
+
+   TSlot& GetSlot(UInt_t address);
+   void   Forward(TSlot& slot, TFragmentMap& fragmentMap);
+   void   Evict(TSlot& slot, TFragmentMap& fragmentMap);
+   void   EvictAged(Long64_t timeStamp, TFragmentMap& fragmentMap);
+
+   std::vector<int32_t> fSlotIndex;   ///< index into fSlots for each address, -1 if the address has no slot yet
+   std::vector<TSlot>   fSlots;       ///< slots of all addresses that have been seen so far
+
+   std::priority_queue<TOpenGroup, std::vector<TOpenGroup>, std::greater<TOpenGroup>> fAgeQueue;   ///< open groups, oldest first
+
+   TCallback fOnForward;
+   TCallback fOnDrop;
+
+   EEvictionPolicy fEvictionPolicy{EEvictionPolicy::kForward};   ///< what to do with incomplete groups
+   Long64_t        fMaxAge{100000};                              ///< maximum time stamp difference (in time stamp units) to the first fragment of a group
+
+   size_t fOpenGroups{0};          ///< number of groups currently waiting for fragments
+   size_t fPassed{0};              ///< number of single-charge fragments passed on directly
+   size_t fCompleted{0};           ///< number of complete groups passed on
+   size_t fEvictedByCapacity{0};   ///< number of groups evicted because they exceeded the capacity
+   size_t fEvictedByAge{0};        ///< number of groups evicted because they exceeded the maximum age
+   size_t fEvictedAtFlush{0};      ///< number of groups evicted when flushing the table
+   size_t fDroppedFragments{0};    ///< number of fragments dropped from evicted groups
+};
+/*! @} */
+#endif
@@ -27,6 +27,8 @@
 
 #ifndef __CINT__
 #include <memory>
+#include <type_traits>
+#include <utility>
 #endif
 
 #include "TDataParser.h"
@@ -35,11 +37,15 @@
 #include "TPPG.h"
 #include "TScaler.h"
 #include "TFragmentMap.h"
+#include "TGRF4FragmentTable.h"
 #include "ThreadsafeQueue.h"
 #include "TEpicsFrag.h"
 #include "TGRSIOptions.h"
 #include "TRawEvent.h"
 #include "TMidasEvent.h"
+#include "TPipelineMetrics.h"
+
+class TBadFragment;
 
 class TGRSIDataParser : public TDataParser {
 public:
@@ -115,7 +121,17 @@ public:
 private:
    EDataParserState fState;
    bool             fIgnoreMissingChannel;   ///< flag that's set to TGRSIOptions::IgnoreMissingChannel
+
+   TGRF4FragmentTable fGRF4Table;   ///< in-flight GRF4 multi-integration fragments waiting for their partners
 #ifndef __CINT__
+   /// Hides TDataParser::Push so that the time spent pushing into the good and bad output queues is recorded in the pipeline metrics.
+   template <typename Queue, typename Fragment>
+   void Push(Queue&& queue, const std::shared_ptr<Fragment>& frag)
+   {
+      TPipelineMetrics::TScopedTimer timer(std::is_same<Fragment, TBadFragment>::value ? TPipelineMetrics::EStage::kPushBad : TPipelineMetrics::EStage::kPushGood);
+      TDataParser::Push(std::forward<Queue>(queue), frag);
+   }
+
    void SetTIGWave(uint32_t, const std::shared_ptr<TFragment>&);
    void SetTIGAddress(uint32_t, const std::shared_ptr<TFragment>&);
    void SetTIGCfd(uint32_t, const std::shared_ptr<TFragment>&);
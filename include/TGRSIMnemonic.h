@@ -1,7 +1,9 @@
 #ifndef TGRSIMNEMONIC_H
 #define TGRSIMNEMONIC_H
 
+#include <array>
 #include <string>
+#include <vector>
 #include "TMnemonic.h"
 #include "Globals.h"
 #include "TClass.h"
@@ -79,6 +81,35 @@ public:
 
    double GetTime(Long64_t timestamp, Float_t cfd, double energy, const TChannel* channel) const override;
 
+   /// Timing constants of a single channel, precomputed from its digitizer type and calibration, so that
+   /// calculating the time of a hit does not need any switches or calls to the channel (except for the walk correction).
+   struct TTimingDescriptor {
+      enum class ECfdMode : char { kNone,       ///< no CFD, the timestamp is dithered instead
+                                   kFraction,   ///< CFD is a fraction of the time stamp unit (divided by fCfdDivisor)
+                                   kGRF4G };    ///< GRF4G CFD with the integer part in the top bits
+
+      ECfdMode              fCfdMode{ECfdMode::kNone};
+      Long64_t              fTimeStampMask{~0LL};     ///< bits of the time stamp that are not included in the CFD
+      Long64_t              fTimeStampUnit{1};
+      double                fCfdDivisor{1.};
+      std::array<double, 4> fCfdCoefficients{};       ///< CFD calibration polynomial (constant term first)
+      size_t                fNofCfdCoefficients{0};   ///< if this is larger than the array, CalibrateCFD of the channel is used
+      double                fTimeOffset{0.};
+      const TChannel*       fChannel{nullptr};        ///<! only needed for long CFD calibrations
+
+      double CalibrateCfd(double cfd) const;
+      /// Same as TGRSIMnemonic::GetTime, but with the walk correction tZero and the random number passed in.
+      double Time(Long64_t timestamp, Float_t cfd, double tZero, double random) const;
+   };
+
+   static TTimingDescriptor BuildTimingDescriptor(const TChannel* channel);
+
+   /// Calculates the times of n hits (given as arrays of their time stamps, CFDs, energies, and channels) in one go.
+   static void GetTimes(size_t n, const Long64_t* timestamps, const Float_t* cfds, const double* energies, const TChannel* const* channels, double* times);
+   /// Calculates the times of all hits, the hit class needs to provide GetTimeStamp, GetCfd, GetEnergy, and GetChannel.
+   template <class T>
+   static void GetTimes(const std::vector<T*>& hits, std::vector<double>& times);
+
    int NumericArraySubPosition() const override;
 
    void Print(Option_t* opt = "") const override;
@@ -88,10 +119,29 @@ private:
    ESystem fSystem;
 
    void EnumerateSystem();
+   /// Value of a single hexadecimal digit (-1 for anything that isn't one).
+   static int16_t HexDigit(char character);
 
    /// \cond CLASSIMP
    ClassDefOverride(TGRSIMnemonic, 1)   // NOLINT(readability-else-after-return)
    /// \endcond
 };
 
+template <class T>
+void TGRSIMnemonic::GetTimes(const std::vector<T*>& hits, std::vector<double>& times)
+{
+   std::vector<Long64_t>        timestamps(hits.size());
+   std::vector<Float_t>         cfds(hits.size());
+   std::vector<double>          energies(hits.size());
+   std::vector<const TChannel*> channels(hits.size());
+   for(size_t i = 0; i < hits.size(); ++i) {
+      timestamps[i] = hits[i]->GetTimeStamp();
+      cfds[i]       = hits[i]->GetCfd();
+      energies[i]   = hits[i]->GetEnergy();
+      channels[i]   = hits[i]->GetChannel();
+   }
+   times.resize(hits.size());
+   GetTimes(hits.size(), timestamps.data(), cfds.data(), energies.data(), channels.data(), times.data());
+}
+
 #endif
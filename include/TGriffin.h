@@ -18,6 +18,10 @@
 #include "TSuppressed.h"
 #include "TTransientBits.h"
 #include "TSpline.h"
+#include "TDopplerTable.h"
+#include "THitArena.h"
+
+class TGriffinHitView;
 
 class TGriffin : public TSuppressed {
 public:
@@ -41,8 +45,17 @@ public:
 
    TGriffinHit* GetGriffinHit(const int& i);   //!<!
 
-   static TVector3    GetPosition(int DetNbr, int CryNbr = 5, double dist = 110.0);   //!<!
-   static TVector3    GetDetectorPosition(int DetNbr);                                //!<!
+   static TVector3    GetPosition(int DetNbr, int CryNbr = 5, double dist = 110.0);    //!<!
+   static TVector3    GetDirection(int DetNbr, int CryNbr = 5, double dist = 110.0);   //!<! unit vector of GetPosition
+   static TVector3    GetDetectorPosition(int DetNbr);                                 //!<!
+   /// Opening angle (in radians) and its cosine between two crystals, looked up in a table for all pairs of crystals.
+   static double GetCrystalAngle(int DetNbr1, int CryNbr1, int DetNbr2, int CryNbr2, double dist = 110.0);      //!<!
+   static double GetCosCrystalAngle(int DetNbr1, int CryNbr1, int DetNbr2, int CryNbr2, double dist = 110.0);   //!<!
+   /// Table of the cosines of the opening angles between all 64 crystals, [64*first+second] with the index 4*(DetNbr-1)+CryNbr of each crystal.
+   static const double* GetCosCrystalAngleTable(double dist = 110.0);   //!<!
+   /// Doppler corrected energies of n hits, given as arrays of their detector, crystal, and energy, for a recoil with
+   /// velocity beta (in units of c). Uses the same positions as GetPosition.
+   static void GetDopplerEnergies(size_t n, const int* detector, const int* crystal, const double* energy, const TVector3& beta, double* corrected, double dist = 110.0);   //!<!
    static const char* GetColorFromNumber(int number);
 #ifndef __CINT__
    void AddFragment(const std::shared_ptr<const TFragment>&, TChannel*) override;   //!<!
@@ -57,6 +70,7 @@ public:
    void ResetFlags() const;
 
 #if !defined(__CINT__) && !defined(__CLING__)
+   /// Any criterion other than the default one is checked for all pairs of hits instead of clover by clover.
    void SetAddbackCriterion(std::function<bool(const TDetectorHit*, const TDetectorHit*)> criterion)
    {
       fAddbackCriterion = std::move(criterion);
@@ -69,10 +83,13 @@ public:
    Short_t      GetAddbackMultiplicity();
    TGriffinHit* GetAddbackHit(const int& i);
    bool         IsAddbackSet() const;
+   /// Deletes the addback hits. Their memory in the arena is only re-used once the suppressed (addback) hits have been
+   /// reset as well (or by the next Clear), so re-building only the addback hits keeps growing the arena until then.
    void         ResetAddback();   //!<!
    UShort_t     GetNAddbackFrags(const size_t& idx);
 
 #if !defined(__CINT__) && !defined(__CLING__)
+   /// Any criterion other than the default one is checked for all pairs of hits and BGO hits instead of clover by clover.
    void SetSuppressionCriterion(std::function<bool(const TDetectorHit*, const TDetectorHit*)> criterion)
    {
       fSuppressionCriterion = std::move(criterion);
@@ -105,6 +122,8 @@ public:
    void Print(std::ostream& out) const override;    //!<!
 
 private:
+   friend class TGriffinHitView;
+
 #if !defined(__CINT__) && !defined(__CLING__)
    static std::function<bool(const TDetectorHit*, const TDetectorHit*)> fAddbackCriterion;
    static std::function<bool(const TDetectorHit*, const TDetectorHit*)> fSuppressionCriterion;
@@ -121,7 +140,23 @@ private:
    mutable std::vector<TDetectorHit*> fSuppressedAddbackHits;    //!<! Used to create suppressed addback hits on the fly
    mutable std::vector<UShort_t>      fSuppressedAddbackFrags;   //!<! Number of crystals involved in creating in the suppressed addback hit
 
+   THitArena fHitArena;   //!<! Memory for the addback and suppressed hits, released all at once by Clear or the Reset functions
+
    static std::array<TVector3, 17> fCloverPosition;                            //!<! Position of each HPGe Clover
+
+   struct TPositionTable;
+   static const TPositionTable& PositionTable(double dist);                               //!<! lookup table of all crystal positions at this distance
+   static TVector3              CalculatePosition(int DetNbr, int CryNbr, double dist);   //!<! position calculated without the lookup table
+
+   static const std::array<double, 5>& CrossTalkCoefficients(const TGriffinHit* hit);   //!<! row of the clover's cross-talk matrix for the crystal of the hit
+
+   // fast paths for the default addback and suppression criteria, working clover by clover
+   static bool UsingDefaultAddback();
+   static bool UsingDefaultSuppression();
+   void        FlagSuppressedHits(const TBgo* bgo, std::vector<char>& suppressed);
+   void        CreateCloverAddback(const std::vector<char>* suppressed, std::vector<TDetectorHit*>& addbacks, std::vector<UShort_t>& nofFragments);
+   void        CreateCloverSuppressed(const TBgo* bgo, std::vector<TDetectorHit*>& suppressedHits);
+
    void                            ClearStatus() const { fGriffinBits = 0; }   //!<!
    void                            SetBitNumber(EGriffinBits bit, Bool_t set) const;
    Bool_t                          TestBitNumber(EGriffinBits bit) const { return fGriffinBits.TestBit(bit); }
@@ -132,6 +167,8 @@ private:
    void SetSuppressedAddback(bool flag = true) const;
 
    void SetCrossTalk(bool flag = true) const;
+   void ClearTransientHits();
+   void ResetArenaIfUnused();
 
    /// \cond CLASSIMP
    ClassDefOverride(TGriffin, 7)   // Griffin Physics structure // NOLINT(readability-else-after-return)
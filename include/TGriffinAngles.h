@@ -16,9 +16,12 @@
 ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <array>
+#include <cstdint>
 #include <set>
 #include <map>
 #include <functional>
+#include <vector>
 
 #include "TCollection.h"
 #include "TNamed.h"
@@ -40,19 +43,16 @@ public:
    bool   Grouping() const { return fGrouping; }
    bool   Addback() const { return fAddback; }
 
-   int    Index(double angle);
+   int    Index(double angle) const;
+   int    Index(int firstDet, int firstCry, int secondDet, int secondCry) const;
    int    NumberOfAngles() const { return fAngles.size(); }
-   double Angle(int index) const
-   {
-      auto it = fAngles.begin();
-      std::advance(it, index);
-      return *it;
-   }
-   double AverageAngle(int index) const;
-   int    Count(double angle)
+   double Angle(int index) const { return fAngleVector[index]; }
+   double AverageAngle(int index) const { return fAverageAngles[index]; }
+   int Count(double angle) const
    {
       /// If the angle is in our map, report how often it exists, otherwise return zero.
-      if(fAngleCount.count(static_cast<int>(std::round(angle / fRounding))) == 1) { return fAngleCount.at(static_cast<int>(std::round(angle / fRounding))); }
+      auto it = fAngleCount.find(static_cast<int>(std::round(angle / fRounding)));
+      if(it != fAngleCount.end()) { return it->second; }
       return 0;
    }
 
@@ -62,6 +62,7 @@ public:
 
    bool ExcludeDetector(int detector) const;
    bool ExcludeCrystal(int detector, int crystal) const;
+   bool ExcludePair(int firstDet, int firstCry, int secondDet, int secondCry) const;
 
    void Print(Option_t* = "") const override;
 
@@ -79,6 +80,8 @@ public:
 
 private:
    void Add(TGriffinAngles* griffinAngles);
+   void BuildTables();
+   int  FindIndex(double angle) const;
 
    static EVerbosity     fVerbosity;           ///< verbosity level
    double                fDistance{145.};      ///< distance of detector from center of array in mmm
@@ -93,6 +96,11 @@ private:
    std::map<double, int> fAngleMap;            ///< Maps angles to indices. This is fairly straight forward without grouping, but if grouping is used multiple angles can be mapped to the same index.
    std::map<int, int>    fAngleCount;          ///< Maps angles (divided by rounding and cast to integers) to number of combinations contributing to it.
 
+   // lookup tables created from the members above by the constructor and the streamer (so they are also created for objects read from file)
+   std::vector<double>          fAngleVector;     //!<! angle of each index
+   std::vector<double>          fAverageAngles;   //!<! average angle of each index
+   std::array<int16_t, 64 * 64> fPairIndex{};     //!<! index of each pair of crystals (numbered 4*(det-1)+cry), -1 if the pair is excluded or there is no matching angle
+
    /// \cond CLASSIMP
    ClassDefOverride(TGriffinAngles, 5)   // NOLINT(readability-else-after-return)
    /// \endcond
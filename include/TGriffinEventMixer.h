@@ -0,0 +1,108 @@
+#ifndef TGRIFFINEVENTMIXER_H
+#define TGRIFFINEVENTMIXER_H
+
+/** \addtogroup Analysis
+ *  @{
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class TGriffinEventMixer
+///
+/// Creates the event-mixed gamma-gamma matrices for each angle of a
+/// TGriffinAngles object (the "AngularCorrelationMixed" inputs of
+/// AngularCorrelations). Each thread calling AddEvent keeps its own buffer
+/// of the last Depth() events, and every hit of a new event is paired
+/// with every hit of those events. The pairs are counted in dense,
+/// arrays of each thread (owned by the mixer), which are only added up
+/// when the histograms are created at the end, so mixing from many threads
+/// never needs a lock. The arrays of an angle are only allocated once the
+/// first pair at this angle is found.
+///
+/// To keep the arrays small, only the bins of the y-axis inside the
+/// energy gates are stored (the matrices are only ever projected onto
+/// the x-axis within these gates). Without any gates the full matrix is
+/// stored, which can need a lot of memory for many angles and bins.
+///
+/// The depth and gates are read from the user settings
+/// - Mixing.Depth: number of previous events each event is mixed with (default 10)
+/// - Mixing.GateLow and Mixing.GateHigh: vectors with the low and high edges of the gates
+///
+/// and can also be set directly (before the first event is added).
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "TH2D.h"
+
+#include "TGriffinAngles.h"
+#include "TPerThread.h"
+
+class TGriffin;
+class TGriffinBgo;
+
+class TGriffinEventMixer {
+public:
+   TGriffinEventMixer(const TGriffinAngles* angles, int nofBins, double low, double high);
+   TGriffinEventMixer(const TGriffinEventMixer&)                = delete;
+   TGriffinEventMixer(TGriffinEventMixer&&) noexcept            = delete;
+   TGriffinEventMixer& operator=(const TGriffinEventMixer&)     = delete;
+   TGriffinEventMixer& operator=(TGriffinEventMixer&&) noexcept = delete;
+   ~TGriffinEventMixer()                                        = default;
+
+   size_t Depth() const { return fDepth; }
+   void   Depth(size_t depth) { fDepth = depth; }
+   bool   Symmetric() const { return fSymmetric; }
+   void   Symmetric(bool symmetric) { fSymmetric = symmetric; }   ///< fill each pair as (E1, E2) and (E2, E1), default is true
+
+   void AddGate(double low, double high);
+   void ClearGates();
+
+   /// Mixes the n hits (given as arrays of detector, crystal, and energy) with the previous events of this thread, and
+   /// adds them to the buffer.
+   void AddEvent(size_t n, const int* detector, const int* crystal, const double* energy);
+   /// Same as above for the suppressed (addback if the angles use addback) hits of GRIFFIN.
+   void AddEvent(TGriffin* griffin, TGriffinBgo* bgo);
+
+   /// Adds up the counts of all threads and creates one matrix per angle, named <baseName><index>. The caller owns the
+   /// histograms. Angles without any mixed pairs get a nullptr instead of an empty matrix.
+   std::vector<TH2D*> Histograms(const char* baseName = "AngularCorrelationMixed") const;
+
+   size_t NumberOfPairs() const;
+
+private:
+   struct TMixHit {
+      int16_t fCrystal;   ///< 4*(detector-1)+crystal
+      int32_t fBin;       ///< bin on both axes (starting at zero)
+   };
+
+   struct TThreadState {
+      std::vector<std::vector<TMixHit>>  fEvents;    ///< ring buffer of the previous events
+      size_t                             fNext{0};   ///< position of the next event in the ring buffer
+      std::vector<TMixHit>               fCurrent;
+      std::vector<std::vector<uint32_t>> fCounts;    ///< [angle][gated y-bin][x-bin], allocated on the first pair at that angle
+      size_t                             fPairs{0};
+   };
+
+   TThreadState& State();
+   void          Fill(TThreadState& state, int angle, int32_t xBin, int32_t yBin) const;
+   void          UpdateRows();
+
+   const TGriffinAngles* fAngles;
+   int                   fNofBins;
+   double                fLow;
+   double                fHigh;
+   size_t                fDepth{10};
+   bool                  fSymmetric{true};
+   std::vector<double>   fGateLow;
+   std::vector<double>   fGateHigh;
+   std::vector<int32_t>  fRow;        ///< row of each y-bin in the dense arrays (-1 if it isn't in any gate)
+   int32_t               fNofRows{0};
+
+   TPerThread<TThreadState> fStates;
+};
+/*! @} */
+#endif
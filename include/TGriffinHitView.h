@@ -0,0 +1,94 @@
+#ifndef TGRIFFINHITVIEW_H
+#define TGRIFFINHITVIEW_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \class TGriffinHitView
+///
+/// Snapshot of the hits of one TGriffin event as a structure of arrays:
+/// energy, time, detector, crystal, array number, and the index of the
+/// crystal in the table of the cosines of all opening angles, each as
+/// one contiguous array. Fill goes through the hits (or the addback,
+/// suppressed, or suppressed addback hits) once, so loops over the
+/// arrays don't need any bounds checks, virtual calls, or TChannel
+/// lookups, and can be vectorized by the compiler. E.g. for a
+/// gamma-gamma matrix with the cosine of the angle:
+///
+/// \code
+/// view.Fill(griffin, TGriffinHitView::EHitType::kSuppressedAddback, bgo);
+/// const double* cosAngle = view.CosAngleTable();
+/// for(size_t i = 0; i < view.Size(); ++i) {
+///    for(size_t j = i + 1; j < view.Size(); ++j) {
+///       double cosTheta = cosAngle[TGriffinHitView::kTableSize * view.CrystalIndex()[i] + view.CrystalIndex()[j]];
+///       ...
+/// \endcode
+///
+/// The arrays are kept between calls, so one view should be re-used for
+/// all events. They are not updated if the hits of the event change.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <vector>
+
+class TBgo;
+class TDetectorHit;
+class TGriffin;
+class TGriffinHit;
+
+class TGriffinHitView {
+public:
+   enum class EHitType : uint8_t { kRaw,
+                                   kAddback,
+                                   kSuppressed,
+                                   kSuppressedAddback };
+
+   TGriffinHitView() = default;
+
+   /// Takes the snapshot of the hits of the type (the BGO is only used for the suppressed types), returns the number of
+   /// hits. The crystal indices are valid for the cos-angle table at the distance given.
+   size_t Fill(TGriffin* griffin, EHitType type = EHitType::kRaw, const TBgo* bgo = nullptr, double dist = 110.0);
+   void   Clear();
+
+   size_t   Size() const { return fEnergy.size(); }
+   EHitType Type() const { return fType; }
+
+   const double*   Energy() const { return fEnergy.data(); }
+   const double*   Time() const { return fTime.data(); }
+   const int16_t*  Detector() const { return fDetector.data(); }
+   const int16_t*  Crystal() const { return fCrystal.data(); }
+   const uint16_t* ArrayNumber() const { return fArrayNumber.data(); }
+   /// Index 4*(detector-1)+crystal of each hit in the cos-angle table, or 64 for invalid crystals (the table has an
+   /// additional 65th row and column with NaN for those).
+   const int16_t* CrystalIndex() const { return fCrystalIndex.data(); }
+   /// Cosines of the opening angles between all crystals, [65*first+second] with the crystal indices.
+   const double* CosAngleTable() const { return fCosAngles.data(); }
+   /// Number of fragments of each addback hit (one for all other hit types).
+   const uint16_t* NofFragments() const { return fNofFragments.data(); }
+
+   TGriffinHit* Hit(size_t i) const { return fHits[i]; }
+
+   static constexpr int kTableSize = 65;
+
+private:
+   void Add(TDetectorHit* hit, uint16_t nofFragments);
+   void UpdateTable(double dist);
+
+   EHitType                  fType{EHitType::kRaw};
+   std::vector<double>       fEnergy;
+   std::vector<double>       fTime;
+   std::vector<int16_t>      fDetector;
+   std::vector<int16_t>      fCrystal;
+   std::vector<uint16_t>     fArrayNumber;
+   std::vector<int16_t>      fCrystalIndex;
+   std::vector<uint16_t>     fNofFragments;
+   std::vector<TGriffinHit*> fHits;
+   double                    fDistance{0.};
+   std::vector<double>       fCosAngles;   ///< 65x65 copy of TGriffin::GetCosCrystalAngleTable with NaN for invalid crystals
+};
+/*! @} */
+#endif
@@ -0,0 +1,138 @@
+#ifndef THITARENA_H
+#define THITARENA_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class THitArena
+///
+/// Arena for the transient hits a detector creates for each event
+/// (e.g. the addback and suppressed hits of TSuppressed detectors
+/// like TGriffin, TTigress, or TLaBr). Hits are constructed in
+/// place in large slabs of memory, and all of them are destroyed
+/// at once by Reset(), which keeps the slabs for the next event.
+/// After the first few events no memory is allocated anymore.
+///
+/// Vectors of hits can also contain hits that were created with
+/// new (e.g. by the generic TSuppressed::CreateAddback), so they
+/// should be cleared with Release(), which deletes only those and
+/// leaves the hits of the arena for Reset().
+///
+/// Hits of the arena must never be deleted directly.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+class THitArena {
+public:
+   THitArena() = default;
+   THitArena(const THitArena&)            = delete;
+   THitArena& operator=(const THitArena&) = delete;
+   THitArena(THitArena&& rhs) noexcept
+      : fSlabs(std::move(rhs.fSlabs)), fCurrent(rhs.fCurrent), fObjects(std::move(rhs.fObjects))
+   {
+      rhs.fCurrent = 0;
+   }
+   THitArena& operator=(THitArena&& rhs) noexcept
+   {
+      if(this != &rhs) {
+         Reset();
+         fSlabs       = std::move(rhs.fSlabs);
+         fCurrent     = rhs.fCurrent;
+         fObjects     = std::move(rhs.fObjects);
+         rhs.fCurrent = 0;
+      }
+      return *this;
+   }
+   ~THitArena() { Reset(); }
+
+   /// Constructs a T in the arena. It is destroyed by the next Reset (or the destructor of the arena).
+   template <class T, class... Args>
+   T* Create(Args&&... args)
+   {
+      static_assert(alignof(T) <= alignof(std::max_align_t), "THitArena only supports the default alignment");
+      void* memory = Allocate(sizeof(T), alignof(T));
+      T*    object = new(memory) T(std::forward<Args>(args)...);
+      fObjects.push_back({object, [](void* pointer) { static_cast<T*>(pointer)->~T(); }});
+      return object;
+   }
+
+   /// Checks whether the pointer was created by this arena.
+   bool Owns(const void* pointer) const
+   {
+      const auto* address = static_cast<const char*>(pointer);
+      return std::any_of(fSlabs.begin(), fSlabs.end(), [address](const TSlab& slab) { return address >= slab.fData.get() && address < slab.fData.get() + slab.fSize; });
+   }
+
+   /// Deletes all hits of the vector that were not created by this arena and clears it.
+   template <class T>
+   void Release(std::vector<T*>& hits)
+   {
+      for(auto* hit : hits) {
+         if(!Owns(hit)) {
+            delete hit;
+         }
+      }
+      hits.clear();
+   }
+
+   /// Destroys all objects of the arena (in the reverse order of their creation), the memory is kept for re-use.
+   void Reset()
+   {
+      for(auto object = fObjects.rbegin(); object != fObjects.rend(); ++object) {
+         object->second(object->first);
+      }
+      fObjects.clear();
+      for(auto& slab : fSlabs) {
+         slab.fUsed = 0;
+      }
+      fCurrent = 0;
+   }
+
+   size_t Size() const { return fObjects.size(); }
+
+private:
+   static constexpr size_t kSlabSize = 1 << 15;
+
+   struct TSlab {
+      std::unique_ptr<char[]> fData;
+      size_t                  fSize{0};
+      size_t                  fUsed{0};
+   };
+
+   void* Allocate(size_t size, size_t alignment)
+   {
+      while(fCurrent < fSlabs.size()) {
+         auto&  slab   = fSlabs[fCurrent];
+         size_t offset = (slab.fUsed + alignment - 1) / alignment * alignment;
+         if(offset + size <= slab.fSize) {
+            slab.fUsed = offset + size;
+            return slab.fData.get() + offset;
+         }
+         ++fCurrent;
+      }
+      // operator new[] returns memory aligned for any fundamental type, so the first object always fits
+      TSlab slab;
+      slab.fSize = std::max(kSlabSize, size);
+      slab.fData.reset(new char[slab.fSize]);
+      slab.fUsed = size;
+      fSlabs.push_back(std::move(slab));
+      fCurrent = fSlabs.size() - 1;
+      return fSlabs.back().fData.get();
+   }
+
+   std::vector<TSlab>                             fSlabs;
+   size_t                                         fCurrent{0};   ///< slab we are currently allocating from
+   std::vector<std::pair<void*, void (*)(void*)>> fObjects;      ///< objects and their destructors
+};
+/*! @} */
+#endif
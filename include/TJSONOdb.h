@@ -0,0 +1,56 @@
+#ifndef TJSONODB_H
+#define TJSONODB_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TJSONOdb
+///
+/// Class to access ODB info from a JSON ODB dump, as written by
+/// newer MIDAS versions at the beginning and end of a run (or
+/// by "odbedit save -j").
+///
+/// The dump is parsed in a single pass, objects become
+/// directories, arrays key arrays, and all other values keys.
+/// The meta data MIDAS writes alongside each key ("<name>/key")
+/// and the top-level entries starting with a slash are skipped.
+/// Strings are unescaped in place and indexed by their full path,
+/// see TOdb.
+///
+/////////////////////////////////////////////////////////////////
+
+#include "TOdb.h"
+
+class TJSONOdb : public TOdb {
+public:
+   explicit TJSONOdb(char* buffer, int size = 0);
+   TJSONOdb(const TJSONOdb&)                = delete;
+   TJSONOdb(TJSONOdb&&) noexcept            = default;
+   TJSONOdb& operator=(const TJSONOdb&)     = delete;
+   TJSONOdb& operator=(TJSONOdb&&) noexcept = default;
+   ~TJSONOdb() override                     = default;
+
+private:
+   void        ParseObject(TOdbNode* node);
+   void        ParseArray(TOdbNode* node);
+   const char* ParseScalar();
+   char*       ParseString();
+   void        SkipValue();
+   void        SkipWhitespace();
+   void        Expect(char character);
+   [[noreturn]] void Error(const char* message);
+
+   static bool IsMetaData(const char* name);
+
+   char* fPos{nullptr};   ///<! current position of the parser in the buffer
+   char* fEnd{nullptr};   ///<! end of the buffer (terminating null-character)
+
+   /// \cond CLASSIMP
+   ClassDefOverride(TJSONOdb, 0)   // NOLINT(readability-else-after-return)
+   /// \endcond
+};
+/*! @} */
+#endif
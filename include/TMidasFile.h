@@ -24,7 +24,7 @@
 
 #include "TRawFile.h"
 
-#include "TXMLOdb.h"
+#include "TOdb.h"
 #include "TMidasEvent.h"
 
 /// Reader for MIDAS .mid files
@@ -87,20 +87,19 @@ public:
 private:
    void ReadMoreBytes(size_t bytes);
 
-   void SetFileOdb();
-   void SetRunInfo(uint32_t time);
-   void SetEPICSOdb();
-   void SetTIGOdb();
-   void SetGRIFFOdb();
-   void SetTIGDAQOdb();
+   void     SetFileOdb();
+   uint64_t OdbHash() const;   ///< hash of the parts of the ODB used by SetFileOdb, see TOdbCache
+   void     SetRunInfo(uint32_t time);
+   void     SetEPICSOdb();
+   void     SetTIGOdb();
+   void     SetGRIFFOdb();
+   void     SetTIGDAQOdb();
 
 #ifndef __CINT__
    std::shared_ptr<TMidasEvent> fOdbEvent;
 #endif
 
-#ifdef HAS_XML
-   TXMLOdb* fOdb;
-#endif
+   TOdb* fOdb;   ///< ODB of the current file (XML or JSON)
 
    std::string fOutFilename;   ///< name of the currently open file
 
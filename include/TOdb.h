@@ -0,0 +1,131 @@
+#ifndef TODB_H
+#define TODB_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TOdb
+///
+/// Base class for the access to ODB dumps. The derived classes
+/// parse the dump in a single pass and fill a flat index that
+/// maps the full ODB path of each directory and key to its node.
+/// All names and values are decoded in place and point into the
+/// buffer owned by this class, so looking up a path is a single
+/// hash lookup and reading an array does not allocate anything
+/// per element (except for strings).
+///
+/// Use TOdb::Create to get the right reader for a dump (XML or
+/// JSON).
+///
+/////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Rtypes.h"
+
+/// Node of the ODB tree, either a directory, a key, or a key array.
+class TOdbNode {
+public:
+   enum class EType { kDir,
+                      kKey,
+                      kKeyArray };
+
+   const char* GetNodeName() const { return fName; }
+   const char* GetText() const { return fText; }   ///< value of a key, nullptr for directories and arrays
+   const std::string& GetPath() const { return fPath; }
+   EType              GetType() const { return fType; }
+   size_t             GetNumberOfValues() const { return fNofValues; }
+
+   bool      HasChildren() const { return fFirstChild != nullptr; }
+   TOdbNode* GetChildren() const { return fFirstChild; }   ///< first child of this node
+   TOdbNode* GetParent() const { return fParent; }
+   bool      HasNextNode() const { return fNextNode != nullptr; }
+   TOdbNode* GetNextNode() const { return fNextNode; }
+
+private:
+   friend class TOdb;
+
+   EType       fType{EType::kDir};
+   const char* fName{""};
+   const char* fText{nullptr};
+   std::string fPath;
+   size_t      fFirstValue{0};   ///< index of the first value of a key array in TOdb::fValues
+   size_t      fNofValues{0};
+   TOdbNode*   fParent{nullptr};
+   TOdbNode*   fFirstChild{nullptr};
+   TOdbNode*   fLastChild{nullptr};
+   TOdbNode*   fNextNode{nullptr};
+};
+
+class TOdb {
+public:
+   TOdb()                           = default;
+   TOdb(const TOdb&)                = delete;   ///< the nodes point into the buffer and to each other
+   TOdb(TOdb&&) noexcept            = default;
+   TOdb& operator=(const TOdb&)     = delete;
+   TOdb& operator=(TOdb&&) noexcept = default;
+   virtual ~TOdb()                  = default;
+
+   /// Creates a TXMLOdb or TJSONOdb depending on the content of the buffer (or of the file if the buffer is a file name).
+   static TOdb* Create(char* buffer, int size = 0);
+   /// Converts the text of an integer value, either decimal or hexadecimal with a leading "0x" (as MIDAS writes DWORDs in JSON).
+   static Long64_t ToInteger(const char* text);
+
+   const char* GetNodeName(TOdbNode* node) const { return node != nullptr ? node->GetNodeName() : ""; }
+   TOdbNode*   FindNode(const char* name, TOdbNode* node = nullptr) const;
+   TOdbNode*   FindPath(const char* path, TOdbNode* node = nullptr) const;
+
+   int                      ReadInt(const char* path, int index = 0, int defaultValue = 0xffffffff) const;
+   std::vector<int>         ReadIntArray(TOdbNode* node) const;
+   std::vector<double>      ReadDoubleArray(TOdbNode* node) const;
+   std::vector<std::string> ReadStringArray(TOdbNode* node) const;
+
+   /// Hashes (FNV-1a) the paths, types, and values of the node and all its descendants, combined with the hash passed
+   /// in. A null pointer is hashed as well, so the result also tells whether the node exists.
+   uint64_t Hash(const TOdbNode* node, uint64_t hash = fHashSeed) const;
+
+   size_t NumberOfNodes() const { return fNodes.size(); }
+
+   static constexpr uint64_t fHashSeed = 14695981039346656037ULL;   ///< FNV-1a offset basis
+
+protected:
+   /// Reads the file if the buffer is a file name, otherwise copies the buffer (without trailing null-characters).
+   /// In both cases the owned buffer is null-terminated.
+   void SetBuffer(const char* buffer, int size);
+
+   char*     BufferBegin() { return fBuffer.data(); }
+   char*     BufferEnd() { return fBuffer.data() + fBuffer.size() - 1; }   ///< position of the terminating null-character
+   TOdbNode* Root() const { return fRoot; }
+
+   TOdbNode* AddNode(TOdbNode* parent, TOdbNode::EType type, const char* name);
+   void      SetText(TOdbNode* node, const char* text) { node->fText = text; }
+   void      ResizeArray(TOdbNode* node, size_t nofValues);
+   void      SetValue(TOdbNode* node, size_t index, const char* value);
+   /// Stores a copy of text that can not be null-terminated in place and returns it.
+   const char* StoreText(const char* text, size_t length);
+
+private:
+   const char*   Value(const TOdbNode* node, size_t index) const;
+   static size_t NumberOfValues(const TOdbNode* node);
+
+   std::vector<char>                               fBuffer;          ///<! null-terminated copy of the ODB dump, all names and values point into it
+   std::deque<TOdbNode>                            fNodes;           ///<! all nodes, a deque so that pointers to the nodes stay valid
+   std::vector<const char*>                        fValues;          ///<! values of all key arrays
+   std::deque<std::string>                         fStoredText;      ///<! text that could not be kept in the buffer, a deque so that the strings stay valid
+   std::unordered_map<std::string_view, TOdbNode*> fIndex;           ///<! maps the full path of each node to the node
+   TOdbNode*                                       fRoot{nullptr};   ///<! root node (path "")
+
+   /// \cond CLASSIMP
+   ClassDef(TOdb, 0)   // NOLINT(readability-else-after-return)
+   /// \endcond
+};
+/*! @} */
+#endif
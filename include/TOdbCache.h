@@ -0,0 +1,94 @@
+#ifndef TODBCACHE_H
+#define TODBCACHE_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TOdbCache
+///
+/// Cache of the channel table and PPG cycle created from the ODB
+/// of a MIDAS file, keyed by a hash of the parts of the ODB they
+/// are created from (see TMidasFile::OdbHash). All subruns of a
+/// run usually have the same channel table, so only the first one
+/// has to create the channels, for the others the channels are
+/// restored from the cache. If the user setting
+/// "OdbCache.KeepChannels" is set, the channels are instead kept
+/// as they are if the previous file had the same hash (this skips
+/// the copy, but also keeps any changes made to the channels).
+///
+/// If the user setting "OdbCache.Directory" is set, each entry is
+/// also written to that directory as a cal-file
+/// (odb_v<version>_<hash>.cal) and a text file with the PPG cycle
+/// (odb_v<version>_<hash>.ppg), so that later jobs can use it as
+/// well.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TChannel.h"
+
+class TOdbCache {
+public:
+   static TOdbCache* Get();
+
+   TOdbCache()                                = default;
+   TOdbCache(const TOdbCache&)                = delete;
+   TOdbCache(TOdbCache&&) noexcept            = delete;
+   TOdbCache& operator=(const TOdbCache&)     = delete;
+   TOdbCache& operator=(TOdbCache&&) noexcept = delete;
+   ~TOdbCache()                               = default;
+
+   /// Restores the channels and PPG cycle of the entry with this hash (from memory or disk), returns false if there is none.
+   bool Apply(uint64_t hash);
+   /// Starts a new entry for this hash, the channels and PPG cycle are recorded until Commit is called.
+   void Begin(uint64_t hash);
+   /// Sets the ODB cycle of TPPG and records it for the current entry.
+   void SetOdbCycle(const std::vector<int16_t>& ppgCodes, const std::vector<int>& durations);
+   /// Copies the current channel table into the entry started by Begin and stores it.
+   void Commit();
+   /// Forgets all entries in memory and the hash of the channels that are currently loaded.
+   void Clear();
+
+   size_t Hits() const { return fHits; }
+   size_t Misses() const { return fMisses; }
+
+private:
+   struct TEntry {
+      std::vector<std::unique_ptr<TChannel>> fChannels;
+      bool                                   fHasCycle{false};
+      std::vector<int16_t>                   fPPGCodes;
+      std::vector<int>                       fDurations;
+   };
+
+   static constexpr int kFormatVersion = 1;   ///< version of the files written to disk, has to be increased whenever their format changes
+
+   std::string Directory() const;
+   bool        KeepChannels() const;
+   std::string FileName(uint64_t hash, const char* extension) const;
+   bool        ReadFromDisk(uint64_t hash, TEntry& entry) const;
+   void        WriteToDisk(uint64_t hash, const TEntry& entry) const;
+
+   static void CopyChannels(TEntry& entry);
+   static void RestoreChannels(const TEntry& entry);
+
+   std::unordered_map<uint64_t, TEntry> fEntries;
+   TEntry                               fPending;                ///< entry started by Begin, stored by Commit
+   uint64_t                             fPendingHash{0};
+   bool                                 fHasPending{false};
+   uint64_t                             fLoadedHash{0};          ///< hash of the entry the current channel table was created from
+   bool                                 fHasLoaded{false};
+   size_t                               fLoadedChannels{0};      ///< number of channels right after they were loaded
+
+   size_t fHits{0};
+   size_t fMisses{0};
+};
+/*! @} */
+#endif
@@ -0,0 +1,100 @@
+#ifndef TPERTHREAD_H
+#define TPERTHREAD_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TPerThread
+///
+/// Owns one object of type T per thread that uses it, e.g. the
+/// buffers an object collects counts in from many threads without
+/// locking. Get returns the object of the calling thread and
+/// creates it on the first call of that thread. The objects live
+/// as long as the TPerThread itself and can all be visited with
+/// ForEach (e.g. to add them up at the end).
+///
+/// Get only takes a lock the first time a thread asks for its
+/// object, or after the thread used a different TPerThread of the
+/// same type. Each thread remembers the last object it got in a
+/// thread-local cache, which is checked against an id that is
+/// never reused, so the cache can't hand out the object of a
+/// TPerThread that has been deleted.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+template <class T>
+class TPerThread {
+public:
+   TPerThread() : fId(NextId()) {}
+   TPerThread(const TPerThread&)                = delete;
+   TPerThread(TPerThread&&) noexcept            = delete;
+   TPerThread& operator=(const TPerThread&)     = delete;
+   TPerThread& operator=(TPerThread&&) noexcept = delete;
+   ~TPerThread()                                = default;
+
+   /// Object of the calling thread, create() (returning a std::unique_ptr<T>) is called if the thread has none yet.
+   template <class TCreate>
+   T& Get(TCreate create)
+   {
+      thread_local TCache cache;
+      if(cache.fId == fId) {
+         return *cache.fObject;
+      }
+      T* object = nullptr;
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         auto&                       entry = fObjects[std::this_thread::get_id()];
+         if(entry == nullptr) {
+            entry = create();
+         }
+         object = entry.get();
+      }
+      cache.fId     = fId;
+      cache.fObject = object;
+      return *object;
+   }
+
+   /// Calls function(T&) for the objects of all threads, while holding the lock (so no new objects can be added).
+   template <class TFunction>
+   void ForEach(TFunction function) const
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      for(const auto& entry : fObjects) {
+         function(*entry.second);
+      }
+   }
+
+   bool Empty() const
+   {
+      std::lock_guard<std::mutex> lock(fMutex);
+      return fObjects.empty();
+   }
+
+private:
+   struct TCache {
+      uint64_t fId{0};
+      T*       fObject{nullptr};
+   };
+
+   static uint64_t NextId()
+   {
+      static std::atomic<uint64_t> nextId{1};   // 0 marks an empty cache
+      return nextId++;
+   }
+
+   const uint64_t                                          fId;
+   mutable std::mutex                                      fMutex;
+   std::unordered_map<std::thread::id, std::unique_ptr<T>> fObjects;
+};
+/*! @} */
+#endif
@@ -0,0 +1,151 @@
+#ifndef TPIPELINEMETRICS_H
+#define TPIPELINEMETRICS_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TPipelineMetrics
+///
+/// Low-overhead instrumentation of the reading/parsing pipeline.
+/// Every thread records calls, items (bytes, fragments), and
+/// time-stamp-counter ticks per stage into its own counters, so
+/// the hot path never takes a lock. Snapshots of the sum over all
+/// threads can be exported periodically to a Prometheus text file
+/// and written to a ROOT file at the end of the run.
+///
+/// The ROOT file is a separate file, not the output file of the
+/// sort: that file is written by the writer loops of GRSISort, which
+/// this library has no access to. It is only written once, when the
+/// parser is destroyed after all threads are done (see
+/// DestroyParser), so this never happens concurrently with other
+/// ROOT I/O of the parser threads. The output files of the sort are
+/// refused as metrics file, as they might still be written to.
+///
+/// The metrics are disabled by default, in which case each
+/// instrumented stage costs a single branch on a static flag.
+/// They are enabled via the user settings:
+/// - PipelineMetrics.PrometheusFile: text file for the Prometheus snapshots
+/// - PipelineMetrics.Interval: seconds between Prometheus snapshots (default 10)
+/// - PipelineMetrics.RootFile: separate ROOT file the final snapshot is added to (not an output file of the sort)
+///
+/////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "TNamed.h"
+
+class TPipelineMetrics : public TNamed {
+public:
+   enum class EStage : uint8_t {
+      kRead,
+      kParseWFDN,
+      kParseGRF1,
+      kParseGRF2,
+      kParseGRF3,
+      kParseGRF4,
+      kParseCAEN,
+      kParseCPHA,
+      kParseMADC,
+      kParseEMMT,
+      kParseSRAW,
+      kParseSSUM,
+      kParseMSRD,
+      kParseOther,
+      kPushGood,
+      kPushBad,
+      kOdbEndOfRun,
+      kNumberOfStages
+   };
+
+   /// Scoped timer, records the ticks between construction and destruction for the given stage (if metrics are enabled).
+   class TScopedTimer {
+   public:
+      explicit TScopedTimer(EStage stage, uint64_t items = 1)
+         : fStage(stage), fItems(items), fActive(TPipelineMetrics::Enabled()), fStart(fActive ? TPipelineMetrics::Ticks() : 0)
+      {
+      }
+      TScopedTimer(const TScopedTimer&)                = delete;
+      TScopedTimer(TScopedTimer&&) noexcept            = delete;
+      TScopedTimer& operator=(const TScopedTimer&)     = delete;
+      TScopedTimer& operator=(TScopedTimer&&) noexcept = delete;
+      ~TScopedTimer() { Stop(); }
+
+      void Stage(EStage stage) { fStage = stage; }
+      void Items(uint64_t items) { fItems = items; }
+      void Stop()
+      {
+         /// Records the ticks since construction, any further calls (including the one from the destructor) are ignored.
+         if(fActive) { TPipelineMetrics::Record(fStage, TPipelineMetrics::Ticks() - fStart, fItems); }
+         fActive = false;
+      }
+
+   private:
+      EStage   fStage;
+      uint64_t fItems;
+      bool     fActive;
+      uint64_t fStart;
+   };
+
+   TPipelineMetrics();   ///< default constructor, use TPipelineMetrics::Get() instead
+   TPipelineMetrics(const TPipelineMetrics&)                = delete;
+   TPipelineMetrics(TPipelineMetrics&&) noexcept            = delete;
+   TPipelineMetrics& operator=(const TPipelineMetrics&)     = delete;
+   TPipelineMetrics& operator=(TPipelineMetrics&&) noexcept = delete;
+   ~TPipelineMetrics()                                      = default;
+
+   static TPipelineMetrics* Get();
+
+   static bool Enabled() { return fEnabled; }
+   static void Configure();   ///< reads the user settings and enables the metrics if any output is requested
+
+   static uint64_t Ticks()
+   {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+   }
+   static void Record(EStage stage, uint64_t ticks, uint64_t items = 1);
+
+   static const char* StageName(EStage stage);
+
+   void Snapshot();         ///< sums the counters of all threads into the persistent members
+   void PeriodicExport();   ///< writes a Prometheus snapshot if the export interval has passed
+   void Finish();           ///< writes the final Prometheus snapshot (called at the end of each sub-run)
+   void EndOfRun();         ///< adds the final snapshot to the ROOT file, must only be called once all threads are done
+   bool ExportPrometheus(const std::string& fileName);
+   bool WriteToRootFile(const std::string& fileName);
+
+   void Print(Option_t* opt = "") const override;
+
+private:
+   static std::atomic<bool>            fEnabled;                ///< flag whether the counters are updated
+   std::string                         fPrometheusFile;         ///< file the Prometheus snapshots are written to
+   std::string                         fRootFile;               ///< ROOT file the final snapshot is written to
+   double                              fInterval{10.};          ///< seconds between Prometheus snapshots
+   std::vector<std::string>            fStageNames;             ///< names of the stages
+   std::vector<ULong64_t>              fCalls;                  ///< number of calls per stage (summed over threads)
+   std::vector<ULong64_t>              fItems;                  ///< number of items (bytes or fragments) per stage (summed over threads)
+   std::vector<ULong64_t>              fTicks;                  ///< number of ticks spent per stage (summed over threads)
+   std::vector<std::vector<ULong64_t>> fThreadTicks;            ///< number of ticks spent per thread and stage
+   double                              fTicksPerSecond{1.e9};   ///< calibration of ticks, determined by comparing with the steady clock
+
+   /// \cond CLASSIMP
+   ClassDefOverride(TPipelineMetrics, 1)   // NOLINT(readability-else-after-return)
+   /// \endcond
+};
+/*! @} */
+#endif
@@ -12,6 +12,7 @@
 #include "TS3Hit.h"
 #include "TChannel.h"
 #include "TMnemonic.h"
+#include "TCounterRandom.h"
 
 class TS3 : public TDetector {
 public:
@@ -99,6 +100,8 @@ public:
    static TVector3 GetPosition(int ring, int sector, bool smear = false);
    static TVector3 GetPosition(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream,
                                bool smear = false);
+   static TVector3 GetSmearedPosition(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream,
+                                      TCounterRandom& random);
 
    void SetTargetDistance(double dist) { fTargetDistance = dist; }
 
@@ -137,6 +140,9 @@ private:
    static void                     SetGlobalBit(ES3GlobalBits bit, Bool_t set = true) { fGlobalS3Bits.SetBit(bit, set); }
    static Bool_t                   TestGlobalBit(ES3GlobalBits bit) { return (fGlobalS3Bits.TestBit(bit)); }
 
+   /// position of the pixel, smeared over its area if random is not a null pointer
+   static TVector3 Position(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream, TCounterRandom* random);
+
    /// for geometery
    static int fRingNumber;     //!<!
    static int fSectorNumber;   //!<!
@@ -16,6 +16,7 @@
 #include "Globals.h"
 #include "TDetector.h"
 #include "TSharc2Hit.h"
+#include "TSharcHitBuilder.h"
 
 class TSharc2 : public TDetector {
 public:
@@ -45,6 +46,12 @@ public:
       fYoffset = y;
       fZoffset = z;
    }
+   /// Maximum relative energy difference of front and back (zero = not checked)
+   static void   SetFrontBackEnergy(double de) { fFrontBackEnergy = de; }
+   /// Maximum time difference of front and back in ns (zero = not checked)
+   static void   SetFrontBackTime(double time) { fFrontBackTime = time; }
+   static double GetFrontBackEnergy() { return fFrontBackEnergy; }
+   static double GetFrontBackTime() { return fFrontBackTime; }
 
    int GetSize() const { return Hits().size(); }   //!<!
 
@@ -62,12 +69,10 @@ private:
    int  CombineHits(TSharc2Hit*, TSharc2Hit*, int, int);        //!<!
    void RemoveHits(std::vector<TSharc2Hit>*, std::set<int>*);   //!<!
 
-   // TODO: I think this class could be sped up with a flag method on these transient vectors.
-   // Not sure what is supposed to get sped up here, the transient vectors are only used
-   // to store fragments in them before the hits are build.
-   // After that these vectors aren't used again.
-   std::vector<TFragment> fFrontFragments;   //!
-   std::vector<TFragment> fBackFragments;    //!
+   TSharcHitBuilder<TSharc2Hit> fBuilder;   //!<! fragments of the event, bucketed by detector
+
+   static double fFrontBackEnergy;   //!<!
+   static double fFrontBackTime;     //!<!
 
 public:
    static double GetDetectorThickness(TSharc2Hit& hit, double dist = -1.0);   //!
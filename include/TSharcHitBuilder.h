@@ -0,0 +1,172 @@
+#ifndef TSHARCHITBUILDER_H
+#define TSHARCHITBUILDER_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TSharcHitBuilder
+///
+/// Builds the hits of TSharc and TSharc2 (the template parameter
+/// is the hit class) out of the front, back, and pad fragments of
+/// an event.
+///
+/// The fragments are kept as shared pointers, and their indices
+/// are bucketed by detector number (the array position of the
+/// mnemonic, so at most kMaxDetectors). Each front is matched with
+/// a back of the same detector, and each hit with a pad of the same
+/// detector, by going through the buckets only, so nothing is
+/// copied or erased.
+///
+/// Without any criteria the n-th front of a detector is matched
+/// with its n-th back and the n-th hit with its n-th pad, exactly
+/// as the old loops did. If an energy window is set, fronts are
+/// only matched with backs whose relative energy difference
+/// (|Ef - Eb| / ((Ef + Eb) / 2)) is below it, choosing the one
+/// with the smallest difference. If a time window is set, the
+/// time difference of front and back has to be below it as well.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "TFragment.h"
+
+template <class THit>
+class TSharcHitBuilder {
+public:
+   static constexpr int kMaxDetectors = 100;
+
+   void AddFront(const std::shared_ptr<const TFragment>& frag) { Add(frag, fFronts, &TBucket::fFronts); }
+   void AddBack(const std::shared_ptr<const TFragment>& frag) { Add(frag, fBacks, &TBucket::fBacks); }
+   void AddPad(const std::shared_ptr<const TFragment>& frag) { Add(frag, fPads, &TBucket::fPads); }
+
+   /// Builds the hits and passes them to addHit (which takes ownership) in the order of the fronts.
+   /// An energy window or time window (in ns) of zero or less disables that criterion.
+   template <class TAddHit>
+   void Build(double energyWindow, double timeWindow, TAddHit addHit)
+   {
+      for(const auto& front : fFronts) {
+         auto& bucket = fBuckets[front->GetDetector()];
+         int   back   = FindBack(*front, bucket, energyWindow, timeWindow);
+         if(back < 0) {
+            continue;
+         }
+         auto* hit = new THit;
+         hit->SetFront(*front);
+         hit->SetBack(*fBacks[back]);
+         if(bucket.fNextPad < bucket.fPads.size()) {
+            hit->SetPad(*fPads[bucket.fPads[bucket.fNextPad++]]);
+         }
+         addHit(hit);
+      }
+   }
+
+   void Clear()
+   {
+      for(auto detector : fUsedDetectors) {
+         fBuckets[detector].Clear();
+      }
+      fUsedDetectors.clear();
+      fFronts.clear();
+      fBacks.clear();
+      fPads.clear();
+   }
+
+private:
+   struct TBucket {
+      std::vector<uint32_t> fFronts;
+      std::vector<uint32_t> fBacks;
+      std::vector<uint32_t> fPads;
+      std::vector<char>     fBackUsed;
+      size_t                fNextBack{0};   ///< first back that might not be used yet
+      size_t                fNextPad{0};
+      bool                  fUsed{false};
+
+      void Clear()
+      {
+         fFronts.clear();
+         fBacks.clear();
+         fPads.clear();
+         fBackUsed.clear();
+         fNextBack = 0;
+         fNextPad  = 0;
+         fUsed     = false;
+      }
+   };
+
+   void Add(const std::shared_ptr<const TFragment>& frag, std::vector<std::shared_ptr<const TFragment>>& fragments, std::vector<uint32_t> TBucket::*indices)
+   {
+      const int detector = frag->GetDetector();
+      if(detector < 0 || detector >= kMaxDetectors) {
+         return;
+      }
+      auto& bucket = fBuckets[detector];
+      if(!bucket.fUsed) {
+         bucket.fUsed = true;
+         fUsedDetectors.push_back(static_cast<int16_t>(detector));
+      }
+      (bucket.*indices).push_back(static_cast<uint32_t>(fragments.size()));
+      fragments.push_back(frag);
+   }
+
+   /// Index of the back fragment matched with the front (and marks it as used), -1 if there is none.
+   int FindBack(const TFragment& front, TBucket& bucket, double energyWindow, double timeWindow)
+   {
+      bucket.fBackUsed.resize(bucket.fBacks.size(), 0);
+      if(energyWindow <= 0. && timeWindow <= 0.) {
+         // the first back that isn't used yet, all backs before it are used
+         if(bucket.fNextBack >= bucket.fBacks.size()) {
+            return -1;
+         }
+         bucket.fBackUsed[bucket.fNextBack] = 1;
+         return static_cast<int>(bucket.fBacks[bucket.fNextBack++]);
+      }
+
+      int    best           = -1;
+      double bestDifference = 0.;
+      for(size_t i = bucket.fNextBack; i < bucket.fBacks.size(); ++i) {
+         if(bucket.fBackUsed[i] != 0) {
+            continue;
+         }
+         const auto& back = *fBacks[bucket.fBacks[i]];
+         if(timeWindow > 0. && std::fabs(front.GetTime() - back.GetTime()) >= timeWindow) {
+            continue;
+         }
+         if(energyWindow <= 0.) {
+            best = static_cast<int>(i);
+            break;
+         }
+         double difference = std::fabs(front.GetEnergy() - back.GetEnergy());
+         if(difference / ((front.GetEnergy() + back.GetEnergy()) / 2.) >= energyWindow) {
+            continue;
+         }
+         if(best < 0 || difference < bestDifference) {
+            best           = static_cast<int>(i);
+            bestDifference = difference;
+         }
+      }
+      if(best < 0) {
+         return -1;
+      }
+      bucket.fBackUsed[best] = 1;
+      while(bucket.fNextBack < bucket.fBacks.size() && bucket.fBackUsed[bucket.fNextBack] != 0) {
+         ++bucket.fNextBack;
+      }
+      return static_cast<int>(bucket.fBacks[best]);
+   }
+
+   std::array<TBucket, kMaxDetectors>            fBuckets;
+   std::vector<int16_t>                          fUsedDetectors;
+   std::vector<std::shared_ptr<const TFragment>> fFronts;
+   std::vector<std::shared_ptr<const TFragment>> fBacks;
+   std::vector<std::shared_ptr<const TFragment>> fPads;
+};
+/*! @} */
+#endif
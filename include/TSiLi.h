@@ -114,6 +114,10 @@ public:
    // 3 use slow TF1 with experimental oscillation
    static int    fFitSiLiShape;   //!<!
    static double fBaseFreq;       //!<!
+   // If set, the fits of 1 and 2 are done with the fast TSiLiShapeFitter instead of the slow TF1 (which is still used
+   // if the fast fit fails). Off by default, as the fast fit stores its own signal-to-noise and Smirnov values (see
+   // TSiLiHit::GetTemplateSig2Noise) instead of the ones of TPulseAnalyzer.
+   static bool fSiLiTemplateFit;   //!<!
 
 private:
    std::vector<TSiLiHit>     fAddbackHits;   //!<!
@@ -46,6 +46,10 @@ public:
 
    Double_t GetSig2Noise() const { return fSig2Noise; }
    Double_t GetSmirnov() const { return fSmirnov; }
+   /// Signal-to-noise and Smirnov values of the template fit (TSiLi::fSiLiTemplateFit), these are defined differently
+   /// from the ones of TPulseAnalyzer (GetSig2Noise and GetSmirnov), so they are kept separately.
+   Double_t GetTemplateSig2Noise() const { return fTemplateSig2Noise; }
+   Double_t GetTemplateSmirnov() const { return fTemplateSmirnov; }
 
    Int_t    GetTimeStampLow() { return GetTimeStamp() & 0x0fffffff; }
    Double_t GetTimeFitns() const
@@ -70,6 +74,7 @@ public:
    static TPulseAnalyzer* FitFrag(const TFragment& frag, int ShapeFit = 0, TChannel* = nullptr);
    static int             FitPulseAnalyzer(TPulseAnalyzer* pulse, int ShapeFit, int segment);
    static int             FitPulseAnalyzer(TPulseAnalyzer* pulse, int ShapeFit = 0, TChannel* = nullptr);
+   static void            GetShapeParameters(TChannel* channel, double& decay, double& rise, double& base);
    TVector3               GetPosition(Double_t dist, bool) const;   //!
    TVector3               GetPosition(bool) const;                  //!
 
@@ -129,6 +134,8 @@ public:
 
 private:
    Double_t GetDefaultDistance() const { return 0.0; }
+   bool     SetWavefit(TPulseAnalyzer* pulse);
+   bool     SetTemplateWavefit(const TFragment& frag);
 
    std::vector<int16_t> fAddBackSegments;   //!<!
    std::vector<double>  fAddBackEnergy;     //!<!
@@ -140,9 +147,11 @@ private:
    Double_t fSmirnov{0.};
    Double_t fFitCharge{0.};
    Double_t fFitBase{0.};
+   Double_t fTemplateSig2Noise{0.};   ///< |amplitude| over the standard deviation of the residuals of the template fit
+   Double_t fTemplateSmirnov{0.};     ///< maximum of the cumulative residuals of the template fit, in units of sigma*sqrt(n)
 
    /// \cond CLASSIMP
-   ClassDefOverride(TSiLiHit, 10);   // NOLINT(readability-else-after-return)
+   ClassDefOverride(TSiLiHit, 11);   // NOLINT(readability-else-after-return)
    /// \endcond
 };
 /*! @} */
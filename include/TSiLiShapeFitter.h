@@ -0,0 +1,308 @@
+#ifndef TSILISHAPEFITTER_H
+#define TSILISHAPEFITTER_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TSiLiShapeFitter
+///
+/// Least-squares fit of the SiLi pulse shape
+///
+/// y(t) = B + A (1 - exp(-(t-t0)/rise)) exp(-(t-t0)/decay)
+///
+/// for t >= t0 (y(t) = B before that) to a waveform, with decay
+/// and rise fixed to the values of the channel. This replaces
+/// the TF1 fit of TPulseAnalyzer.
+///
+/// The shape is the difference of two exponentials, so for a
+/// given t0 it is a linear combination of the powers of
+/// exp(-1/decay) and exp(-1/rise - 1/decay). These powers and their
+/// cumulative sums (and those of their squares and products) are
+/// the template of the channel, they are calculated once for each
+/// decay and rise. With two running sums of the waveform weighted
+/// by the same exponentials, amplitude, baseline, and chi2 of any
+/// t0 are calculated in closed form. The fit then scans all
+/// samples for the best t0 and refines it by a golden-section
+/// search between the neighbouring samples.
+///
+/// All buffers are kept between fits, so once they have grown to
+/// the size of the waveforms nothing is allocated anymore. One
+/// fitter should be used per thread.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+
+class TSiLiShapeFitter {
+public:
+   static constexpr size_t kMinSamples  = 8;    ///< shorter waveforms aren't fitted
+   static constexpr int    kRefineSteps = 24;   ///< golden-section steps, enough for 1e-4 samples
+   static constexpr double kGoldenRatio = 0.6180339887498949;
+
+   struct TResult {
+      double fT0{0.};          ///< start of the pulse in samples
+      double fAmplitude{0.};   ///< A of the shape
+      double fBaseline{0.};    ///< B of the shape
+      double fChi2{0.};        ///< sum of the squared residuals
+      double fSig2Noise{0.};   ///< |A| over the standard deviation of the residuals
+      double fSmirnov{0.};     ///< maximum of the cumulative residuals, in units of sigma*sqrt(n)
+      bool   fGood{false};
+   };
+
+   /// The powers of exp(-1/decay) and exp(-1/rise - 1/decay) and their cumulative sums.
+   class TTemplate {
+   public:
+      TTemplate(double decay, double rise)
+         : fDecayFactor(std::exp(-1. / decay)), fRiseFactor(std::exp(-1. / rise - 1. / decay)), fDecay(decay), fRise(rise)
+      {
+      }
+
+      double DecayFactor() const { return fDecayFactor; }
+      double RiseFactor() const { return fRiseFactor; }
+      double Decay() const { return fDecay; }
+      double Rise() const { return fRise; }
+      size_t Size() const { return fDecayPow.size(); }
+
+      /// Extends the template to (at least) size samples.
+      void Resize(size_t size)
+      {
+         if(size <= Size()) {
+            return;
+         }
+         size_t oldSize = Size();
+         fDecayPow.resize(size);
+         fRisePow.resize(size);
+         fDecaySum.resize(size + 1, 0.);
+         fRiseSum.resize(size + 1, 0.);
+         fDecay2Sum.resize(size + 1, 0.);
+         fRise2Sum.resize(size + 1, 0.);
+         fCrossSum.resize(size + 1, 0.);
+         for(size_t j = oldSize; j < size; ++j) {
+            fDecayPow[j]      = std::exp(-static_cast<double>(j) / fDecay);
+            fRisePow[j]       = std::exp(-static_cast<double>(j) * (1. / fRise + 1. / fDecay));
+            fDecaySum[j + 1]  = fDecaySum[j] + fDecayPow[j];
+            fRiseSum[j + 1]   = fRiseSum[j] + fRisePow[j];
+            fDecay2Sum[j + 1] = fDecay2Sum[j] + fDecayPow[j] * fDecayPow[j];
+            fRise2Sum[j + 1]  = fRise2Sum[j] + fRisePow[j] * fRisePow[j];
+            fCrossSum[j + 1]  = fCrossSum[j] + fDecayPow[j] * fRisePow[j];
+         }
+      }
+
+      std::vector<double> fDecayPow;    ///< exp(-j/decay)
+      std::vector<double> fRisePow;     ///< exp(-j/rise - j/decay)
+      std::vector<double> fDecaySum;    ///< sum of the first m decay powers
+      std::vector<double> fRiseSum;     ///< sum of the first m rise powers
+      std::vector<double> fDecay2Sum;   ///< sum of the first m squared decay powers
+      std::vector<double> fRise2Sum;    ///< sum of the first m squared rise powers
+      std::vector<double> fCrossSum;    ///< sum of the first m products of decay and rise powers
+
+   private:
+      double fDecayFactor{0.};
+      double fRiseFactor{0.};
+      double fDecay{0.};
+      double fRise{0.};
+   };
+
+   /// The pulse shape without amplitude and baseline, x = t - t0.
+   static double Shape(double x, double decay, double rise)
+   {
+      if(x < 0.) {
+         return 0.;
+      }
+      return (1. - std::exp(-x / rise)) * std::exp(-x / decay);
+   }
+
+   /// Residuals y - B - A*(alpha*decayPow - beta*risePow) of the samples after t0, written to out.
+   static void ResidualKernel(const double* y, const double* decayPow, const double* risePow, size_t size, double amplitude, double baseline, double alpha, double beta, double* out)
+   {
+      const double decayScale = amplitude * alpha;
+      const double riseScale  = amplitude * beta;
+      for(size_t j = 0; j < size; ++j) {
+         out[j] = y[j] - baseline - decayScale * decayPow[j] + riseScale * risePow[j];
+      }
+   }
+
+   /// Template for decay and rise (in samples), extended to size samples.
+   const TTemplate& Template(double decay, double rise, size_t size)
+   {
+      auto it = fTemplates.find(std::make_pair(decay, rise));
+      if(it == fTemplates.end()) {
+         it = fTemplates.emplace(std::make_pair(decay, rise), TTemplate(decay, rise)).first;
+      }
+      it->second.Resize(size);
+      return it->second;
+   }
+
+   TResult Fit(const Short_t* waveform, size_t size, double decay, double rise)
+   {
+      if(size < kMinSamples || !(decay > 0.) || !(rise > 0.)) {
+         return {};
+      }
+      return Fit(waveform, size, Template(decay, rise, size));
+   }
+
+   /// Fits the waveform, the template has to have at least size samples.
+   TResult Fit(const Short_t* waveform, size_t size, const TTemplate& shape)
+   {
+      TResult result;
+      if(size < kMinSamples || shape.Size() < size) {
+         return result;
+      }
+      fTemplate = &shape;
+      fSize     = size;
+
+      // the waveform minus its mean, this removes the baseline from the normal equations
+      fWave.resize(size);
+      fDecayWave.resize(size + 1);
+      fRiseWave.resize(size + 1);
+      double mean = 0.;
+      for(size_t i = 0; i < size; ++i) {
+         mean += waveform[i];
+      }
+      mean /= static_cast<double>(size);
+      fSumSquares = 0.;
+      for(size_t i = 0; i < size; ++i) {
+         fWave[i] = waveform[i] - mean;
+         fSumSquares += fWave[i] * fWave[i];
+      }
+
+      // sums of the waveform from sample k on, weighted with the decay and rise powers
+      fDecayWave[size] = 0.;
+      fRiseWave[size]  = 0.;
+      for(size_t k = size; k-- > 0;) {
+         fDecayWave[k] = fWave[k] + shape.DecayFactor() * fDecayWave[k + 1];
+         fRiseWave[k]  = fWave[k] + shape.RiseFactor() * fRiseWave[k + 1];
+      }
+
+      // scan t0 over the samples (at least one sample of baseline and two of the pulse)
+      size_t bestSample = 0;
+      double bestChi2   = 0.;
+      for(size_t k = 1; k + 2 <= size; ++k) {
+         double chi2 = Evaluate(k, 0.);
+         if(bestSample == 0 || chi2 < bestChi2) {
+            bestSample = k;
+            bestChi2   = chi2;
+         }
+      }
+
+      // refine between the neighbouring samples
+      double low   = static_cast<double>(bestSample) - 1.;
+      double high  = std::min(static_cast<double>(bestSample) + 1., static_cast<double>(size - 2));
+      double left  = high - kGoldenRatio * (high - low);
+      double right = low + kGoldenRatio * (high - low);
+      double chi2L = Evaluate(left);
+      double chi2R = Evaluate(right);
+      for(int step = 0; step < kRefineSteps; ++step) {
+         if(chi2L < chi2R) {
+            high  = right;
+            right = left;
+            chi2R = chi2L;
+            left  = high - kGoldenRatio * (high - low);
+            chi2L = Evaluate(left);
+         } else {
+            low   = left;
+            left  = right;
+            chi2L = chi2R;
+            right = low + kGoldenRatio * (high - low);
+            chi2R = Evaluate(right);
+         }
+      }
+      result.fT0 = static_cast<double>(bestSample);
+      if(std::min(chi2L, chi2R) < bestChi2) {
+         result.fT0 = (chi2L < chi2R) ? left : right;
+      }
+      double chi2 = Evaluate(result.fT0);
+      if(!std::isfinite(chi2)) {
+         return result;
+      }
+
+      result.fAmplitude = fAmplitude;
+      result.fBaseline  = fBaseline + mean;
+      result.fChi2      = std::max(chi2, 0.);
+
+      // residuals, before t0 only the baseline is left
+      size_t first = static_cast<size_t>(std::ceil(result.fT0));
+      double delta = static_cast<double>(first) - result.fT0;
+      fResiduals.resize(size);
+      for(size_t i = 0; i < first; ++i) {
+         fResiduals[i] = fWave[i] - fBaseline;
+      }
+      ResidualKernel(fWave.data() + first, shape.fDecayPow.data(), shape.fRisePow.data(), size - first, fAmplitude, fBaseline,
+                     std::exp(-delta / shape.Decay()), std::exp(-delta * (1. / shape.Rise() + 1. / shape.Decay())), fResiduals.data() + first);
+
+      double sigma = std::sqrt(result.fChi2 / static_cast<double>(size - 3));
+      if(sigma > 0.) {
+         result.fSig2Noise = std::fabs(fAmplitude) / sigma;
+         double sum        = 0.;
+         double maximum    = 0.;
+         for(size_t i = 0; i < size; ++i) {
+            sum += fResiduals[i];
+            maximum = std::max(maximum, std::fabs(sum));
+         }
+         result.fSmirnov = maximum / (sigma * std::sqrt(static_cast<double>(size)));
+      }
+      result.fGood = true;
+
+      return result;
+   }
+
+   const std::vector<double>& Residuals() const { return fResiduals; }   ///< residuals of the last fit
+
+private:
+   /// Chi2 of the fit with the pulse starting at t0, sets fAmplitude and fBaseline.
+   double Evaluate(double t0)
+   {
+      size_t first = static_cast<size_t>(std::ceil(std::max(t0, 0.)));
+      return Evaluate(first, static_cast<double>(first) - t0);
+   }
+
+   /// Chi2 of the fit with the pulse starting at first - delta (0 <= delta < 1), sets fAmplitude and fBaseline.
+   double Evaluate(size_t first, double delta)
+   {
+      const auto&  shape = *fTemplate;
+      const size_t count = fSize - first;
+      const double alpha = (delta == 0.) ? 1. : std::exp(-delta / shape.Decay());
+      const double beta  = (delta == 0.) ? 1. : std::exp(-delta * (1. / shape.Rise() + 1. / shape.Decay()));
+
+      // sums over the shape s(t) = alpha*decayPow - beta*risePow (which is zero before the first sample)
+      double sumShape    = alpha * shape.fDecaySum[count] - beta * shape.fRiseSum[count];
+      double sumShape2   = alpha * alpha * shape.fDecay2Sum[count] - 2. * alpha * beta * shape.fCrossSum[count] + beta * beta * shape.fRise2Sum[count];
+      double sumShapeY   = alpha * fDecayWave[first] - beta * fRiseWave[first];
+      double n           = static_cast<double>(fSize);
+      double determinant = n * sumShape2 - sumShape * sumShape;
+      if(!(determinant > 0.)) {
+         fAmplitude = 0.;
+         fBaseline  = 0.;
+         return fSumSquares;
+      }
+      // the waveform has zero mean, so the sum of y drops out of the normal equations
+      fAmplitude = n * sumShapeY / determinant;
+      fBaseline  = -fAmplitude * sumShape / n;
+
+      return fSumSquares - fAmplitude * sumShapeY;
+   }
+
+   std::map<std::pair<double, double>, TTemplate> fTemplates;
+
+   const TTemplate*    fTemplate{nullptr};
+   size_t              fSize{0};
+   double              fSumSquares{0.};
+   double              fAmplitude{0.};
+   double              fBaseline{0.};
+   std::vector<double> fWave;         ///< waveform minus its mean
+   std::vector<double> fDecayWave;    ///< sum of the waveform from sample k on, weighted with the decay powers
+   std::vector<double> fRiseWave;     ///< sum of the waveform from sample k on, weighted with the rise powers
+   std::vector<double> fResiduals;
+};
+/*! @} */
+#endif
@@ -0,0 +1,327 @@
+#ifndef TSTRIPMATCHER_H
+#define TSTRIPMATCHER_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TStripMatcher
+///
+/// Matches the front and back strips of a double-sided strip
+/// detector by their energies. Two strips can be matched if the
+/// relative difference of their energies is below the window
+/// (|a - b| / ((a + b) / 2) < window). With sum hits enabled, a
+/// strip can also be matched with two strips of the other side
+/// whose energies add up to its energy (e.g. charge sharing).
+///
+/// Match finds the assignment that uses the most strips, and of
+/// those the one with the smallest sum of absolute energy
+/// differences. Strips without any possible partner are pruned
+/// first, and the remaining strips are assigned exactly (by
+/// dynamic programming over the subsets of strips) as long as
+/// there are at most kMaxExact of them. Larger events fall back
+/// to a greedy assignment of the pairs (and sum hits) with the
+/// smallest energy differences first.
+///
+/// The matcher only works on indices and energies, so it can be
+/// used for any detector. The vectors are kept between calls, so
+/// one matcher should be re-used for all events.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class TStripMatcher {
+public:
+   /// Indices of the front and back strips of a match, the second index is -1 unless it is a sum hit.
+   struct TMatch {
+      std::array<int16_t, 2> fFront{-1, -1};
+      std::array<int16_t, 2> fBack{-1, -1};
+      double                 fCost{0.};   ///< absolute energy difference
+   };
+
+   static constexpr size_t kMaxExact = 16;
+
+   double Window() const { return fWindow; }
+   void   Window(double window) { fWindow = window; }
+   bool   SumHits() const { return fSumHits; }
+   void   SumHits(bool sumHits) { fSumHits = sumHits; }
+
+   /// Matches the strips and returns the number of matches.
+   size_t Match(size_t nofFront, const double* front, size_t nofBack, const double* back)
+   {
+      fMatches.clear();
+      fFrontUsed.assign(nofFront, 0);
+      fBackUsed.assign(nofBack, 0);
+      fFront = front;
+      fBack  = back;
+
+      // prune all strips that can't be matched with anything
+      fKeptFront.clear();
+      fKeptBack.clear();
+      std::vector<char> backPossible(nofBack, 0);
+      for(size_t f = 0; f < nofFront; ++f) {
+         bool possible = false;
+         for(size_t b = 0; b < nofBack; ++b) {
+            if(Accept(front[f], back[b])) {
+               possible        = true;
+               backPossible[b] = 1;
+            }
+         }
+         if(fSumHits) {
+            for(size_t b1 = 0; b1 < nofBack; ++b1) {
+               for(size_t b2 = b1 + 1; b2 < nofBack; ++b2) {
+                  if(Accept(front[f], back[b1] + back[b2])) {
+                     possible         = true;
+                     backPossible[b1] = 1;
+                     backPossible[b2] = 1;
+                  }
+               }
+            }
+            for(size_t f2 = 0; f2 < nofFront; ++f2) {
+               for(size_t b = 0; b < nofBack && f2 != f; ++b) {
+                  if(Accept(front[f] + front[f2], back[b])) {
+                     possible        = true;
+                     backPossible[b] = 1;
+                  }
+               }
+            }
+         }
+         if(possible) {
+            fKeptFront.push_back(static_cast<int16_t>(f));
+         }
+      }
+      for(size_t b = 0; b < nofBack; ++b) {
+         if(backPossible[b] != 0) {
+            fKeptBack.push_back(static_cast<int16_t>(b));
+         }
+      }
+
+      if(fKeptFront.size() + fKeptBack.size() <= kMaxExact) {
+         MatchExact();
+      } else {
+         MatchGreedy();
+      }
+
+      for(const auto& match : fMatches) {
+         for(auto f : match.fFront) {
+            if(f >= 0) {
+               fFrontUsed[f] = 1;
+            }
+         }
+         for(auto b : match.fBack) {
+            if(b >= 0) {
+               fBackUsed[b] = 1;
+            }
+         }
+      }
+      return fMatches.size();
+   }
+
+   const std::vector<TMatch>& Matches() const { return fMatches; }
+   bool                       FrontUsed(size_t i) const { return fFrontUsed[i] != 0; }
+   bool                       BackUsed(size_t i) const { return fBackUsed[i] != 0; }
+
+private:
+   struct TState {
+      int8_t  fStrips{-1};   ///< number of strips used by the best assignment of the remaining strips (-1 = not known yet)
+      double  fCost{0.};
+      uint8_t fType{0};      ///< 0 = unmatched, 1 = pair, 2 = front with two backs, 3 = two fronts with back
+      int8_t  fFirst{-1};    ///< partner(s) of the lowest remaining strip (positions in the kept strips)
+      int8_t  fSecond{-1};
+   };
+
+   bool Accept(double a, double b) const { return std::fabs(a - b) / ((a + b) / 2.) < fWindow; }
+
+   /// Best assignment of the strips not in mask, the kept fronts are the lowest bits, followed by the kept backs.
+   const TState& Solve(uint32_t mask)
+   {
+      auto& state = fStates[mask];
+      if(state.fStrips >= 0) {
+         return state;
+      }
+      const auto nofFront = static_cast<int>(fKeptFront.size());
+      const auto nofAll   = static_cast<int>(fKeptFront.size() + fKeptBack.size());
+      int        lowest   = 0;
+      while(lowest < nofAll && (mask & (1U << lowest)) != 0) {
+         ++lowest;
+      }
+      // once all fronts are decided the remaining backs stay unmatched
+      if(lowest >= nofFront) {
+         state.fStrips = 0;
+         state.fCost   = 0.;
+         state.fType   = 0;
+         return state;
+      }
+
+      TState best;
+      {
+         const auto& rest = Solve(mask | (1U << lowest));
+         best.fStrips     = rest.fStrips;
+         best.fCost       = rest.fCost;
+      }
+      auto consider = [&best](int strips, double cost, uint8_t type, int first, int second) {
+         if(strips > best.fStrips || (strips == best.fStrips && cost < best.fCost)) {
+            best.fStrips = static_cast<int8_t>(strips);
+            best.fCost   = cost;
+            best.fType   = type;
+            best.fFirst  = static_cast<int8_t>(first);
+            best.fSecond = static_cast<int8_t>(second);
+         }
+      };
+
+      const double energy = fFront[fKeptFront[lowest]];
+      for(int b = nofFront; b < nofAll; ++b) {
+         if((mask & (1U << b)) != 0) {
+            continue;
+         }
+         const double backEnergy = fBack[fKeptBack[b - nofFront]];
+         if(Accept(energy, backEnergy)) {
+            const auto& rest = Solve(mask | (1U << lowest) | (1U << b));
+            consider(rest.fStrips + 2, rest.fCost + std::fabs(energy - backEnergy), 1, b, -1);
+         }
+         if(!fSumHits) {
+            continue;
+         }
+         for(int b2 = b + 1; b2 < nofAll; ++b2) {
+            if((mask & (1U << b2)) != 0) {
+               continue;
+            }
+            const double sum = backEnergy + fBack[fKeptBack[b2 - nofFront]];
+            if(Accept(energy, sum)) {
+               const auto& rest = Solve(mask | (1U << lowest) | (1U << b) | (1U << b2));
+               consider(rest.fStrips + 3, rest.fCost + std::fabs(energy - sum), 2, b, b2);
+            }
+         }
+         for(int f2 = lowest + 1; f2 < nofFront; ++f2) {
+            if((mask & (1U << f2)) != 0) {
+               continue;
+            }
+            const double sum = energy + fFront[fKeptFront[f2]];
+            if(Accept(sum, backEnergy)) {
+               const auto& rest = Solve(mask | (1U << lowest) | (1U << f2) | (1U << b));
+               consider(rest.fStrips + 3, rest.fCost + std::fabs(sum - backEnergy), 3, b, f2);
+            }
+         }
+      }
+
+      state = best;
+      return state;
+   }
+
+   void MatchExact()
+   {
+      const auto nofFront = static_cast<int>(fKeptFront.size());
+      const auto nofAll   = static_cast<int>(fKeptFront.size() + fKeptBack.size());
+      fStates.assign(static_cast<size_t>(1) << nofAll, TState());
+      uint32_t mask = 0;
+      while(true) {
+         int lowest = 0;
+         while(lowest < nofAll && (mask & (1U << lowest)) != 0) {
+            ++lowest;
+         }
+         if(lowest >= nofFront) {
+            break;
+         }
+         const auto& state = Solve(mask);
+         mask |= 1U << lowest;
+         if(state.fStrips <= 0 || state.fType == 0) {
+            continue;
+         }
+         TMatch match;
+         match.fFront[0] = fKeptFront[lowest];
+         match.fBack[0]  = fKeptBack[state.fFirst - nofFront];
+         mask |= 1U << state.fFirst;
+         if(state.fType == 2) {
+            match.fBack[1] = fKeptBack[state.fSecond - nofFront];
+            mask |= 1U << state.fSecond;
+         } else if(state.fType == 3) {
+            match.fFront[1] = fKeptFront[state.fSecond];
+            mask |= 1U << state.fSecond;
+         }
+         double frontEnergy = fFront[match.fFront[0]] + (match.fFront[1] >= 0 ? fFront[match.fFront[1]] : 0.);
+         double backEnergy  = fBack[match.fBack[0]] + (match.fBack[1] >= 0 ? fBack[match.fBack[1]] : 0.);
+         match.fCost        = std::fabs(frontEnergy - backEnergy);
+         fMatches.push_back(match);
+      }
+   }
+
+   void MatchGreedy()
+   {
+      /// Greedy assignment for large events, the candidates (including sum hits if they are enabled) are taken in
+      /// order of their energy differences, skipping all candidates that use an already taken strip.
+      std::vector<TMatch> candidates;
+      auto                add = [&candidates](int16_t f1, int16_t f2, int16_t b1, int16_t b2, double cost) {
+         TMatch match;
+         match.fFront = {f1, f2};
+         match.fBack  = {b1, b2};
+         match.fCost  = cost;
+         candidates.push_back(match);
+      };
+      for(size_t i = 0; i < fKeptFront.size(); ++i) {
+         const auto f = fKeptFront[i];
+         for(size_t j = 0; j < fKeptBack.size(); ++j) {
+            const auto b = fKeptBack[j];
+            if(Accept(fFront[f], fBack[b])) {
+               add(f, -1, b, -1, std::fabs(fFront[f] - fBack[b]));
+            }
+            if(!fSumHits) {
+               continue;
+            }
+            for(size_t k = j + 1; k < fKeptBack.size(); ++k) {
+               const double sum = fBack[b] + fBack[fKeptBack[k]];
+               if(Accept(fFront[f], sum)) {
+                  add(f, -1, b, fKeptBack[k], std::fabs(fFront[f] - sum));
+               }
+            }
+            for(size_t k = i + 1; k < fKeptFront.size(); ++k) {
+               const double sum = fFront[f] + fFront[fKeptFront[k]];
+               if(Accept(sum, fBack[b])) {
+                  add(f, fKeptFront[k], b, -1, std::fabs(sum - fBack[b]));
+               }
+            }
+         }
+      }
+      std::stable_sort(candidates.begin(), candidates.end(), [](const TMatch& a, const TMatch& b) { return a.fCost < b.fCost; });
+      std::vector<char> frontTaken(fFrontUsed.size(), 0);
+      std::vector<char> backTaken(fBackUsed.size(), 0);
+      auto              taken = [](const std::vector<char>& used, const std::array<int16_t, 2>& strips) {
+         return used[strips[0]] != 0 || (strips[1] >= 0 && used[strips[1]] != 0);
+      };
+      for(const auto& match : candidates) {
+         if(taken(frontTaken, match.fFront) || taken(backTaken, match.fBack)) {
+            continue;
+         }
+         for(auto f : match.fFront) {
+            if(f >= 0) {
+               frontTaken[f] = 1;
+            }
+         }
+         for(auto b : match.fBack) {
+            if(b >= 0) {
+               backTaken[b] = 1;
+            }
+         }
+         fMatches.push_back(match);
+      }
+   }
+
+   double               fWindow{0.2};
+   bool                 fSumHits{false};
+   const double*        fFront{nullptr};
+   const double*        fBack{nullptr};
+   std::vector<int16_t> fKeptFront;
+   std::vector<int16_t> fKeptBack;
+   std::vector<TState>  fStates;
+   std::vector<TMatch>  fMatches;
+   std::vector<char>    fFrontUsed;
+   std::vector<char>    fBackUsed;
+};
+/*! @} */
+#endif
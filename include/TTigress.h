@@ -12,6 +12,9 @@
 
 #include "TVector3.h"
 
+#include "TCounterRandom.h"
+#include "TDopplerTable.h"
+
 #include "TTigressHit.h"
 #include "TSuppressed.h"
 #include "TTransientBits.h"
@@ -48,8 +51,12 @@ public:
 
    TTigressHit* GetTigressHit(const int& i);   //!<!
 
-   static TVector3    GetPosition(int DetNbr, int CryNbr, int SegNbr, double dist = 110.0, bool smear = false);   //!<!
-   static TVector3    GetPosition(const TTigressHit* hit, double dist = 110.0, bool smear = false);               //!<!
+   static TVector3    GetPosition(int DetNbr, int CryNbr, int SegNbr, double dist = 110.0, bool smear = false);      //!<!
+   static TVector3    GetPosition(const TTigressHit* hit, double dist = 110.0, bool smear = false);                  //!<!
+   static TVector3    GetSmearedPosition(int DetNbr, int CryNbr, int SegNbr, double dist, TCounterRandom& random);   //!<!
+   /// Doppler corrected energies of n hits, given as arrays of their detector, crystal, segment, and energy, for a recoil
+   /// with velocity beta (in units of c). Same as TTigressHit::GetDoppler using the (unsmeared) position of the segment.
+   static void GetDopplerEnergies(size_t n, const int* detector, const int* crystal, const int* segment, const double* energy, const TVector3& beta, double* corrected, double dist = 110.0);   //!<!
    static const char* GetColorFromNumber(int number);
 #ifndef __CINT__
    void AddFragment(const std::shared_ptr<const TFragment>&, TChannel*) override;   //!<!
@@ -136,6 +143,8 @@ private:
    // Vectors constructed from segment array and manual adjustments once at start of sort
    static std::array<std::array<std::array<std::array<TVector3, 9>, 4>, 17>, 2> fPositionVectors;   //!<!
 
+   static std::array<TDopplerTable, 2> fDopplerTables;   //!<! directions of fPositionVectors for GetDopplerEnergies
+
    static std::array<TVector3, 17>                fCloverRadial;   //!<! direction vector of each HPGe Clover
    static std::array<std::array<TVector3, 2>, 17> fCloverCross;    //!<!  clover perpendicular vectors, for smearing
 
@@ -160,6 +169,12 @@ private:
    mutable std::vector<TDetectorHit*> fSuppressedAddbackHits;    //!<! Used to create suppressed addback hits on the fly
    mutable std::vector<UShort_t>      fSuppressedAddbackFrags;   //!<! Number of crystals involved in creating in the suppressed addback hit
 
+   std::array<std::array<int16_t, 4>, 17> fCrystalHitIndex{};   //!<! index of the hit of each detector and crystal in the hit vector (-1 if there is none)
+
+   TTigressHit* FindCrystalHit(int detector, int crystal);
+   void         SetCrystalHit(int detector, int crystal);
+   void         ClearCrystalHits();
+
    // This is where the general untouchable functions live.
    void          ClearStatus() const { fTigressBits = 0; }   //!<!
    void          SetBitNumber(ETigressBits bit, Bool_t set) const;
@@ -174,6 +189,7 @@ private:
    void SetCrossTalk(bool flag = true) const;
 
    static void BuildVectors();
+   static int  PositionIndex(double dist);   ///< index of fPositionVectors for this distance
 
 public:
    void Copy(TObject&) const override;              //!<!
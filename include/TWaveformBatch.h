@@ -0,0 +1,141 @@
+#ifndef TWAVEFORMBATCH_H
+#define TWAVEFORMBATCH_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TWaveformBatch
+///
+/// Batch mode for re-analysing the waveforms of many hits (e.g.
+/// deriving the CFD and PSD of all DESCANT, ZeroDegree, or SCEPTAR
+/// hits of a run again from the stored traces).
+///
+/// Add only stores a pointer to the hit, the hits themselves are
+/// analysed in place. Once enough hits have been gathered (chunk
+/// size times chunks per flush), or when Flush is called, the hits
+/// are split into chunks of consecutive hits and AnalyzeWaveform is
+/// called on all of them, with the chunks being spread over a
+/// TWorkerPool. Afterwards the (optional) callback is called for
+/// each hit, in the order they were added, with the re-analysed hit
+/// and the result of AnalyzeWaveform.
+///
+/// The hits have to stay alive (and must not be added twice) until
+/// the batch has been flushed, so Flush has to be called before the
+/// detector they belong to is cleared or read again, and at the end
+/// to process the last hits.
+///
+/// \code
+/// TWaveformBatch<TDescantHit> batch([&](TDescantHit& hit, bool ok) { psd->Fill(hit.GetPsd()); });
+/// for(...) {
+///    batch.Add(*descant->GetDescantHit(i));
+/// }
+/// batch.Flush();
+/// \endcode
+///
+/////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "TGRSIOptions.h"
+#include "TWorkerPool.h"
+
+/// Pool shared by all waveform analyses (the batches and the TIGRESS waveform fits). The number of extra threads can
+/// be set with the user setting "Waveform.AnalysisThreads". By default there are none, i.e. the thread calling Flush
+/// does all the work itself, as the sorting usually runs several threads already.
+inline TWorkerPool& WaveformAnalysisPool()
+{
+   static TWorkerPool pool([]() -> size_t {
+      int nofThreads = 0;
+      if(TGRSIOptions::Get() != nullptr && TGRSIOptions::UserSettings() != nullptr) {
+         try {
+            nofThreads = TGRSIOptions::UserSettings()->GetInt("Waveform.AnalysisThreads", true);
+         } catch(std::out_of_range&) {}
+      }
+      return static_cast<size_t>(std::max(nofThreads, 0));
+   }());
+   return pool;
+}
+
+template <class THit>
+class TWaveformBatch {
+public:
+   using TCallback = std::function<void(THit&, bool)>;
+
+   /// The chunk size is the number of consecutive hits one thread analyses at once. Without a pool the shared
+   /// WaveformAnalysisPool is used.
+   explicit TWaveformBatch(TCallback callback = nullptr, size_t chunkSize = 64, TWorkerPool* pool = nullptr)
+      : fCallback(std::move(callback)), fPool(pool != nullptr ? pool : &WaveformAnalysisPool())
+   {
+      ChunkSize(chunkSize);
+      ChunksPerFlush(4 * (fPool->Size() + 1));
+   }
+   TWaveformBatch(const TWaveformBatch&)                = delete;
+   TWaveformBatch(TWaveformBatch&&) noexcept            = default;
+   TWaveformBatch& operator=(const TWaveformBatch&)     = delete;
+   TWaveformBatch& operator=(TWaveformBatch&&) noexcept = default;
+   ~TWaveformBatch()                                    = default;
+
+   size_t ChunkSize() const { return fChunkSize; }
+   void   ChunkSize(size_t chunkSize)
+   {
+      fChunkSize = std::max(chunkSize, static_cast<size_t>(1));
+      fHits.reserve(fChunkSize * fChunksPerFlush);
+   }
+   /// Number of chunks gathered before they are analysed, by default four per thread.
+   size_t ChunksPerFlush() const { return fChunksPerFlush; }
+   void   ChunksPerFlush(size_t chunks)
+   {
+      fChunksPerFlush = std::max(chunks, static_cast<size_t>(1));
+      fHits.reserve(fChunkSize * fChunksPerFlush);
+   }
+
+   size_t Size() const { return fHits.size(); }   ///< number of hits waiting to be analysed
+
+   /// Adds the hit to the batch, analyses the batch if it is full.
+   void Add(THit& hit)
+   {
+      fHits.push_back(&hit);
+      if(fHits.size() >= fChunkSize * fChunksPerFlush) {
+         Flush();
+      }
+   }
+
+   /// Analyses all hits of the batch, calls the callback for each of them (in the order they were added), and clears
+   /// the batch. Returns the number of hits.
+   size_t Flush()
+   {
+      const size_t nofHits   = fHits.size();
+      const size_t nofChunks = (nofHits + fChunkSize - 1) / fChunkSize;
+      fResults.assign(nofHits, 0);
+      fPool->ForEach(nofChunks, [this, nofHits](size_t chunk) {
+         const size_t end = std::min(nofHits, (chunk + 1) * fChunkSize);
+         for(size_t i = chunk * fChunkSize; i < end; ++i) {
+            fResults[i] = fHits[i]->AnalyzeWaveform() ? 1 : 0;
+         }
+      });
+      if(fCallback) {
+         for(size_t i = 0; i < nofHits; ++i) {
+            fCallback(*fHits[i], fResults[i] != 0);
+         }
+      }
+      fHits.clear();
+      return nofHits;
+   }
+
+private:
+   TCallback          fCallback;
+   TWorkerPool*       fPool{nullptr};
+   size_t             fChunkSize{1};
+   size_t             fChunksPerFlush{1};
+   std::vector<THit*> fHits;      ///< hits of the batch, analysed in place
+   std::vector<char>  fResults;   ///< result of AnalyzeWaveform for each hit (not vector<bool>, the chunks are written concurrently)
+};
+/*! @} */
+#endif
@@ -0,0 +1,162 @@
+#ifndef TWAVEFORMKERNELS_H
+#define TWAVEFORMKERNELS_H
+
+/** \addtogroup Detectors
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TWaveformKernels
+///
+/// The waveform algorithms shared by TDescantHit, TZeroDegreeHit,
+/// and TSceptarHit: baseline correction per interleaved ADC,
+/// moving-window smoothing, CFD monitor and zero crossing, partial
+/// sums, and the PSD (time at which the partial sum reaches a
+/// fraction of the total sum).
+///
+/// All kernels work on plain arrays (pointer and size), write into
+/// memory provided by the caller, and never allocate. The loops
+/// are kept free of branches and bounds checks where possible, so
+/// the compiler can vectorize them. The smoothing uses a running
+/// sum, i.e. its cost doesn't depend on the window size.
+///
+/// The results are identical to the old per-class implementations,
+/// including the truncation of the smoothed waveform and the CFD
+/// monitor to Short_t.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstddef>
+
+#include "Rtypes.h"
+
+class TWaveformKernels {
+public:
+   static constexpr size_t kNofAdcs = 8;   ///< number of interleaved ADCs of the digitizer
+
+   /// Subtracts the baseline of each of the interleaved ADCs (the rounded average of its first two samples) and
+   /// writes the corrected waveform into out (which can be the same as in).
+   static void BaselineCorrect(const Short_t* in, size_t size, Short_t* out)
+   {
+      std::array<Int_t, kNofAdcs> corrections{};
+      for(size_t i = 0; i < kNofAdcs && i < size; ++i) {
+         corrections[i] = in[i];
+      }
+      for(size_t i = kNofAdcs; i < 2 * kNofAdcs && i < size; ++i) {
+         Int_t sum                   = corrections[i - kNofAdcs] + in[i];
+         corrections[i - kNofAdcs] = (sum + (sum > 0 ? 1 : -1)) >> 1;
+      }
+      size_t i = 0;
+      for(; i + kNofAdcs <= size; i += kNofAdcs) {
+         for(size_t adc = 0; adc < kNofAdcs; ++adc) {
+            out[i + adc] = static_cast<Short_t>(in[i + adc] - corrections[adc]);
+         }
+      }
+      for(size_t adc = 0; i < size; ++i, ++adc) {
+         out[i] = static_cast<Short_t>(in[i] - corrections[adc]);
+      }
+   }
+
+   /// Size of the smoothed waveform (2*halfWindow samples shorter than the waveform).
+   static size_t SmoothedSize(size_t size, unsigned int halfWindow) { return size > 2 * halfWindow ? size - 2 * halfWindow : 0; }
+
+   /// Sum of the 2*halfWindow+1 samples around each sample, out needs SmoothedSize(size, halfWindow) entries.
+   static size_t Smooth(const Short_t* in, size_t size, unsigned int halfWindow, Short_t* out)
+   {
+      size_t outSize = SmoothedSize(size, halfWindow);
+      if(outSize == 0) {
+         return 0;
+      }
+      Int_t sum = 0;
+      for(size_t i = 0; i <= 2 * halfWindow; ++i) {
+         sum += in[i];
+      }
+      out[0] = static_cast<Short_t>(sum);
+      for(size_t i = 1; i < outSize; ++i) {
+         sum += in[i + 2 * halfWindow] - in[i - 1];
+         out[i] = static_cast<Short_t>(sum);
+      }
+      return outSize;
+   }
+
+   /// CFD monitor attenuation*in[i] - in[i-delay] for all i >= delay, out needs size-delay entries.
+   static size_t CfdMonitor(const Short_t* in, size_t size, double attenuation, unsigned int delay, Short_t* out)
+   {
+      if(size <= delay) {
+         return 0;
+      }
+      const size_t   outSize = size - delay;
+      const Short_t* delayed = in + delay;
+      for(size_t i = 0; i < outSize; ++i) {
+         out[i] = static_cast<Short_t>(attenuation * delayed[i] - in[i]);
+      }
+      return outSize;
+   }
+
+   /// Time of the last zero crossing of the monitor after it reached a new maximum (in interpolation steps, linearly
+   /// interpolated between the two samples), zero if there is none.
+   static Int_t CfdZeroCrossing(const Short_t* monitor, size_t size, unsigned int interpolationSteps)
+   {
+      Short_t max   = 0;
+      bool    armed = false;
+      Int_t   cfd   = 0;
+      for(size_t i = 0; i < size; ++i) {
+         if(monitor[i] > max) {
+            armed = true;
+            max   = monitor[i];
+         } else if(armed && monitor[i] < 0) {
+            armed = false;
+            if(monitor[i - 1] - monitor[i] != 0) {
+               cfd = static_cast<Int_t>((i - 1) * interpolationSteps + (monitor[i - 1] * interpolationSteps) / (monitor[i - 1] - monitor[i]));
+            } else {
+               // should be impossible, since monitor[i-1] >= 0 and monitor[i] < 0
+               cfd = 0;
+            }
+         }
+      }
+      return cfd;
+   }
+
+   /// Running sum of the waveform, out needs size entries.
+   static void PartialSums(const Short_t* in, size_t size, Int_t* out)
+   {
+      Int_t sum = 0;
+      for(size_t i = 0; i < size; ++i) {
+         sum += in[i];
+         out[i] = sum;
+      }
+   }
+
+   /// Sum of all samples of the waveform (the last partial sum).
+   static Int_t Sum(const Short_t* in, size_t size)
+   {
+      Int_t sum = 0;
+      for(size_t i = 0; i < size; ++i) {
+         sum += in[i];
+      }
+      return sum;
+   }
+
+   /// Time (in interpolation steps) at which the partial sums reach the fraction of the total sum, interpolated using
+   /// the waveform sample at that time, zero if the first sample already reaches it.
+   static Int_t Psd(const Int_t* partialSums, const Short_t* in, size_t size, double fraction, unsigned int interpolationSteps)
+   {
+      if(size == 0) {
+         return -1;
+      }
+      const double threshold = fraction * partialSums[size - 1];
+      if(partialSums[0] >= threshold) {
+         return 0;
+      }
+      for(size_t i = 1; i < size; ++i) {
+         if(partialSums[i] >= threshold) {
+            return static_cast<Int_t>(static_cast<double>(i * interpolationSteps) - ((partialSums[i] - threshold) * interpolationSteps) / in[i]);
+         }
+      }
+      return 0;
+   }
+};
+/*! @} */
+#endif
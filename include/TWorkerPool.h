@@ -0,0 +1,151 @@
+#ifndef TWORKERPOOL_H
+#define TWORKERPOOL_H
+
+/** \addtogroup Sorting
+ *  @{
+ */
+
+/////////////////////////////////////////////////////////////////
+///
+/// \class TWorkerPool
+///
+/// Small pool of worker threads used to spread expensive per-hit
+/// work (e.g. waveform fits) of a batch of hits over several
+/// cores. ForEach(n, task) calls task(i) for all i < n and only
+/// returns once all calls are done, so the results can be used
+/// right away and the order of the hits is never changed.
+///
+/// The calling thread works on its own batch as well, so a pool
+/// without any worker threads simply runs everything serially.
+/// Several threads can call ForEach at the same time, the workers
+/// share out the batches between them.
+///
+/////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TWorkerPool {
+public:
+   explicit TWorkerPool(size_t nofThreads)
+   {
+      fThreads.reserve(nofThreads);
+      for(size_t i = 0; i < nofThreads; ++i) {
+         fThreads.emplace_back(&TWorkerPool::Work, this);
+      }
+   }
+   TWorkerPool(const TWorkerPool&)                = delete;
+   TWorkerPool(TWorkerPool&&) noexcept            = delete;
+   TWorkerPool& operator=(const TWorkerPool&)     = delete;
+   TWorkerPool& operator=(TWorkerPool&&) noexcept = delete;
+   ~TWorkerPool()
+   {
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         fStop = true;
+      }
+      fWake.notify_all();
+      for(auto& thread : fThreads) {
+         thread.join();
+      }
+   }
+
+   size_t Size() const { return fThreads.size(); }
+
+   /// Calls task(i) for all i < n, distributed over the worker threads and the calling thread, and waits until all
+   /// calls have finished. The first exception thrown by any of the calls is re-thrown here.
+   void ForEach(size_t n, const std::function<void(size_t)>& task)
+   {
+      if(fThreads.empty() || n < 2) {
+         for(size_t i = 0; i < n; ++i) {
+            task(i);
+         }
+         return;
+      }
+      auto batch = std::make_shared<TBatch>(task, n);
+      {
+         std::lock_guard<std::mutex> lock(fMutex);
+         fBatches.push_back(batch);
+      }
+      fWake.notify_all();
+
+      Process(*batch);
+
+      std::unique_lock<std::mutex> lock(fMutex);
+      fFinished.wait(lock, [&batch] { return batch->fDone.load() == batch->fSize; });
+      auto position = std::find(fBatches.begin(), fBatches.end(), batch);
+      if(position != fBatches.end()) {
+         fBatches.erase(position);
+      }
+      lock.unlock();
+      if(batch->fException) {
+         std::rethrow_exception(batch->fException);
+      }
+   }
+
+private:
+   struct TBatch {
+      TBatch(const std::function<void(size_t)>& task, size_t size) : fTask(task), fSize(size) {}
+
+      const std::function<void(size_t)>& fTask;   ///< only called while the caller of ForEach is waiting
+      size_t                             fSize;
+      std::atomic<size_t>                fNext{0};
+      std::atomic<size_t>                fDone{0};
+      std::exception_ptr                 fException;   ///< protected by fMutex of the pool
+   };
+
+   void Process(TBatch& batch)
+   {
+      for(size_t i = batch.fNext++; i < batch.fSize; i = batch.fNext++) {
+         try {
+            batch.fTask(i);
+         } catch(...) {
+            std::lock_guard<std::mutex> lock(fMutex);
+            if(!batch.fException) {
+               batch.fException = std::current_exception();
+            }
+         }
+         if(++batch.fDone == batch.fSize) {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fFinished.notify_all();
+         }
+      }
+   }
+
+   void Work()
+   {
+      std::unique_lock<std::mutex> lock(fMutex);
+      while(true) {
+         fWake.wait(lock, [this] { return fStop || !fBatches.empty(); });
+         if(fStop) {
+            return;
+         }
+         auto batch = fBatches.front();
+         if(batch->fNext.load() >= batch->fSize) {
+            // all calls of this batch have been started, the caller removes it once they are done
+            fBatches.pop_front();
+            continue;
+         }
+         lock.unlock();
+         Process(*batch);
+         lock.lock();
+      }
+   }
+
+   std::vector<std::thread>            fThreads;
+   std::mutex                          fMutex;
+   std::condition_variable             fWake;
+   std::condition_variable             fFinished;
+   std::deque<std::shared_ptr<TBatch>> fBatches;
+   bool                                fStop{false};
+};
+/*! @} */
+#endif
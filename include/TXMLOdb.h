@@ -12,51 +12,35 @@
 /// Class to access ODB info from an XML ODB dump at either the begining of a run
 /// or from a seperate file.
 ///
+/// The dump is parsed in a single pass by a small streaming
+/// parser that only understands the subset of XML that MIDAS
+/// writes (odb, dir, key, keyarray, and value elements). Names
+/// and values are decoded in place and indexed by their full
+/// path, see TOdb.
+///
 /////////////////////////////////////////////////////////////////
 
-#include <cstdlib>
-#include <cstdio>
-
-#include <fstream>
-#include <string>
-#include <vector>
-
-#ifdef HAS_XML
-#include "TXMLNode.h"
-#include "TXMLDocument.h"
-#include "TDOMParser.h"
+#include "TOdb.h"
 
-#include "Globals.h"
-
-class TXMLOdb {
+class TXMLOdb : public TOdb {
 public:
    explicit TXMLOdb(char* buffer, int size = 0);
-   TXMLOdb(const TXMLOdb& rhs);
+   TXMLOdb(const TXMLOdb&)                = delete;
    TXMLOdb(TXMLOdb&&) noexcept            = default;
-   TXMLOdb& operator=(const TXMLOdb&)     = default;
+   TXMLOdb& operator=(const TXMLOdb&)     = delete;
    TXMLOdb& operator=(TXMLOdb&&) noexcept = default;
-   virtual ~TXMLOdb();
-
-   TXMLDocument* fDoc;
-   TDOMParser*   fParser;
-   TXMLNode*     fOdb;
-
-   const char* GetNodeName(TXMLNode*);
-   TXMLNode*   FindNode(const char* name, TXMLNode* node = nullptr);
-   TXMLNode*   FindPath(const char* path, TXMLNode* node = nullptr);
-
-   int                      ReadInt(const char* path, int index = 0, int defaultValue = 0xffffffff);
-   std::vector<int>         ReadIntArray(TXMLNode* node);
-   std::vector<double>      ReadDoubleArray(TXMLNode* node);
-   std::vector<std::string> ReadStringArray(TXMLNode* node);
+   ~TXMLOdb() override                    = default;
 
 private:
-   static std::array<char, 256> fTextBuffer;
+   void Parse();
+
+   static char* ParseName(char* pos);
+   static char* ParseAttribute(char* pos, char*& name, char*& value);
+   static char* DecodeEntities(char* begin, char* end);
 
    /// \cond CLASSIMP
-   ClassDef(TXMLOdb, 0)   // NOLINT(readability-else-after-return)
+   ClassDefOverride(TXMLOdb, 0)   // NOLINT(readability-else-after-return)
    /// \endcond
 };
-#endif
 /*! @} */
 #endif
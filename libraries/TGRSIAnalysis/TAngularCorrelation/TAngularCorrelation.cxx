@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <map>
 #include <TAngularCorrelation.h>
+#include "TAngularCorrelationAccumulator.h"
 #include "TVector3.h"
 #include <sys/stat.h>
 #include "TGriffin.h"
@@ -224,6 +225,53 @@ TH2D* TAngularCorrelation::Create2DSlice(TObjArray* hstarray, Double_t min, Doub
    return finalslice;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// Create energy-gated 2D histogram of energy vs. angular index
+///
+/// \param[in] accumulator Gamma-gamma matrices of all angular indices
+/// \param[in] min Minimum of energy gate
+/// \param[in] max Maximum of energy gate
+/// \param[in] fold Switch for turning folding on
+/// \param[in] group Switch for turning grouping on (not yet implemented)
+/// \param[in] name Base name of the returned histogram
+///
+/// Same as the versions for THnSparse and TObjArray, but the projections come
+/// straight from the accumulator (using its prefix sums if they have been built)
+/// X-axis of returned histogram is second energy
+/// Y-axis of returned histogram is angular index
+
+TH2D* TAngularCorrelation::Create2DSlice(const TAngularCorrelationAccumulator* accumulator, Double_t min, Double_t max, Bool_t fold,
+                                         Bool_t group, const char* name)
+{
+   if(accumulator == nullptr) {
+      std::cout << "No accumulator provided, returning without slicing." << std::endl;
+      return nullptr;
+   }
+
+   Int_t bins     = accumulator->NumberOfBins();
+   Int_t ybins    = accumulator->NumberOfIndices();
+   auto* newslice = new TH2D(Form("%s_%i_%i", name, static_cast<Int_t>(min), static_cast<Int_t>(max)),
+                             Form("%s, E_{#gamma 1}=[%.1f,%.1f)", name, min, max), bins, accumulator->Low(), accumulator->High(), ybins, 0, ybins);
+
+   for(Int_t i = 0; i < ybins; i++) {
+      auto counts = accumulator->Project(i, min, max);
+      for(Int_t j = 0; j < bins; j++) {
+         if(counts[j] == 0) {
+            continue;
+         }
+         newslice->SetBinContent(j + 1, i + 1, static_cast<Double_t>(counts[j]));
+         newslice->SetBinError(j + 1, i + 1, sqrt(static_cast<Double_t>(counts[j])));
+      }
+   }
+
+   TH2D* finalslice = Modify2DSlice(newslice, fold, group);
+   if(fold || group) {
+      delete newslice;
+   }
+
+   return finalslice;
+}
+
 TH2D* TAngularCorrelation::Modify2DSlice(TH2* hst, Bool_t fold, Bool_t group)
 {
    if(!fold && !group) {
@@ -0,0 +1,236 @@
+#include "TAngularCorrelationAccumulator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "Globals.h"
+
+TAngularCorrelationAccumulator::TAngularCorrelationAccumulator(int nofIndices, int nofBins, double low, double high)
+   : fNofIndices(nofIndices), fNofBins(nofBins), fLow(low), fHigh(high)
+{
+   if(fNofIndices <= 0 || fNofBins <= 0 || fHigh <= fLow) {
+      std::ostringstream str;
+      str << DRED << "Can't accumulate " << fNofIndices << " angular indices with an invalid binning (" << fNofBins << " bins from " << fLow << " to " << fHigh << ")!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   fCellsPerIndex = RowStart(fNofBins);
+   fCounts.assign(static_cast<size_t>(fNofIndices) * fCellsPerIndex, 0);
+}
+
+int32_t TAngularCorrelationAccumulator::Bin(double energy) const
+{
+   if(!(energy >= fLow && energy < fHigh)) {
+      return -1;
+   }
+   return std::min(static_cast<int32_t>((energy - fLow) * fNofBins / (fHigh - fLow)), fNofBins - 1);
+}
+
+size_t TAngularCorrelationAccumulator::Cell(int index, int32_t bin1, int32_t bin2) const
+{
+   if(bin2 < bin1) {
+      std::swap(bin1, bin2);
+   }
+   return static_cast<size_t>(index) * fCellsPerIndex + RowStart(bin1) + (bin2 - bin1);
+}
+
+TAngularCorrelationAccumulator::TFillBuffer& TAngularCorrelationAccumulator::Buffer()
+{
+   return fBuffers.Get([]() {
+      auto buffer = std::make_unique<TFillBuffer>();
+      buffer->fCells.reserve(kBufferSize);
+      return buffer;
+   });
+}
+
+void TAngularCorrelationAccumulator::Fill(int index, double energy1, double energy2)
+{
+   int32_t bin1 = Bin(energy1);
+   int32_t bin2 = Bin(energy2);
+   if(index < 0 || index >= fNofIndices || bin1 < 0 || bin2 < 0) {
+      return;
+   }
+   auto& cells = Buffer().fCells;
+   cells.push_back(Cell(index, bin1, bin2) | (bin1 == bin2 ? kDiagonal : 0));
+   if(cells.size() >= kBufferSize) {
+      std::lock_guard<std::mutex> lock(fMutex);
+      Add(cells);
+      cells.clear();
+   }
+}
+
+void TAngularCorrelationAccumulator::Add(const std::vector<uint64_t>& cells)
+{
+   for(auto cell : cells) {
+      uint32_t increment = (cell & kDiagonal) != 0 ? 2 : 1;
+      cell &= ~kDiagonal;
+      uint32_t counts = fCounts[cell] + increment;
+      if(counts > std::numeric_limits<uint16_t>::max()) {
+         fOverflow[cell] += 1 << 16;
+         counts -= 1 << 16;
+      }
+      fCounts[cell] = static_cast<uint16_t>(counts);
+   }
+}
+
+void TAngularCorrelationAccumulator::Flush()
+{
+   std::lock_guard<std::mutex> lock(fMutex);
+   fBuffers.ForEach([this](TFillBuffer& buffer) {
+      Add(buffer.fCells);
+      buffer.fCells.clear();
+   });
+}
+
+uint64_t TAngularCorrelationAccumulator::Counts(int index, int32_t bin1, int32_t bin2) const
+{
+   size_t   cell   = Cell(index, bin1, bin2);
+   uint64_t counts = fCounts[cell];
+   if(!fOverflow.empty()) {
+      auto overflow = fOverflow.find(cell);
+      if(overflow != fOverflow.end()) {
+         counts += overflow->second;
+      }
+   }
+   return counts;
+}
+
+void TAngularCorrelationAccumulator::BuildPrefixSums()
+{
+   /// The prefix sums of each index are a full (nBins+1) x nBins table, with row r+1 holding the sum of the rows 0 to r
+   /// of the (symmetric) matrix. Throws if any of the sums doesn't fit into 32 bits.
+   std::lock_guard<std::mutex> lock(fMutex);
+   fPrefixSums.resize(fNofIndices);
+   const size_t nofBins = fNofBins;
+   for(int index = 0; index < fNofIndices; ++index) {
+      auto& sums = fPrefixSums[index];
+      sums.assign((nofBins + 1) * nofBins, 0);
+      std::vector<uint64_t> row(nofBins);
+      for(int32_t bin1 = 0; bin1 < fNofBins; ++bin1) {
+         for(int32_t bin2 = 0; bin2 < fNofBins; ++bin2) {
+            row[bin2] = Counts(index, bin1, bin2);
+         }
+         const uint32_t* previous = sums.data() + bin1 * nofBins;
+         uint32_t*       current  = sums.data() + (bin1 + 1) * nofBins;
+         for(size_t bin2 = 0; bin2 < nofBins; ++bin2) {
+            uint64_t sum = previous[bin2] + row[bin2];
+            if(sum > std::numeric_limits<uint32_t>::max()) {
+               fPrefixSums.clear();
+               throw std::runtime_error("Too many counts for the 32 bit prefix sums of TAngularCorrelationAccumulator!");
+            }
+            current[bin2] = static_cast<uint32_t>(sum);
+         }
+      }
+   }
+}
+
+std::vector<uint64_t> TAngularCorrelationAccumulator::Project(int index, double min, double max) const
+{
+   /// The gate includes all bins from the one containing min to the one containing max, limited to the range of the
+   /// matrices. Like TAxis::SetRangeUser(min, max) a bin whose upper edge is min or whose lower edge is max is excluded,
+   /// so the gate selects the same bins as SetRangeUser on the exported histograms.
+   std::vector<uint64_t> result(fNofBins, 0);
+   if(index < 0 || index >= fNofIndices || max < fLow || min >= fHigh) {
+      return result;
+   }
+   double  width = (fHigh - fLow) / fNofBins;
+   int32_t first = min < fLow ? 0 : Bin(min);
+   int32_t last  = max >= fHigh ? fNofBins - 1 : Bin(max);
+   if(fLow + (first + 1) * width <= min) {
+      ++first;
+   }
+   if(fLow + last * width >= max) {
+      --last;
+   }
+   if(last < first) {
+      return result;
+   }
+
+   if(!fPrefixSums.empty()) {
+      const uint32_t* low  = fPrefixSums[index].data() + static_cast<size_t>(first) * fNofBins;
+      const uint32_t* high = fPrefixSums[index].data() + static_cast<size_t>(last + 1) * fNofBins;
+      for(int32_t bin = 0; bin < fNofBins; ++bin) {
+         result[bin] = high[bin] - low[bin];
+      }
+      return result;
+   }
+
+   for(int32_t gate = first; gate <= last; ++gate) {
+      for(int32_t bin = 0; bin < fNofBins; ++bin) {
+         result[bin] += Counts(index, gate, bin);
+      }
+   }
+   return result;
+}
+
+TH1D* TAngularCorrelationAccumulator::Projection(int index, double min, double max, const char* name) const
+{
+   auto  counts = Project(index, min, max);
+   auto* hist   = new TH1D(Form("%s%d_%i_%i", name, index, static_cast<Int_t>(min), static_cast<Int_t>(max)),
+                           Form("index %d, E_{#gamma 1}=[%.1f,%.1f)", index, min, max), fNofBins, fLow, fHigh);
+   for(int32_t bin = 0; bin < fNofBins; ++bin) {
+      if(counts[bin] > 0) {
+         hist->SetBinContent(bin + 1, static_cast<double>(counts[bin]));
+         hist->SetBinError(bin + 1, std::sqrt(static_cast<double>(counts[bin])));
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TH2D* TAngularCorrelationAccumulator::Matrix(int index, const char* baseName) const
+{
+   auto* hist = new TH2D(Form("%s%d", baseName, index), Form("#gamma-#gamma matrix of angular index %d", index), fNofBins, fLow, fHigh, fNofBins, fLow, fHigh);
+   for(int32_t bin1 = 0; bin1 < fNofBins; ++bin1) {
+      for(int32_t bin2 = bin1; bin2 < fNofBins; ++bin2) {
+         uint64_t counts = Counts(index, bin1, bin2);
+         if(counts == 0) {
+            continue;
+         }
+         hist->SetBinContent(bin1 + 1, bin2 + 1, static_cast<double>(counts));
+         hist->SetBinContent(bin2 + 1, bin1 + 1, static_cast<double>(counts));
+      }
+   }
+   hist->ResetStats();
+   return hist;
+}
+
+TObjArray* TAngularCorrelationAccumulator::Matrices(const char* baseName) const
+{
+   auto* array = new TObjArray(fNofIndices);
+   array->SetOwner(true);
+   for(int index = 0; index < fNofIndices; ++index) {
+      array->Add(Matrix(index, baseName));
+   }
+   return array;
+}
+
+THnSparse* TAngularCorrelationAccumulator::Sparse(const char* name) const
+{
+   std::array<Int_t, 3>    bins = {fNofIndices, fNofBins, fNofBins};
+   std::array<Double_t, 3> xmin = {0., fLow, fLow};
+   std::array<Double_t, 3> xmax = {static_cast<Double_t>(fNofIndices), fHigh, fHigh};
+   auto*                   hist = new THnSparseF(name, "angular index vs. #gamma-#gamma", 3, bins.data(), xmin.data(), xmax.data());
+   std::array<Int_t, 3>    cell{};
+   for(int index = 0; index < fNofIndices; ++index) {
+      cell[0] = index + 1;
+      for(int32_t bin1 = 0; bin1 < fNofBins; ++bin1) {
+         for(int32_t bin2 = bin1; bin2 < fNofBins; ++bin2) {
+            uint64_t counts = Counts(index, bin1, bin2);
+            if(counts == 0) {
+               continue;
+            }
+            cell[1] = bin1 + 1;
+            cell[2] = bin2 + 1;
+            hist->SetBinContent(cell.data(), static_cast<Double_t>(counts));
+            cell[1] = bin2 + 1;
+            cell[2] = bin1 + 1;
+            hist->SetBinContent(cell.data(), static_cast<Double_t>(counts));
+         }
+      }
+   }
+   return hist;
+}
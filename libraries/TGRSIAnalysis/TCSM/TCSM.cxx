@@ -1,4 +1,7 @@
 #include "TCSM.h"
+
+#include <memory>
+
 #include "TMath.h"
 
 constexpr bool RecoverHits = true;
@@ -13,13 +16,13 @@ TCSM::TCSM()
 
 void TCSM::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel* chan)
 {
-   /// This function just stores the fragments and mnemonics in vectors, separated by detector number and type
+   /// This function just stores the strips (energy, charge, cfd, time, and position) in vectors, separated by detector number and type
    /// (horizontal/vertical strip or pad).
    /// The hits themselves are built in the BuildHits function because the way we build them depends on the number of
    /// hits.
 
    // first index: detector number, second index: 0 = deltaE, 1 = E; third index: 0 = horizontal, 1 = vertical; fourth
-   // index: fragments
+   // index: strips
    int type = -1;
    if(chan->GetMnemonic()->ArraySubPositionString().compare(0, 1, "D") == 0) {
       type = 0;
@@ -39,14 +42,23 @@ void TCSM::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel* c
       return;
    }
 
-   // if this is the first time we got this detector number we make a new vector (of a vector) of fragments
-   if(fFragments.find(chan->GetMnemonic()->ArrayPosition()) == fFragments.end()) {
-      fFragments[chan->GetMnemonic()->ArrayPosition()].resize(
-         2, std::vector<std::vector<std::pair<TFragment, TGRSIMnemonic>>>(2));
+   // if this is the first time we got this detector number we make a new vector (of a vector) of strips
+   const auto* mnemonic = static_cast<const TGRSIMnemonic*>(chan->GetMnemonic());
+   auto&       detector = fStrips[mnemonic->ArrayPosition()];
+   if(detector.empty()) {
+      detector.resize(2, std::vector<std::vector<TCSMStrip>>(2));
    }
 
-   fFragments[chan->GetMnemonic()->ArrayPosition()][type][orientation].push_back(
-      std::make_pair(*frag, *static_cast<const TGRSIMnemonic*>(chan->GetMnemonic())));
+   // only copy what we need to build the hits instead of the whole fragment and mnemonic
+   TCSMStrip strip;
+   strip.fEnergy    = frag->GetEnergy();
+   strip.fCharge    = frag->GetCharge();
+   strip.fCfd       = frag->GetCfd();
+   strip.fTimeStamp = frag->GetTimeStamp();
+   strip.fDetector  = mnemonic->ArrayPosition();
+   strip.fPosition  = mnemonic->ArraySubPositionString()[0];
+   strip.fSegment   = mnemonic->Segment();
+   detector[type][orientation].push_back(strip);
 }
 
 void TCSM::BuildHits()
@@ -57,10 +69,10 @@ void TCSM::BuildHits()
 
    // first index: detector number, second index: 0 = deltaE, 1 = E; third index: 0 = horizontal, 1 = vertical
    // loop over all found detectors
-   for(auto& fFragment : fFragments) {
+   for(auto& detector : fStrips) {
       // loop over all types (only detectors 1/2 should have both D and E, detectors 3/4 should only have D)
-      for(size_t i = 0; i < fFragment.second.size(); ++i) {
-         BuildVH(fFragment.second.at(i), hits[i]);
+      for(size_t i = 0; i < detector.second.size(); ++i) {
+         BuildVH(detector.second.at(i), hits[i]);
       }
    }
    BuilddEE(hits, Hits());
@@ -121,118 +133,113 @@ TVector3 TCSM::GetPosition(int detector, char pos, int horizontalstrip, int vert
    return Pos;
 }
 
-void TCSM::BuildVH(std::vector<std::vector<std::pair<TFragment, TGRSIMnemonic>>>& strips, std::vector<TDetectorHit*>& hitVector)
+void TCSM::BuildVH(std::vector<std::vector<TCSMStrip>>& strips, std::vector<TDetectorHit*>& hitVector)
 {
-   /// Build hits from horizontal (index = 0) and vertical (index = 1) strips into the hitVector
-   if(strips[0].empty() && strips[1].empty()) {
+   /// Build hits from horizontal (index = 0) and vertical (index = 1) strips into the hitVector.
+   /// A single strip on each side is always combined. Otherwise the strips are matched by their energies using
+   /// TStripMatcher (optimal assignment, optionally with sum hits of two strips), and all strips that couldn't be
+   /// matched are passed to RecoverHit.
+   auto& horizontal = strips[0];
+   auto& vertical   = strips[1];
+   if(horizontal.empty() && vertical.empty()) {
       return;
    }
-   if(strips[0].size() == 1 && strips[1].empty()) {
-      RecoverHit('H', strips[0][0], hitVector);
-   } else if(strips[0].empty() && strips[1].size() == 1) {
-      RecoverHit('V', strips[1][0], hitVector);
-   } else if(strips[0].size() == 1 && strips[1].size() == 1) {
-      hitVector.push_back(MakeHit(strips[0][0], strips[1][0]));
-   } else if(strips[1].size() == 1 && strips[0].size() == 2) {
-      auto he1 = static_cast<int>(strips[0][0].first.GetEnergy());
-      auto he2 = static_cast<int>(strips[0][1].first.GetEnergy());
-      auto ve1 = static_cast<int>(strips[1][0].first.GetEnergy());
-      if(AlmostEqual(ve1, he1 + he2) && SumHits) {
-         hitVector.push_back(MakeHit(strips[0], strips[1]));
-      } else if(AlmostEqual(ve1, he1)) {
-         hitVector.push_back(MakeHit(strips[0][0], strips[1][0]));
-         RecoverHit('H', strips[0][1], hitVector);
-      } else if(AlmostEqual(ve1, he2)) {
-         hitVector.push_back(MakeHit(strips[0][1], strips[1][0]));
-         RecoverHit('H', strips[0][0], hitVector);
+   if(horizontal.size() == 1 && vertical.size() == 1) {
+      hitVector.push_back(MakeHit(horizontal[0], vertical[0]));
+      return;
+   }
+
+   thread_local TStripMatcher       matcher;
+   thread_local std::vector<double> horizontalEnergy;
+   thread_local std::vector<double> verticalEnergy;
+   horizontalEnergy.clear();
+   verticalEnergy.clear();
+   for(const auto& strip : horizontal) {
+      horizontalEnergy.push_back(strip.fEnergy);
+   }
+   for(const auto& strip : vertical) {
+      verticalEnergy.push_back(strip.fEnergy);
+   }
+
+   matcher.Window(fAlmostEqualWindow);
+   matcher.SumHits(SumHits);
+   matcher.Match(horizontal.size(), horizontalEnergy.data(), vertical.size(), verticalEnergy.data());
+
+   for(const auto& match : matcher.Matches()) {
+      if(match.fFront[1] < 0 && match.fBack[1] < 0) {
+         hitVector.push_back(MakeHit(horizontal[match.fFront[0]], vertical[match.fBack[0]]));
+         continue;
       }
-   } else if(strips[1].size() == 2 && strips[0].size() == 1) {
-      auto he1 = static_cast<int>(strips[0][0].first.GetEnergy());
-      auto ve1 = static_cast<int>(strips[1][0].first.GetEnergy());
-      auto ve2 = static_cast<int>(strips[1][1].first.GetEnergy());
-      if(AlmostEqual(ve1 + ve2, he1) && SumHits) {
-         hitVector.push_back(MakeHit(strips[0], strips[1]));
-      } else if(AlmostEqual(ve1, he1)) {
-         hitVector.push_back(MakeHit(strips[0][0], strips[1][0]));
-         RecoverHit('V', strips[1][1], hitVector);
-      } else if(AlmostEqual(ve2, he1)) {
-         hitVector.push_back(MakeHit(strips[0][0], strips[1][1]));
-         RecoverHit('V', strips[1][0], hitVector);
+      std::vector<const TCSMStrip*> h;
+      std::vector<const TCSMStrip*> v;
+      for(auto index : match.fFront) {
+         if(index >= 0) {
+            h.push_back(&horizontal[index]);
+         }
       }
-   } else if(strips[1].size() == 2 && strips[0].size() == 2) {
-      auto he1 = static_cast<int>(strips[0][0].first.GetEnergy());
-      auto he2 = static_cast<int>(strips[0][1].first.GetEnergy());
-      auto ve1 = static_cast<int>(strips[1][0].first.GetEnergy());
-      auto ve2 = static_cast<int>(strips[1][1].first.GetEnergy());
-      if((AlmostEqual(ve1, he1) && AlmostEqual(ve2, he2)) || (AlmostEqual(ve1, he2) && AlmostEqual(ve2, he1))) {
-         // I can build both 1,1 and 2,2 or 1,2 and 2,1
-         if(std::abs(ve1 - he1) + std::abs(ve2 - he2) <= std::abs(ve1 - he2) + std::abs(ve2 - he1)) {
-            // 1,1 and 2,2 mimimizes difference
-            hitVector.push_back(MakeHit(strips[0][0], strips[1][0]));
-            hitVector.push_back(MakeHit(strips[0][1], strips[1][1]));
-         } else if(std::abs(ve1 - he1) + std::abs(ve2 - he2) > std::abs(ve1 - he2) + std::abs(ve2 - he1)) {
-            // 1,2 and 2,1 mimimizes difference
-            hitVector.push_back(MakeHit(strips[0][0], strips[1][1]));
-            hitVector.push_back(MakeHit(strips[0][1], strips[1][0]));
+      for(auto index : match.fBack) {
+         if(index >= 0) {
+            v.push_back(&vertical[index]);
          }
-      } else if(AlmostEqual(ve1, he1)) {
-         hitVector.push_back(MakeHit(strips[0][0], strips[1][0]));
-      } else if(AlmostEqual(ve2, he1)) {
-         hitVector.push_back(MakeHit(strips[0][1], strips[1][0]));
-      } else if(AlmostEqual(ve1, he2)) {
-         hitVector.push_back(MakeHit(strips[0][0], strips[1][1]));
-      } else if(AlmostEqual(ve2, he2)) {
-         hitVector.push_back(MakeHit(strips[0][1], strips[1][1]));
+      }
+      hitVector.push_back(MakeHit(h, v));
+   }
+
+   for(size_t i = 0; i < horizontal.size(); ++i) {
+      if(!matcher.FrontUsed(i)) {
+         RecoverHit('H', horizontal[i], hitVector);
+      }
+   }
+   for(size_t i = 0; i < vertical.size(); ++i) {
+      if(!matcher.BackUsed(i)) {
+         RecoverHit('V', vertical[i], hitVector);
       }
    }
 }
 
-TCSMHit* TCSM::MakeHit(std::pair<TFragment, TGRSIMnemonic>& h, std::pair<TFragment, TGRSIMnemonic>& v)
+TCSMHit* TCSM::MakeHit(const TCSMStrip& h, const TCSMStrip& v)
 {
    auto* csmHit = new TCSMHit;
 
-   if(h.second.ArrayPosition() != v.second.ArrayPosition()) {
+   if(h.fDetector != v.fDetector) {
       std::cerr << "\tSomething is wrong, Horizontal and Vertical detector numbers don't match." << std::endl;
    }
-   if(h.second.ArraySubPositionString().c_str()[0] != v.second.ArraySubPositionString().c_str()[0]) {
+   if(h.fPosition != v.fPosition) {
       std::cerr << "\tSomething is wrong, Horizontal and Vertical positions don't match." << std::endl;
    }
 
-   if(h.second.ArraySubPositionString()[0] == 'D') {
-      csmHit->SetDetectorNumber(h.second.ArrayPosition());
-      csmHit->SetDHorizontalCharge(h.first.GetCharge());
-      csmHit->SetDVerticalCharge(v.first.GetCharge());
-      csmHit->SetDHorizontalStrip(h.second.Segment());
-      csmHit->SetDVerticalStrip(v.second.Segment());
-      csmHit->SetDHorizontalCFD(static_cast<int>(h.first.GetCfd()));
-      csmHit->SetDVerticalCFD(static_cast<int>(v.first.GetCfd()));
-      csmHit->SetDHorizontalTime(h.first.GetTimeStamp());
-      csmHit->SetDVerticalTime(v.first.GetTimeStamp());
-      csmHit->SetDHorizontalEnergy(h.first.GetEnergy());
-      csmHit->SetDVerticalEnergy(v.first.GetEnergy());
-      csmHit->SetDPosition(TCSM::GetPosition(h.second.ArrayPosition(), h.second.ArraySubPositionString()[0],
-                                             h.second.Segment(), v.second.Segment()));
-   } else if(h.second.ArraySubPositionString().c_str()[0] == 'E') {
-      csmHit->SetDetectorNumber(h.second.ArrayPosition());
-      csmHit->SetEHorizontalCharge(h.first.GetCharge());
-      csmHit->SetEVerticalCharge(v.first.GetCharge());
-      csmHit->SetEHorizontalStrip(h.second.Segment());
-      csmHit->SetEVerticalStrip(v.second.Segment());
-      csmHit->SetEHorizontalCFD(static_cast<int>(h.first.GetCfd()));
-      csmHit->SetEVerticalCFD(static_cast<int>(v.first.GetCfd()));
-      csmHit->SetEHorizontalTime(h.first.GetTimeStamp());
-      csmHit->SetEVerticalTime(v.first.GetTimeStamp());
-      csmHit->SetEHorizontalEnergy(h.first.GetEnergy());
-      csmHit->SetEVerticalEnergy(v.first.GetEnergy());
-      csmHit->SetEPosition(TCSM::GetPosition(h.second.ArrayPosition(), h.second.ArraySubPositionString()[0],
-                                             h.second.Segment(), v.second.Segment()));
+   if(h.fPosition == 'D') {
+      csmHit->SetDetectorNumber(h.fDetector);
+      csmHit->SetDHorizontalCharge(h.fCharge);
+      csmHit->SetDVerticalCharge(v.fCharge);
+      csmHit->SetDHorizontalStrip(h.fSegment);
+      csmHit->SetDVerticalStrip(v.fSegment);
+      csmHit->SetDHorizontalCFD(static_cast<int>(h.fCfd));
+      csmHit->SetDVerticalCFD(static_cast<int>(v.fCfd));
+      csmHit->SetDHorizontalTime(h.fTimeStamp);
+      csmHit->SetDVerticalTime(v.fTimeStamp);
+      csmHit->SetDHorizontalEnergy(h.fEnergy);
+      csmHit->SetDVerticalEnergy(v.fEnergy);
+      csmHit->SetDPosition(TCSM::GetPosition(h.fDetector, h.fPosition, h.fSegment, v.fSegment));
+   } else if(h.fPosition == 'E') {
+      csmHit->SetDetectorNumber(h.fDetector);
+      csmHit->SetEHorizontalCharge(h.fCharge);
+      csmHit->SetEVerticalCharge(v.fCharge);
+      csmHit->SetEHorizontalStrip(h.fSegment);
+      csmHit->SetEVerticalStrip(v.fSegment);
+      csmHit->SetEHorizontalCFD(static_cast<int>(h.fCfd));
+      csmHit->SetEVerticalCFD(static_cast<int>(v.fCfd));
+      csmHit->SetEHorizontalTime(h.fTimeStamp);
+      csmHit->SetEVerticalTime(v.fTimeStamp);
+      csmHit->SetEHorizontalEnergy(h.fEnergy);
+      csmHit->SetEVerticalEnergy(v.fEnergy);
+      csmHit->SetEPosition(TCSM::GetPosition(h.fDetector, h.fPosition, h.fSegment, v.fSegment));
    }
 
    return csmHit;
 }
 
-TCSMHit* TCSM::MakeHit(std::vector<std::pair<TFragment, TGRSIMnemonic>>& hhV,
-                       std::vector<std::pair<TFragment, TGRSIMnemonic>>& vvV)
+TCSMHit* TCSM::MakeHit(const std::vector<const TCSMStrip*>& hhV, const std::vector<const TCSMStrip*>& vvV)
 {
    auto* csmHit = new TCSMHit;
 
@@ -241,58 +248,58 @@ TCSMHit* TCSM::MakeHit(std::vector<std::pair<TFragment, TGRSIMnemonic>>& hhV,
    }
 
    //-------------------- horizontal strips
-   int    DetNumH  = hhV[0].second.ArrayPosition();
-   char   DetPosH  = hhV[0].second.ArraySubPositionString()[0];
-   int    ChargeH  = static_cast<int>(hhV[0].first.GetCharge());
-   double EnergyH  = hhV[0].first.GetEnergy();
+   int    DetNumH  = hhV[0]->fDetector;
+   char   DetPosH  = hhV[0]->fPosition;
+   int    ChargeH  = static_cast<int>(hhV[0]->fCharge);
+   double EnergyH  = hhV[0]->fEnergy;
    int    biggestH = 0;
 
    // get accumulative charge/energy and find the strip with the highest charge (why not energy?)
    for(size_t i = 1; i < hhV.size(); ++i) {
-      if(hhV[i].first.GetCharge() > hhV[biggestH].first.GetCharge()) {
+      if(hhV[i]->fCharge > hhV[biggestH]->fCharge) {
          biggestH = i;
       }
 
-      if(hhV[i].second.ArrayPosition() != DetNumH) {
+      if(hhV[i]->fDetector != DetNumH) {
          std::cerr << "\tSomething is wrong, Horizontal detector numbers don't match in vector loop." << std::endl;
       }
-      if(hhV[i].second.ArraySubPositionString()[0] != DetPosH) {
+      if(hhV[i]->fPosition != DetPosH) {
          std::cerr << "\tSomething is wrong, Horizontal detector positions don't match in vector loop." << std::endl;
       }
-      ChargeH += static_cast<int>(hhV[i].first.GetCharge());
-      EnergyH += hhV[i].first.GetEnergy();
+      ChargeH += static_cast<int>(hhV[i]->fCharge);
+      EnergyH += hhV[i]->fEnergy;
    }
 
-   int  StripH  = hhV[biggestH].second.Segment();
-   auto ConFraH = static_cast<int>(hhV[biggestH].first.GetCfd());
-   auto TimeH   = static_cast<double>(hhV[biggestH].first.GetTimeStamp());
+   int  StripH  = hhV[biggestH]->fSegment;
+   auto ConFraH = static_cast<int>(hhV[biggestH]->fCfd);
+   auto TimeH   = static_cast<double>(hhV[biggestH]->fTimeStamp);
 
    //-------------------- vertical strips
-   int    DetNumV  = vvV[0].second.ArrayPosition();
-   char   DetPosV  = vvV[0].second.ArraySubPositionString()[0];
-   auto   ChargeV  = static_cast<int>(vvV[0].first.GetCharge());
-   double EnergyV  = vvV[0].first.GetEnergy();
+   int    DetNumV  = vvV[0]->fDetector;
+   char   DetPosV  = vvV[0]->fPosition;
+   auto   ChargeV  = static_cast<int>(vvV[0]->fCharge);
+   double EnergyV  = vvV[0]->fEnergy;
    int    biggestV = 0;
 
    // get accumulative charge/energy and find the strip with the highest charge (why not energy?)
    for(size_t i = 1; i < vvV.size(); ++i) {
-      if(vvV[i].first.GetCharge() > vvV[biggestV].first.GetCharge()) {
+      if(vvV[i]->fCharge > vvV[biggestV]->fCharge) {
          biggestV = i;
       }
 
-      if(vvV[i].second.ArrayPosition() != DetNumV) {
+      if(vvV[i]->fDetector != DetNumV) {
          std::cerr << "\tSomething is wrong, Vertical detector numbers don't match in vector loop." << std::endl;
       }
-      if(vvV[i].second.ArraySubPositionString()[0] != DetPosV) {
+      if(vvV[i]->fPosition != DetPosV) {
          std::cerr << "\tSomething is wrong, Vertical detector positions don't match in vector loop." << std::endl;
       }
-      ChargeV += static_cast<int>(vvV[i].first.GetCharge());
-      EnergyV += vvV[i].first.GetEnergy();
+      ChargeV += static_cast<int>(vvV[i]->fCharge);
+      EnergyV += vvV[i]->fEnergy;
    }
 
-   int  StripV  = vvV[biggestV].second.Segment();
-   auto ConFraV = static_cast<int>(vvV[biggestV].first.GetCfd());
-   auto TimeV   = static_cast<double>(vvV[biggestV].first.GetTimeStamp());
+   int  StripV  = vvV[biggestV]->fSegment;
+   auto ConFraV = static_cast<int>(vvV[biggestV]->fCfd);
+   auto TimeV   = static_cast<double>(vvV[biggestV]->fTimeStamp);
 
    if(DetNumH != DetNumV) {
       std::cerr << "\tSomething is wrong, Horizontal and Vertical detector numbers don't match in vector." << std::endl;
@@ -435,7 +442,9 @@ void TCSM::MakedEE(std::vector<TDetectorHit*>& DHitVec, std::vector<TDetectorHit
          // BuiltHits.back().Print();
       }
    } else {
-      std::cout << "D Size: " << DHitVec.size() << " E Size: " << EHitVec.size() << std::endl;
+      // higher multiplicities (which BuildVH can create now) are passed through without combining them
+      BuiltHits.insert(BuiltHits.end(), DHitVec.begin(), DHitVec.end());
+      BuiltHits.insert(BuiltHits.end(), EHitVec.begin(), EHitVec.end());
    }
 }
 
@@ -511,33 +520,33 @@ void TCSM::OldBuilddEE(std::vector<TDetectorHit*>& DHitVec, std::vector<TDetecto
    }
 }
 
-void TCSM::RecoverHit(char orientation, std::pair<TFragment, TGRSIMnemonic>& hit, std::vector<TDetectorHit*>& hits)
+void TCSM::RecoverHit(char orientation, const TCSMStrip& hit, std::vector<TDetectorHit*>& hits)
 {
    if(!RecoverHits) {
       return;
    }
 
-   auto* csmHit = new TCSMHit;
+   auto csmHit = std::make_unique<TCSMHit>();
 
-   int  detno = hit.second.ArrayPosition();
-   char pos   = hit.second.ArraySubPositionString()[0];
+   int  detno = hit.fDetector;
+   char pos   = hit.fPosition;
 
    switch(detno) {
-   case 1: return;
+   case 1: break;
    case 2:
       if(pos == 'D' && orientation == 'V') {   // Recover 2DN09, channel 1040
          csmHit->SetDetectorNumber(detno);
-         csmHit->SetDHorizontalCharge(hit.first.GetCharge());
-         csmHit->SetDVerticalCharge(hit.first.GetCharge());
+         csmHit->SetDHorizontalCharge(hit.fCharge);
+         csmHit->SetDVerticalCharge(hit.fCharge);
          csmHit->SetDHorizontalStrip(9);
-         csmHit->SetDVerticalStrip(hit.second.Segment());
-         csmHit->SetDHorizontalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDVerticalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDHorizontalTime(hit.first.GetTimeStamp());
-         csmHit->SetDVerticalTime(hit.first.GetTimeStamp());
-         csmHit->SetDHorizontalEnergy(hit.first.GetEnergy());
-         csmHit->SetDVerticalEnergy(hit.first.GetEnergy());
-         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, 9, hit.second.Segment()));
+         csmHit->SetDVerticalStrip(hit.fSegment);
+         csmHit->SetDHorizontalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDVerticalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDHorizontalTime(hit.fTimeStamp);
+         csmHit->SetDVerticalTime(hit.fTimeStamp);
+         csmHit->SetDHorizontalEnergy(hit.fEnergy);
+         csmHit->SetDVerticalEnergy(hit.fEnergy);
+         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, 9, hit.fSegment));
       }
       break;
    case 3:
@@ -547,17 +556,17 @@ void TCSM::RecoverHit(char orientation, std::pair<TFragment, TGRSIMnemonic>& hit
          return;
       } else if(orientation == 'H') {   // Recover 3DP11, channel 1145
          csmHit->SetDetectorNumber(detno);
-         csmHit->SetDHorizontalCharge(hit.first.GetCharge());
-         csmHit->SetDVerticalCharge(hit.first.GetCharge());
-         csmHit->SetDHorizontalStrip(hit.second.Segment());
+         csmHit->SetDHorizontalCharge(hit.fCharge);
+         csmHit->SetDVerticalCharge(hit.fCharge);
+         csmHit->SetDHorizontalStrip(hit.fSegment);
          csmHit->SetDVerticalStrip(11);
-         csmHit->SetDHorizontalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDVerticalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDHorizontalTime(hit.first.GetTimeStamp());
-         csmHit->SetDVerticalTime(hit.first.GetTimeStamp());
-         csmHit->SetDHorizontalEnergy(hit.first.GetEnergy());
-         csmHit->SetDVerticalEnergy(hit.first.GetEnergy());
-         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, hit.second.Segment(), 11));
+         csmHit->SetDHorizontalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDVerticalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDHorizontalTime(hit.fTimeStamp);
+         csmHit->SetDVerticalTime(hit.fTimeStamp);
+         csmHit->SetDHorizontalEnergy(hit.fEnergy);
+         csmHit->SetDVerticalEnergy(hit.fEnergy);
+         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, hit.fSegment, 11));
       }
       break;
    case 4:
@@ -566,17 +575,17 @@ void TCSM::RecoverHit(char orientation, std::pair<TFragment, TGRSIMnemonic>& hit
          return;
       } else if(orientation == 'H') {   // Recover 4DP15, channel 1181
          csmHit->SetDetectorNumber(detno);
-         csmHit->SetDHorizontalCharge(hit.first.GetCharge());
-         csmHit->SetDVerticalCharge(hit.first.GetCharge());
-         csmHit->SetDHorizontalStrip(hit.second.Segment());
+         csmHit->SetDHorizontalCharge(hit.fCharge);
+         csmHit->SetDVerticalCharge(hit.fCharge);
+         csmHit->SetDHorizontalStrip(hit.fSegment);
          csmHit->SetDVerticalStrip(15);
-         csmHit->SetDHorizontalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDVerticalCFD(static_cast<int>(hit.first.GetCfd()));
-         csmHit->SetDHorizontalTime(hit.first.GetTimeStamp());
-         csmHit->SetDVerticalTime(hit.first.GetTimeStamp());
-         csmHit->SetDHorizontalEnergy(hit.first.GetEnergy());
-         csmHit->SetDVerticalEnergy(hit.first.GetEnergy());
-         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, hit.second.Segment(), 15));
+         csmHit->SetDHorizontalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDVerticalCFD(static_cast<int>(hit.fCfd));
+         csmHit->SetDHorizontalTime(hit.fTimeStamp);
+         csmHit->SetDVerticalTime(hit.fTimeStamp);
+         csmHit->SetDHorizontalEnergy(hit.fEnergy);
+         csmHit->SetDVerticalEnergy(hit.fEnergy);
+         csmHit->SetDPosition(TCSM::GetPosition(detno, pos, hit.fSegment, 15));
       }
       break;
    default:
@@ -585,7 +594,7 @@ void TCSM::RecoverHit(char orientation, std::pair<TFragment, TGRSIMnemonic>& hit
    }
 
    if(!csmHit->IsEmpty()) {
-      hits.push_back(csmHit);
+      hits.push_back(csmHit.release());
    }
 }
 
@@ -1,4 +1,5 @@
 #include "TDescantHit.h"
+#include "TWaveformKernels.h"
 
 #include <iostream>
 #include <algorithm>
@@ -6,6 +7,7 @@
 
 #include "TDescant.h"
 #include "TGRSIOptions.h"
+#include "TCounterRandom.h"
 
 TDescantHit::TDescantHit()
 {
@@ -82,7 +84,7 @@ Float_t TDescantHit::GetCfd() const
 {
    /// special function for TDescantHit to return CFD after mapping out the high bits
    /// which are the remainder between the 125 MHz data and the 100 MHz timestamp clock
-   return static_cast<Float_t>(static_cast<Int_t>(TDetectorHit::GetCfd()) & 0x3fffff) + static_cast<Float_t>(gRandom->Uniform());
+   return static_cast<Float_t>(static_cast<Int_t>(TDetectorHit::GetCfd()) & 0x3fffff) + static_cast<Float_t>(TCounterRandom(GetTimeStamp(), GetAddress(), TCounterRandom::EStream::kCfd).Uniform());
 }
 
 Int_t TDescantHit::GetRemainder() const
@@ -120,12 +122,9 @@ void TDescantHit::Print(std::ostream& out) const
 bool TDescantHit::AnalyzeWaveform()
 {
    bool error = false;
-
    if(!HasWave()) {
       return false;   // Error!
    }
-   std::vector<Int_t>   baselineCorrections(8, 0);
-   std::vector<Short_t> newWaveform;
 
    // all timing algorithms use interpolation with this many steps between two samples (all times are stored as
    // integers)
@@ -135,17 +134,9 @@ bool TDescantHit::AnalyzeWaveform()
    int          halfSmoothingWindow = 0;   // 2*halfsmoothingwindow + 1 = number of samples in moving window.
 
    // baseline algorithm: correct each adc with average of first two samples in that adc
-   for(size_t i = 0; i < 8 && i < WaveSize(); ++i) {
-      baselineCorrections[i] = GetWaveform()->at(i);
-   }
-   for(size_t i = 8; i < 16 && i < WaveSize(); ++i) {
-      baselineCorrections[i - 8] =
-         ((baselineCorrections[i - 8] + GetWaveform()->at(i)) + ((baselineCorrections[i - 8] + GetWaveform()->at(i)) > 0 ? 1 : -1)) >>
-         1;   // Average
-   }
-   for(size_t i = 0; i < WaveSize(); ++i) {
-      newWaveform[i] -= baselineCorrections[i % 8];
-   }
+   thread_local std::vector<Short_t> newWaveform;
+   newWaveform.resize(WaveSize());
+   TWaveformKernels::BaselineCorrect(GetWaveform()->data(), WaveSize(), newWaveform.data());
    SetWaveform(newWaveform);
 
    SetCfd(CalculateCfd(attenuation, delay, halfSmoothingWindow, interpolationSteps));
@@ -154,73 +145,47 @@ bool TDescantHit::AnalyzeWaveform()
    // time to zero-crossing algorithm: time when sum reaches n% of the total sum minus the cfd time
    double fraction = 0.90;
 
-   SetPsd(CalculatePsd(fraction, interpolationSteps));
+   thread_local std::vector<Int_t> partialSums;
+   SetPsd(CalculatePsdAndPartialSums(fraction, interpolationSteps, partialSums));
 
-   SetCharge(CalculatePartialSum().back());
+   if(!partialSums.empty()) {
+      SetCharge(partialSums.back());
+   }
 
    if(fPsd < 0) {
       error = true;
    }
 
-   return !(error);
+   return !error;
 }
 
-Int_t TDescantHit::CalculateCfd(double attenuation, unsigned int delay, int halfsmoothingwindow,
-                                unsigned int interpolation_steps)
+Int_t TDescantHit::CalculateCfd(double attenuation, unsigned int delay, int halfSmoothingWindow, unsigned int interpolationSteps)
 {
+   thread_local std::vector<Short_t> monitor;
 
-   std::vector<Short_t> monitor;
-
-   return CalculateCfdAndMonitor(attenuation, delay, halfsmoothingwindow, interpolation_steps, monitor);
+   return CalculateCfdAndMonitor(attenuation, delay, halfSmoothingWindow, interpolationSteps, monitor);
 }
 
-Int_t TDescantHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfSmoothingWindow,
-                                          unsigned int interpolationSteps, std::vector<Short_t>& monitor)
+Int_t TDescantHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfSmoothingWindow, unsigned int interpolationSteps, std::vector<Short_t>& monitor)
 {
-
-   Short_t monitormax = 0;
-   bool    armed      = false;
-
-   Int_t cfd = 0;
    if(!HasWave()) {
       return INT_MAX;   // Error!
    }
-   std::vector<Short_t> smoothedWaveform;
 
+   Int_t cfd = 0;
    if(WaveSize() > delay + 1) {
+      const Short_t* waveform = GetWaveform()->data();
+      size_t         size     = WaveSize();
       if(halfSmoothingWindow > 0) {
-         smoothedWaveform = TDescantHit::CalculateSmoothedWaveform(halfSmoothingWindow);
-      } else {
-         smoothedWaveform = *GetWaveform();
+         thread_local std::vector<Short_t> smoothedWaveform;
+         smoothedWaveform.resize(TWaveformKernels::SmoothedSize(size, halfSmoothingWindow));
+         size     = TWaveformKernels::Smooth(waveform, size, halfSmoothingWindow, smoothedWaveform.data());
+         waveform = smoothedWaveform.data();
       }
 
-      monitor.clear();
-      monitor.resize(smoothedWaveform.size() - delay);
-      monitor[0] = static_cast<Short_t>(attenuation * smoothedWaveform[delay] - smoothedWaveform[0]);
-      if(monitor[0] > monitormax) {
-         armed      = true;
-         monitormax = monitor[0];
-      }
-
-      for(size_t i = delay + 1; i < smoothedWaveform.size(); ++i) {
-         monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-         if(monitor[i - delay] > monitormax) {
-            armed      = true;
-            monitormax = monitor[i - delay];
-         } else {
-            if(armed && monitor[i - delay] < 0) {
-               armed = false;
-               if(monitor[i - delay - 1] - monitor[i - delay] != 0) {
-                  // Linear interpolation.
-                  cfd = (i - delay - 1) * interpolationSteps +
-                        (monitor[i - delay - 1] * interpolationSteps) / (monitor[i - delay - 1] - monitor[i - delay]);
-               } else {
-                  // Should be impossible, since monitor[i-delay-1] => 0 and monitor[i-delay] > 0
-                  cfd = 0;
-               }
-            }
-         }
-      }
+      monitor.resize(size > delay ? size - delay : 0);
+      TWaveformKernels::CfdMonitor(waveform, size, attenuation, delay, monitor.data());
+      cfd = TWaveformKernels::CfdZeroCrossing(monitor.data(), monitor.size(), interpolationSteps);
    } else {
       monitor.resize(0);
    }
@@ -238,29 +203,22 @@ Int_t TDescantHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay
 
 std::vector<Short_t> TDescantHit::CalculateSmoothedWaveform(unsigned int halfSmoothingWindow)
 {
-
    if(!HasWave()) {
       return {};   // Error!
    }
 
-   std::vector<Short_t> smoothedWaveform(std::max((static_cast<size_t>(0)), WaveSize() - 2 * halfSmoothingWindow),
-                                         0);
-
-   for(size_t i = halfSmoothingWindow; i < WaveSize() - halfSmoothingWindow; ++i) {
-      for(int j = -static_cast<int>(halfSmoothingWindow); j <= static_cast<int>(halfSmoothingWindow); ++j) {
-         smoothedWaveform[i - halfSmoothingWindow] += GetWaveform()->at(i + j);
-      }
-   }
+   std::vector<Short_t> smoothedWaveform(TWaveformKernels::SmoothedSize(WaveSize(), halfSmoothingWindow));
+   TWaveformKernels::Smooth(GetWaveform()->data(), WaveSize(), halfSmoothingWindow, smoothedWaveform.data());
 
    return smoothedWaveform;
 }
 
-std::vector<Short_t> TDescantHit::CalculateCfdMonitor(double attenuation, unsigned int delay,
-                                                      unsigned int halfSmoothingWindow)
+std::vector<Short_t> TDescantHit::CalculateCfdMonitor(double attenuation, unsigned int delay, unsigned int halfSmoothingWindow)
 {
    if(!HasWave()) {
       return {};   // Error!
    }
+
    std::vector<Short_t> smoothedWaveform;
 
    if(halfSmoothingWindow > 0) {
@@ -269,11 +227,8 @@ std::vector<Short_t> TDescantHit::CalculateCfdMonitor(double attenuation, unsign
       smoothedWaveform = *GetWaveform();
    }
 
-   std::vector<Short_t> monitor(std::max((static_cast<size_t>(0)), smoothedWaveform.size() - delay), 0);
-
-   for(size_t i = delay; i < WaveSize(); ++i) {
-      monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-   }
+   std::vector<Short_t> monitor(smoothedWaveform.size() > static_cast<size_t>(delay) ? smoothedWaveform.size() - delay : 0);
+   TWaveformKernels::CfdMonitor(smoothedWaveform.data(), smoothedWaveform.size(), attenuation, delay, monitor.data());
 
    return monitor;
 }
@@ -284,12 +239,8 @@ std::vector<Int_t> TDescantHit::CalculatePartialSum()
       return {};   // Error!
    }
 
-   std::vector<Int_t> partialSums(WaveSize(), 0);
-
-   partialSums[0] = GetWaveform()->at(0);
-   for(size_t i = 1; i < WaveSize(); ++i) {
-      partialSums[i] = partialSums[i - 1] + GetWaveform()->at(i);
-   }
+   std::vector<Int_t> partialSums(WaveSize());
+   TWaveformKernels::PartialSums(GetWaveform()->data(), WaveSize(), partialSums.data());
 
    if(TGRSIOptions::Get()->Debug()) {
       fPartialSum = partialSums;
@@ -300,31 +251,24 @@ std::vector<Int_t> TDescantHit::CalculatePartialSum()
 
 Int_t TDescantHit::CalculatePsd(double fraction, unsigned int interpolationSteps)
 {
-   std::vector<Int_t> partialSums;
+   thread_local std::vector<Int_t> partialSums;
 
    return CalculatePsdAndPartialSums(fraction, interpolationSteps, partialSums);
 }
 
-Int_t TDescantHit::CalculatePsdAndPartialSums(double fraction, unsigned int interpolationSteps,
-                                              std::vector<Int_t>& partialSums)
+Int_t TDescantHit::CalculatePsdAndPartialSums(double fraction, unsigned int interpolationSteps, std::vector<Int_t>& partialSums)
 {
-   Int_t psd = 0;
-
-   partialSums = CalculatePartialSum();
-   if(partialSums.empty()) {
+   fPsd = -1;
+   if(!HasWave()) {
+      partialSums.clear();
       return -1;
    }
-   int totalSum = partialSums.back();
 
-   fPsd = -1;
-   if(partialSums[0] < fraction * totalSum) {
-      for(size_t i = 1; i < partialSums.size(); ++i) {
-         if(partialSums[i] >= fraction * totalSum) {
-            psd = static_cast<Int_t>(static_cast<double>(i * interpolationSteps) - ((partialSums[i] - fraction * totalSum) * interpolationSteps) / GetWaveform()->at(i));
-            break;
-         }
-      }
+   partialSums.resize(WaveSize());
+   TWaveformKernels::PartialSums(GetWaveform()->data(), WaveSize(), partialSums.data());
+   if(TGRSIOptions::Get()->Debug()) {
+      fPartialSum = partialSums;
    }
 
-   return psd;
+   return TWaveformKernels::Psd(partialSums.data(), GetWaveform()->data(), WaveSize(), fraction, interpolationSteps);
 }
@@ -14,6 +14,6 @@
 #pragma link C++ class TGriffin + ;
 #pragma link C++ class TGriffinBgoHit + ;
 #pragma link C++ class TGriffinBgo + ;
-#pragma link C++ class TGriffinAngles + ;
+#pragma link C++ class TGriffinAngles - ;
 
 #endif
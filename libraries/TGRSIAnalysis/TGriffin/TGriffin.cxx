@@ -3,12 +3,18 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "TMath.h"
 #include "TInterpreter.h"
 #include "TMnemonic.h"
 
 #include "TGRSIOptions.h"
+#include "TBgo.h"
 
 ////////////////////////////////////////////////////////////
 //
@@ -125,21 +131,8 @@ void TGriffin::Copy(TObject& rhs) const
 
    // no need to copy hits, this is already taken care of by TDetector::Copy (called by TSuppressed::Copy)
    // not copying addback or suppressed vectors
-   for(auto& hit : static_cast<TGriffin&>(rhs).fAddbackHits) {
-      delete hit;
-   }
-   for(auto& hit : static_cast<TGriffin&>(rhs).fSuppressedHits) {
-      delete hit;
-   }
-   for(auto& hit : static_cast<TGriffin&>(rhs).fSuppressedAddbackHits) {
-      delete hit;
-   }
+   static_cast<TGriffin&>(rhs).ClearTransientHits();
    static_cast<TGriffin&>(rhs).fGriffinBits = 0;
-   static_cast<TGriffin&>(rhs).fAddbackHits.clear();
-   static_cast<TGriffin&>(rhs).fAddbackFrags.clear();
-   static_cast<TGriffin&>(rhs).fSuppressedHits.clear();
-   static_cast<TGriffin&>(rhs).fSuppressedAddbackHits.clear();
-   static_cast<TGriffin&>(rhs).fSuppressedAddbackFrags.clear();
 
    static_cast<TGriffin&>(rhs).fCycleStart = fCycleStart;
 }
@@ -148,15 +141,7 @@ TGriffin::~TGriffin()
 {
    // Default Destructor
    // no need to delete hits, this is taken care of by the destructor of TDetector
-   for(auto& hit : fAddbackHits) {
-      delete hit;
-   }
-   for(auto& hit : fSuppressedHits) {
-      delete hit;
-   }
-   for(auto& hit : fSuppressedAddbackHits) {
-      delete hit;
-   }
+   ClearTransientHits();
 }
 
 void TGriffin::Clear(Option_t* opt)
@@ -165,22 +150,32 @@ void TGriffin::Clear(Option_t* opt)
    ClearStatus();
    TSuppressed::Clear(opt);
    // hits cleared by TDetector::Clear
-   for(auto& hit : fAddbackHits) {
-      delete hit;
-   }
-   for(auto& hit : fSuppressedHits) {
-      delete hit;
-   }
-   for(auto& hit : fSuppressedAddbackHits) {
-      delete hit;
-   }
-   fAddbackHits.clear();
+   ClearTransientHits();
+
+   fCycleStart = 0;
+}
+
+void TGriffin::ClearTransientHits()
+{
+   /// Deletes the addback and suppressed hits, and releases all hits of the arena at once.
+   fHitArena.Release(fAddbackHits);
+   fHitArena.Release(fSuppressedHits);
+   fHitArena.Release(fSuppressedAddbackHits);
+   fHitArena.Reset();
    fAddbackFrags.clear();
-   fSuppressedHits.clear();
-   fSuppressedAddbackHits.clear();
    fSuppressedAddbackFrags.clear();
+}
 
-   fCycleStart = 0;
+void TGriffin::ResetArenaIfUnused()
+{
+   /// Destroys the hits of the arena if none of the transient vectors holds any of them anymore, so that resetting and
+   /// re-building the addback or suppressed hits within one event doesn't keep growing the arena.
+   auto usesArena = [this](const std::vector<TDetectorHit*>& hits) {
+      return std::any_of(hits.begin(), hits.end(), [this](const TDetectorHit* hit) { return fHitArena.Owns(hit); });
+   };
+   if(!usesArena(fAddbackHits) && !usesArena(fSuppressedHits) && !usesArena(fSuppressedAddbackHits)) {
+      fHitArena.Reset();
+   }
 }
 
 void TGriffin::Print(Option_t*) const
@@ -276,7 +271,11 @@ Short_t TGriffin::GetAddbackMultiplicity()
       ResetAddback();
    }
    if(fAddbackHits.empty()) {
-      CreateAddback(hitVector, fAddbackHits, fAddbackFrags);
+      if(UsingDefaultAddback()) {
+         CreateCloverAddback(nullptr, fAddbackHits, fAddbackFrags);
+      } else {
+         CreateAddback(hitVector, fAddbackHits, fAddbackFrags);
+      }
       SetAddback(true);
    }
 
@@ -326,11 +325,11 @@ void TGriffin::AddFragment(const std::shared_ptr<const TFragment>& frag, TChanne
    };
 }
 
-TVector3 TGriffin::GetPosition(int DetNbr, int CryNbr, double dist)
+TVector3 TGriffin::CalculatePosition(int DetNbr, int CryNbr, double dist)
 {
    // Gets the position vector for a crystal specified by CryNbr within Clover DetNbr at a distance of dist mm away.
    // This is calculated to the most likely interaction point within the crystal.
-   if(DetNbr > 16) {
+   if(DetNbr < 0 || DetNbr > 16) {
       return {0, 0, 1};
    }
 
@@ -358,6 +357,130 @@ TVector3 TGriffin::GetPosition(int DetNbr, int CryNbr, double dist)
    return (temp_pos + shift);
 }
 
+struct TGriffin::TPositionTable {
+   /// Positions and directions of all crystals at one distance (with crystal number 4 standing for any crystal number
+   /// other than 0 - 3, i.e. the front of the clover), and the opening angles between all 64 crystals.
+   explicit TPositionTable(double distance) : fDistance(distance), fDoppler(17 * 5 + 1)
+   {
+      for(int DetNbr = 0; DetNbr < 17; ++DetNbr) {
+         for(int CryNbr = 0; CryNbr < 5; ++CryNbr) {
+            fPositions[DetNbr * 5 + CryNbr]  = CalculatePosition(DetNbr, CryNbr, distance);
+            fDirections[DetNbr * 5 + CryNbr] = fPositions[DetNbr * 5 + CryNbr].Unit();
+            fDoppler.Set(DetNbr * 5 + CryNbr, fPositions[DetNbr * 5 + CryNbr]);
+         }
+      }
+      fDoppler.Set(17 * 5, TVector3(0, 0, 1));
+      for(int first = 0; first < 64; ++first) {
+         for(int second = 0; second < 64; ++second) {
+            const TVector3& firstPos        = fPositions[(first / 4 + 1) * 5 + first % 4];
+            const TVector3& secondPos       = fPositions[(second / 4 + 1) * 5 + second % 4];
+            fAngles[first * 64 + second]    = firstPos.Angle(secondPos);
+            fCosAngles[first * 64 + second] = std::cos(fAngles[first * 64 + second]);
+         }
+      }
+   }
+
+   static int Index(int DetNbr, int CryNbr) { return DetNbr * 5 + ((CryNbr >= 0 && CryNbr < 4) ? CryNbr : 4); }
+   /// Index of the crystal in the angle tables (0 - 63), or -1 if it isn't a valid crystal.
+   static int CrystalIndex(int DetNbr, int CryNbr) { return (DetNbr >= 1 && DetNbr <= 16 && CryNbr >= 0 && CryNbr < 4) ? (DetNbr - 1) * 4 + CryNbr : -1; }
+
+   double                       fDistance;
+   std::array<TVector3, 17 * 5> fPositions;
+   std::array<TVector3, 17 * 5> fDirections;
+   std::array<double, 64 * 64>  fAngles;
+   std::array<double, 64 * 64>  fCosAngles;
+   TDopplerTable                fDoppler;   ///< directions for GetDopplerEnergies, the last entry is used for invalid detectors
+};
+
+const TGriffin::TPositionTable& TGriffin::PositionTable(double dist)
+{
+   /// The tables for the standard distances of 110 and 145 mm are created on first use, tables for other distances are
+   /// created on demand and kept until the end of the program (there are usually only a few different distances in use).
+   static const TPositionTable forward(110.);
+   static const TPositionTable back(145.);
+   if(dist == 110.) {
+      return forward;
+   }
+   if(dist == 145.) {
+      return back;
+   }
+   thread_local const TPositionTable* last = nullptr;
+   if(last != nullptr && last->fDistance == dist) {
+      return *last;
+   }
+   static std::mutex                                        mutex;
+   static std::map<double, std::unique_ptr<TPositionTable>> tables;
+   std::lock_guard<std::mutex>                              lock(mutex);
+   auto&                                                    table = tables[dist];
+   if(table == nullptr) {
+      table = std::make_unique<TPositionTable>(dist);
+   }
+   last = table.get();
+   return *last;
+}
+
+TVector3 TGriffin::GetPosition(int DetNbr, int CryNbr, double dist)
+{
+   /// Gets the position vector for a crystal specified by CryNbr within Clover DetNbr at a distance of dist mm away.
+   /// This is calculated to the most likely interaction point within the crystal. Crystal numbers other than 0 - 3
+   /// give the position of the front of the clover.
+   if(DetNbr < 0 || DetNbr > 16) {
+      return {0, 0, 1};
+   }
+   return PositionTable(dist).fPositions[TPositionTable::Index(DetNbr, CryNbr)];
+}
+
+TVector3 TGriffin::GetDirection(int DetNbr, int CryNbr, double dist)
+{
+   if(DetNbr < 0 || DetNbr > 16) {
+      return {0, 0, 1};
+   }
+   return PositionTable(dist).fDirections[TPositionTable::Index(DetNbr, CryNbr)];
+}
+
+double TGriffin::GetCrystalAngle(int DetNbr1, int CryNbr1, int DetNbr2, int CryNbr2, double dist)
+{
+   /// Returns the opening angle (in radians) between the two crystals, from the angle table if both are valid crystals.
+   int first  = TPositionTable::CrystalIndex(DetNbr1, CryNbr1);
+   int second = TPositionTable::CrystalIndex(DetNbr2, CryNbr2);
+   if(first < 0 || second < 0) {
+      return GetPosition(DetNbr1, CryNbr1, dist).Angle(GetPosition(DetNbr2, CryNbr2, dist));
+   }
+   return PositionTable(dist).fAngles[first * 64 + second];
+}
+
+double TGriffin::GetCosCrystalAngle(int DetNbr1, int CryNbr1, int DetNbr2, int CryNbr2, double dist)
+{
+   int first  = TPositionTable::CrystalIndex(DetNbr1, CryNbr1);
+   int second = TPositionTable::CrystalIndex(DetNbr2, CryNbr2);
+   if(first < 0 || second < 0) {
+      return std::cos(GetPosition(DetNbr1, CryNbr1, dist).Angle(GetPosition(DetNbr2, CryNbr2, dist)));
+   }
+   return PositionTable(dist).fCosAngles[first * 64 + second];
+}
+
+const double* TGriffin::GetCosCrystalAngleTable(double dist)
+{
+   return PositionTable(dist).fCosAngles.data();
+}
+
+void TGriffin::GetDopplerEnergies(size_t n, const int* detector, const int* crystal, const double* energy, const TVector3& beta, double* corrected, double dist)
+{
+   /// Crystal numbers other than 0 - 3 use the same position as GetPosition (the front of the clover), as do detector
+   /// numbers outside of 0 - 16.
+   const TDopplerTable& table = PositionTable(dist).fDoppler;
+
+   std::array<int32_t, 256> index;
+   for(size_t first = 0; first < n; first += index.size()) {
+      size_t chunk = std::min(n - first, index.size());
+      for(size_t i = 0; i < chunk; ++i) {
+         int det  = detector[first + i];
+         index[i] = (det >= 0 && det < 17) ? TPositionTable::Index(det, crystal[first + i]) : 17 * 5;
+      }
+      table.Correct(chunk, index.data(), energy + first, beta, corrected + first);
+   }
+}
+
 TVector3 TGriffin::GetDetectorPosition(int DetNbr)
 {
    // Gets the position vector for a Clover DetNbr.
@@ -377,11 +500,9 @@ void TGriffin::ResetAddback()
 {
    SetAddback(false);
    SetCrossTalk(false);
-   for(auto& hit : fAddbackHits) {
-      delete hit;
-   }
-   fAddbackHits.clear();
+   fHitArena.Release(fAddbackHits);
    fAddbackFrags.clear();
+   ResetArenaIfUnused();
 }
 
 UShort_t TGriffin::GetNAddbackFrags(const size_t& idx)
@@ -400,6 +521,59 @@ void TGriffin::SetBitNumber(enum EGriffinBits bit, Bool_t set) const
    fGriffinBits.SetBit(bit, set);
 }
 
+namespace {
+/// One row of the 4x4 cross-talk matrix of a clover, i.e. the coefficients of one crystal for all four crystals (plus a
+/// fifth zero for invalid crystal numbers). Each thread keeps its own copy of all rows, so they can be (re-)built
+/// without any locking.
+struct TCrossTalkRow {
+   bool                  fSet{false};
+   size_t                fNofCoefficients{0};   ///< number of coefficients the channel had when the row was built
+   std::array<double, 5> fCoefficients{};
+};
+
+std::array<std::atomic<bool>, 64> gCrossTalkWarned{};
+
+size_t CrossTalkColumn(int crystal)
+{
+   return (crystal >= 0 && crystal < 4) ? static_cast<size_t>(crystal) : 4;
+}
+}   // namespace
+
+const std::array<double, 5>& TGriffin::CrossTalkCoefficients(const TGriffinHit* hit)
+{
+   /// The row is built from the coefficients of the TChannel of the hit, and rebuilt whenever they change (e.g. because
+   /// a new calibration has been loaded via ReadCalFile or ReadCalFromTree). Comparing the (at most four) coefficients
+   /// is much cheaper than the look-ups and exception handling per pair of hits this replaces. Missing coefficients are
+   /// set to zero, with a warning the first time this happens for a crystal.
+   static const std::array<double, 5> noCoefficients{};
+   int                                 detector = hit->GetDetector();
+   int                                 crystal  = hit->GetCrystal();
+   if(detector < 1 || detector > 16 || crystal < 0 || crystal > 3) {
+      return noCoefficients;
+   }
+   thread_local std::array<TCrossTalkRow, 64> rows;
+   int                                        index   = 4 * (detector - 1) + crystal;
+   auto&                                      row     = rows[index];
+   TChannel*                                  channel = hit->GetChannel();
+   if(channel == nullptr) {
+      return noCoefficients;
+   }
+   const auto& coefficients = channel->GetCTCoeff();
+   size_t      nofUsed      = std::min(coefficients.size(), static_cast<size_t>(4));
+   if(row.fSet && row.fNofCoefficients == coefficients.size() && std::equal(coefficients.begin(), coefficients.begin() + nofUsed, row.fCoefficients.begin())) {
+      return row.fCoefficients;
+   }
+
+   row.fSet             = true;
+   row.fNofCoefficients = coefficients.size();
+   row.fCoefficients.fill(0.);
+   std::copy(coefficients.begin(), coefficients.begin() + nofUsed, row.fCoefficients.begin());
+   if(coefficients.size() < 4 && !gCrossTalkWarned[index].exchange(true)) {
+      std::cerr << DRED << "Missing CT correction for Det: " << detector << " Crystal: " << crystal << " (only " << coefficients.size() << " of 4 coefficients), using zero for the missing ones" << RESET_COLOR << std::endl;
+   }
+   return row.fCoefficients;
+}
+
 Double_t TGriffin::CTCorrectedEnergy(const TGriffinHit* const hit_to_correct, const TGriffinHit* const other_hit,
                                      Bool_t time_constraint)
 {
@@ -419,27 +593,18 @@ Double_t TGriffin::CTCorrectedEnergy(const TGriffinHit* const hit_to_correct, co
    if(hit_to_correct->GetDetector() != other_hit->GetDetector()) {
       return hit_to_correct->GetEnergy();
    }
-   static std::array<bool, 256> been_warned  = {false};
-   double                       fixed_energy = hit_to_correct->GetEnergy();
-   try {
-      if(hit_to_correct->GetChannel() != nullptr) {
-         fixed_energy -= hit_to_correct->GetChannel()->GetCTCoeff().at(other_hit->GetCrystal()) * other_hit->GetNoCTEnergy();
-      }
-   } catch(const std::out_of_range& oor) {
-      int id = 16 * hit_to_correct->GetDetector() + 4 * hit_to_correct->GetCrystal() + other_hit->GetCrystal();
-      if(!been_warned[id]) {
-         been_warned[id] = true;
-         std::cerr << DRED << "Missing CT correction for Det: " << hit_to_correct->GetDetector()
-                   << " Crystals: " << hit_to_correct->GetCrystal() << " " << other_hit->GetCrystal() << " (id " << id << ")" << RESET_COLOR << std::endl;
-      }
+   double coefficient = CrossTalkCoefficients(hit_to_correct)[CrossTalkColumn(other_hit->GetCrystal())];
+   if(coefficient == 0.) {
       return hit_to_correct->GetEnergy();
    }
 
-   return fixed_energy;
+   return hit_to_correct->GetEnergy() - coefficient * other_hit->GetNoCTEnergy();
 }
 
 void TGriffin::FixCrossTalk()
 {
+   /// Groups the hits by clover and corrects the energy of each hit with its row of the clover's cross-talk matrix,
+   /// using the uncorrected energies of all hits of the same clover within the addback window (including itself).
    if(!TGRSIOptions::AnalysisOptions()->IsCorrectingCrossTalk()) { return; }
 
    auto& hitVector = Hits();
@@ -451,9 +616,56 @@ void TGriffin::FixCrossTalk()
       static_cast<TGriffinHit*>(hit)->ClearEnergy();
    }
 
-   for(auto& one : hitVector) {
-      for(auto& two : hitVector) {
-         one->SetEnergy(CTCorrectedEnergy(static_cast<TGriffinHit*>(one), static_cast<TGriffinHit*>(two)));
+   // sort the hits by clover (counting sort, hits with invalid detector numbers are not corrected)
+   std::array<size_t, 18>           start{};
+   thread_local std::vector<size_t> order;
+   order.resize(hitVector.size());
+   for(auto* hit : hitVector) {
+      int detector = hit->GetDetector();
+      if(detector >= 1 && detector <= 16) {
+         ++start[detector + 1];
+      }
+   }
+   for(size_t detector = 1; detector < start.size(); ++detector) {
+      start[detector] += start[detector - 1];
+   }
+   std::array<size_t, 17> next;
+   std::copy(start.begin(), start.begin() + next.size(), next.begin());
+   for(size_t i = 0; i < hitVector.size(); ++i) {
+      int detector = hitVector[i]->GetDetector();
+      if(detector >= 1 && detector <= 16) {
+         order[next[detector]++] = i;
+      }
+   }
+
+   const double                           window = TGRSIOptions::AnalysisOptions()->AddbackWindow();
+   thread_local std::vector<TGriffinHit*> hits;
+   thread_local std::vector<double>       times;
+   thread_local std::vector<double>       noCTEnergies;
+   thread_local std::vector<size_t>       crystals;
+   for(int detector = 1; detector <= 16; ++detector) {
+      size_t size = start[detector + 1] - start[detector];
+      if(size == 0) {
+         continue;
+      }
+      hits.resize(size);
+      times.resize(size);
+      noCTEnergies.resize(size);
+      crystals.resize(size);
+      for(size_t i = 0; i < size; ++i) {
+         hits[i]         = static_cast<TGriffinHit*>(hitVector[order[start[detector] + i]]);
+         times[i]        = hits[i]->GetTime();
+         noCTEnergies[i] = hits[i]->GetNoCTEnergy();
+         crystals[i]     = CrossTalkColumn(hits[i]->GetCrystal());
+      }
+      for(size_t i = 0; i < size; ++i) {
+         const auto& coefficients = CrossTalkCoefficients(hits[i]);
+         double      energy       = hits[i]->GetEnergy();
+         for(size_t j = 0; j < size; ++j) {
+            double inWindow = static_cast<double>(std::fabs(times[j] - times[i]) <= window);
+            energy -= inWindow * coefficients[crystals[j]] * noCTEnergies[j];
+         }
+         hits[i]->SetEnergy(energy);
       }
    }
    SetCrossTalk(true);
@@ -512,13 +724,142 @@ Short_t TGriffin::GetSuppressedMultiplicity(const TBgo* bgo)
       ResetSuppressed();
    }
    if(fSuppressedHits.empty()) {
-      CreateSuppressed(bgo, hitVector, fSuppressedHits);
+      if(UsingDefaultSuppression()) {
+         CreateCloverSuppressed(bgo, fSuppressedHits);
+      } else {
+         CreateSuppressed(bgo, hitVector, fSuppressedHits);
+      }
       SetSuppressed(true);
    }
 
    return fSuppressedHits.size();
 }
 
+bool TGriffin::UsingDefaultAddback()
+{
+   const auto* function = fAddbackCriterion.target<bool (*)(const TDetectorHit*, const TDetectorHit*)>();
+   return function != nullptr && *function == DefaultGriffinAddback;
+}
+
+bool TGriffin::UsingDefaultSuppression()
+{
+   const auto* function = fSuppressionCriterion.target<bool (*)(const TDetectorHit*, const TDetectorHit*)>();
+   return function != nullptr && *function == DefaultGriffinSuppression;
+}
+
+void TGriffin::FlagSuppressedHits(const TBgo* bgo, std::vector<char>& suppressed)
+{
+   /// Same as DefaultGriffinSuppression for all pairs of hits and BGO hits, but the BGO hits above the energy threshold
+   /// are sorted by clover and time, so each hit only needs a binary search in the BGO hits of its own clover.
+   const auto& hitVector = Hits();
+   suppressed.assign(hitVector.size(), 0);
+   if(bgo == nullptr || bgo->GetMultiplicity() == 0) {
+      return;
+   }
+   const double window    = TGRSIOptions::AnalysisOptions()->SuppressionWindow();
+   const double threshold = TGRSIOptions::AnalysisOptions()->SuppressionEnergy();
+
+   thread_local std::array<std::vector<double>, 17> bgoTimes;
+   for(auto& times : bgoTimes) {
+      times.clear();
+   }
+   for(int b = 0; b < bgo->GetMultiplicity(); ++b) {
+      const auto* bgoHit   = bgo->GetHit(b);
+      int         detector = bgoHit->GetDetector();
+      if(detector >= 1 && detector <= 16 && bgoHit->GetEnergy() > threshold) {
+         bgoTimes[detector].push_back(bgoHit->GetTime());
+      }
+   }
+   for(auto& times : bgoTimes) {
+      std::sort(times.begin(), times.end());
+   }
+
+   for(size_t i = 0; i < hitVector.size(); ++i) {
+      int detector = hitVector[i]->GetDetector();
+      if(detector < 1 || detector > 16 || bgoTimes[detector].empty()) {
+         continue;
+      }
+      const auto& times = bgoTimes[detector];
+      double      time  = hitVector[i]->GetTime();
+      // first BGO hit after time - window, the hit is suppressed if that one is also before time + window
+      auto bgoTime = std::upper_bound(times.begin(), times.end(), time - window);
+      suppressed[i] = static_cast<char>(bgoTime != times.end() && *bgoTime < time + window);
+   }
+}
+
+void TGriffin::CreateCloverAddback(const std::vector<char>* suppressed, std::vector<TDetectorHit*>& addbacks, std::vector<UShort_t>& nofFragments)
+{
+   /// Same as TSuppressed::CreateAddback (or CreateSuppressedAddback if the suppression flags of the hits are given)
+   /// with DefaultGriffinAddback, i.e. each hit is added to the first addback hit it matches or starts a new one, but
+   /// only the addback hits of the same clover are checked and the addback window is only read once.
+   /// Hits with invalid detector numbers are never added back.
+   const auto&  hitVector = Hits();
+   const double window    = TGRSIOptions::AnalysisOptions()->AddbackWindow();
+
+   thread_local std::array<std::vector<size_t>, 17> cloverAddbacks;
+   for(auto& clover : cloverAddbacks) {
+      clover.clear();
+   }
+   thread_local std::vector<char> suppressedAddbacks;
+   suppressedAddbacks.clear();
+
+   for(size_t i = 0; i < hitVector.size(); ++i) {
+      auto* hit          = static_cast<TGriffinHit*>(hitVector[i]);
+      int   detector     = hit->GetDetector();
+      bool  isSuppressed = suppressed != nullptr && (*suppressed)[i] != 0;
+      bool  added        = false;
+      if(detector >= 1 && detector <= 16) {
+         double time = hit->GetTime();
+         for(auto a : cloverAddbacks[detector]) {
+            if(std::fabs(addbacks[a]->GetTime() - time) < window) {
+               addbacks[a]->Add(hit);
+               ++nofFragments[a];
+               suppressedAddbacks[a] = static_cast<char>(suppressedAddbacks[a] != 0 || isSuppressed);
+               added                 = true;
+               break;
+            }
+         }
+         if(!added) {
+            cloverAddbacks[detector].push_back(addbacks.size());
+         }
+      }
+      if(!added) {
+         addbacks.push_back(fHitArena.Create<TGriffinHit>(*hit));
+         nofFragments.push_back(1);
+         suppressedAddbacks.push_back(static_cast<char>(isSuppressed));
+      }
+   }
+
+   if(suppressed == nullptr) {
+      return;
+   }
+   // remove all addback hits that include a suppressed hit (they stay in the arena until it is reset)
+   size_t kept = 0;
+   for(size_t a = 0; a < addbacks.size(); ++a) {
+      if(suppressedAddbacks[a] != 0) {
+         continue;
+      }
+      addbacks[kept]     = addbacks[a];
+      nofFragments[kept] = nofFragments[a];
+      ++kept;
+   }
+   addbacks.resize(kept);
+   nofFragments.resize(kept);
+}
+
+void TGriffin::CreateCloverSuppressed(const TBgo* bgo, std::vector<TDetectorHit*>& suppressedHits)
+{
+   /// Same as TSuppressed::CreateSuppressed with DefaultGriffinSuppression, see FlagSuppressedHits.
+   thread_local std::vector<char> suppressed;
+   FlagSuppressedHits(bgo, suppressed);
+   const auto& hitVector = Hits();
+   for(size_t i = 0; i < hitVector.size(); ++i) {
+      if(suppressed[i] == 0) {
+         suppressedHits.push_back(fHitArena.Create<TGriffinHit>(*static_cast<TGriffinHit*>(hitVector[i])));
+      }
+   }
+}
+
 void TGriffin::SetSuppressed(const bool flag) const
 {
    SetBitNumber(EGriffinBits::kIsSuppressed, flag);
@@ -527,10 +868,8 @@ void TGriffin::SetSuppressed(const bool flag) const
 void TGriffin::ResetSuppressed()
 {
    SetSuppressed(false);
-   for(auto& hit : fSuppressedHits) {
-      delete hit;
-   }
-   fSuppressedHits.clear();
+   fHitArena.Release(fSuppressedHits);
+   ResetArenaIfUnused();
 }
 
 TGriffinHit* TGriffin::GetSuppressedAddbackHit(const int& i)
@@ -566,7 +905,13 @@ Short_t TGriffin::GetSuppressedAddbackMultiplicity(const TBgo* bgo)
       ResetSuppressedAddback();
    }
    if(fSuppressedAddbackHits.empty()) {
-      CreateSuppressedAddback(bgo, hitVector, fSuppressedAddbackHits, fSuppressedAddbackFrags);
+      if(UsingDefaultAddback() && UsingDefaultSuppression()) {
+         thread_local std::vector<char> suppressed;
+         FlagSuppressedHits(bgo, suppressed);
+         CreateCloverAddback(&suppressed, fSuppressedAddbackHits, fSuppressedAddbackFrags);
+      } else {
+         CreateSuppressedAddback(bgo, hitVector, fSuppressedAddbackHits, fSuppressedAddbackFrags);
+      }
       SetSuppressedAddback(true);
    }
 
@@ -581,11 +926,9 @@ void TGriffin::SetSuppressedAddback(const bool flag) const
 void TGriffin::ResetSuppressedAddback()
 {
    SetSuppressedAddback(false);
-   for(auto& hit : fSuppressedAddbackHits) {
-      delete hit;
-   }
-   fSuppressedAddbackHits.clear();
+   fHitArena.Release(fSuppressedAddbackHits);
    fSuppressedAddbackFrags.clear();
+   ResetArenaIfUnused();
 }
 
 UShort_t TGriffin::GetNSuppressedAddbackFrags(const size_t& idx)
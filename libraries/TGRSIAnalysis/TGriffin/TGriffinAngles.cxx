@@ -2,6 +2,8 @@
 #include "TGriffin.h"
 #include "TGRSIOptions.h"
 
+#include "TBuffer.h"
+
 double     TGriffinAngles::fRounding  = 0.001;
 EVerbosity TGriffinAngles::fVerbosity = EVerbosity::kQuiet;
 
@@ -43,16 +45,11 @@ TGriffinAngles::TGriffinAngles(double distance, bool folding, bool grouping, boo
 
    // loop over all possible detector/crystal combinations
    for(int firstDet = 1; firstDet <= 16; ++firstDet) {
-      if(ExcludeDetector(firstDet)) { continue; }
       for(int firstCry = 0; firstCry < 4; ++firstCry) {
-         if(ExcludeCrystal(firstDet, firstCry)) { continue; }
          for(int secondDet = 1; secondDet <= 16; ++secondDet) {
-            if(ExcludeDetector(secondDet)) { continue; }
             for(int secondCry = 0; secondCry < 4; ++secondCry) {
-               if(ExcludeCrystal(secondDet, secondCry)) { continue; }
-               // exclude hits in the same crystal or, if addback is enabled, in the same detector
-               if(firstDet == secondDet && (firstCry == secondCry || fAddback)) { continue; }
-               double angle = TGriffin::GetPosition(firstDet, firstCry, fDistance).Angle(TGriffin::GetPosition(secondDet, secondCry, fDistance)) * 180. / TMath::Pi();
+               if(ExcludePair(firstDet, firstCry, secondDet, secondCry)) { continue; }
+               double angle = TGriffin::GetCrystalAngle(firstDet, firstCry, secondDet, secondCry, fDistance) * 180. / TMath::Pi();
                if(fVerbosity == EVerbosity::kAll) {
                   std::cout << "det./cry. " << firstDet << "/" << firstCry << " with  " << secondDet << "/" << secondCry << ", at " << fDistance << " mm = " << angle << std::endl;
                }
@@ -144,35 +141,95 @@ TGriffinAngles::TGriffinAngles(double distance, bool folding, bool grouping, boo
       // update the angles to the new grouped angles
       fAngles = groupedAngles;
    }
+
+   BuildTables();
 }
 
-int TGriffinAngles::Index(double angle)
+void TGriffinAngles::Streamer(TBuffer& R__b)
 {
-   auto matches = [angle, this](std::pair<double, int> val) { return std::abs(val.first - angle) < fRounding; };
-   auto it      = std::find_if(fAngleMap.begin(), fAngleMap.end(), matches);
+   /// Streams the object and re-creates the lookup tables after reading it.
+   if(R__b.IsReading()) {
+      R__b.ReadClassBuffer(TGriffinAngles::Class(), this);
+      BuildTables();
+   } else {
+      R__b.WriteClassBuffer(TGriffinAngles::Class(), this);
+   }
+}
 
-   if(it == fAngleMap.end()) {
+int TGriffinAngles::Index(double angle) const
+{
+   int index = FindIndex(angle);
+   if(index == -1) {
       std::cout << "Failed to find angle " << angle << " in map!" << std::endl;
       return -1;
    }
-   if(it->second >= static_cast<int>(fAngles.size())) {
-      std::cout << "Found index " << it->second << " for angle " << angle << " which is outside range (" << fAngles.size() << ")" << std::endl;
+   if(index >= static_cast<int>(fAngles.size())) {
+      std::cout << "Found index " << index << " for angle " << angle << " which is outside range (" << fAngles.size() << ")" << std::endl;
+      return -1;
+   }
+   return index;
+}
+
+int TGriffinAngles::Index(int firstDet, int firstCry, int secondDet, int secondCry) const
+{
+   /// Returns the same index as Index(angle) for the angle between the two crystals, but looks it up in a table of all
+   /// crystal pairs. Returns -1 (without any warning) if there is no index for these two crystals.
+   if(firstDet < 1 || firstDet > 16 || firstCry < 0 || firstCry > 3 || secondDet < 1 || secondDet > 16 || secondCry < 0 || secondCry > 3) {
+      return -1;
+   }
+   return fPairIndex[(4 * (firstDet - 1) + firstCry) * 64 + 4 * (secondDet - 1) + secondCry];
+}
+
+int TGriffinAngles::FindIndex(double angle) const
+{
+   /// Returns the index mapped to the first angle within the rounding of this angle (or -1 if there is none). The map
+   /// is sorted by angle, so this is the first angle larger than angle - fRounding.
+   auto it = fAngleMap.upper_bound(angle - fRounding);
+   if(it == fAngleMap.end() || std::abs(it->first - angle) >= fRounding) {
       return -1;
    }
    return it->second;
 }
 
-double TGriffinAngles::AverageAngle(int index) const
+void TGriffinAngles::BuildTables()
 {
-   double result     = 0.;
-   int    nofMatches = 0;
+   /// Creates the angle and average angle of each index, and the index of each pair of crystals.
+   fAngleVector.assign(fAngles.begin(), fAngles.end());
+
+   fAverageAngles.assign(fAngles.size(), 0.);
+   std::vector<int> nofMatches(fAngles.size(), 0);
    for(const auto& val : fAngleMap) {
-      if(val.second == index) {
-         result += val.first;
-         ++nofMatches;
+      if(val.second >= 0 && val.second < static_cast<int>(fAverageAngles.size())) {
+         fAverageAngles[val.second] += val.first;
+         ++nofMatches[val.second];
+      }
+   }
+   for(size_t i = 0; i < fAverageAngles.size(); ++i) {
+      // an index without any angle mapped to it can only happen for broken maps, so we just use the angle itself
+      fAverageAngles[i] = (nofMatches[i] > 0) ? fAverageAngles[i] / nofMatches[i] : fAngleVector[i];
+   }
+
+   for(int first = 0; first < 64; ++first) {
+      for(int second = 0; second < 64; ++second) {
+         // same exclusions, folding, and rounding as in the constructor
+         if(ExcludePair(first / 4 + 1, first % 4, second / 4 + 1, second % 4)) {
+            fPairIndex[first * 64 + second] = -1;
+            continue;
+         }
+         double angle = TGriffin::GetCrystalAngle(first / 4 + 1, first % 4, second / 4 + 1, second % 4, fDistance) * 180. / TMath::Pi();
+         if(fFolding && angle > 90.) {
+            angle = 180. - angle;
+         }
+         if(angle < fRounding) {
+            angle = 0.;
+         }
+         int index = FindIndex(angle);
+         if(index >= static_cast<int>(fAngles.size())) {
+            index = -1;
+         }
+         fPairIndex[first * 64 + second] = static_cast<int16_t>(index);
       }
    }
-   return result / nofMatches;
 }
 
 void TGriffinAngles::FoldOrGroup(TGraphErrors* z0, TGraphErrors* z2, TGraphErrors* z4, bool verbose) const
@@ -392,6 +449,16 @@ bool TGriffinAngles::ExcludeCrystal(int detector, int crystal) const
    return std::any_of(fExcludedCrystals.begin(), fExcludedCrystals.end(), [&detector, &crystal](auto exclude) { return 4 * (detector - 1) + crystal + 1 == exclude; });
 }
 
+bool TGriffinAngles::ExcludePair(int firstDet, int firstCry, int secondDet, int secondCry) const
+{
+   /// Returns true if either crystal is excluded, if both are the same crystal, or, if addback is used, if both are in
+   /// the same detector.
+   if(ExcludeDetector(firstDet) || ExcludeCrystal(firstDet, firstCry) || ExcludeDetector(secondDet) || ExcludeCrystal(secondDet, secondCry)) {
+      return true;
+   }
+   return firstDet == secondDet && (firstCry == secondCry || fAddback);
+}
+
 void TGriffinAngles::Print(Option_t*) const
 {
    std::cout << "List of unique angles " << std::setw(2) << fAngles.size() << " Map from angles to indices " << std::setw(2) << fAngleMap.size() << "   # of combinations " << std::setw(2) << fAngleCount.size() << std::endl;
@@ -0,0 +1,202 @@
+#include "TGriffinEventMixer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "TGriffin.h"
+#include "TGriffinBgo.h"
+#include "TGRSIOptions.h"
+
+TGriffinEventMixer::TGriffinEventMixer(const TGriffinAngles* angles, int nofBins, double low, double high)
+   : fAngles(angles), fNofBins(nofBins), fLow(low), fHigh(high)
+{
+   if(fAngles == nullptr || fNofBins <= 0 || fHigh <= fLow) {
+      std::ostringstream str;
+      str << DRED << "Can't mix events without angles (" << fAngles << ") or with an invalid binning (" << fNofBins << " bins from " << fLow << " to " << fHigh << ")!" << RESET_COLOR;
+      throw std::runtime_error(str.str());
+   }
+   if(TGRSIOptions::Get() != nullptr && TGRSIOptions::UserSettings() != nullptr) {
+      auto* settings = TGRSIOptions::UserSettings();
+      try {
+         fDepth = static_cast<size_t>(std::max(settings->GetInt("Mixing.Depth", true), 0));
+      } catch(std::out_of_range&) {}
+      try {
+         fGateLow  = settings->GetDoubleVector("Mixing.GateLow", true);
+         fGateHigh = settings->GetDoubleVector("Mixing.GateHigh", true);
+      } catch(std::out_of_range&) {
+         fGateLow.clear();
+         fGateHigh.clear();
+      }
+      if(fGateLow.size() != fGateHigh.size()) {
+         std::cout << DRED << "Mismatch between " << fGateLow.size() << " low and " << fGateHigh.size() << " high edges of the mixing gates, not using any gates!" << RESET_COLOR << std::endl;
+         fGateLow.clear();
+         fGateHigh.clear();
+      }
+   }
+   UpdateRows();
+}
+
+void TGriffinEventMixer::AddGate(double low, double high)
+{
+   fGateLow.push_back(low);
+   fGateHigh.push_back(high);
+   UpdateRows();
+}
+
+void TGriffinEventMixer::ClearGates()
+{
+   fGateLow.clear();
+   fGateHigh.clear();
+   UpdateRows();
+}
+
+void TGriffinEventMixer::UpdateRows()
+{
+   /// Assigns a row of the dense arrays to each y-bin within at least one of the gates (or to all bins if there are no gates).
+   if(!fStates.Empty()) {
+      throw std::runtime_error("Can't change the gates of TGriffinEventMixer after events have been added!");
+   }
+   fRow.assign(fNofBins, -1);
+   fNofRows           = 0;
+   const double width = (fHigh - fLow) / fNofBins;
+   for(int bin = 0; bin < fNofBins; ++bin) {
+      double binLow  = fLow + bin * width;
+      double binHigh = binLow + width;
+      bool   inGate  = fGateLow.empty();
+      for(size_t g = 0; g < fGateLow.size() && !inGate; ++g) {
+         inGate = binHigh > fGateLow[g] && binLow < fGateHigh[g];
+      }
+      if(inGate) {
+         fRow[bin] = fNofRows++;
+      }
+   }
+}
+
+TGriffinEventMixer::TThreadState& TGriffinEventMixer::State()
+{
+   return fStates.Get([this]() {
+      auto state = std::make_unique<TThreadState>();
+      state->fCounts.resize(fAngles->NumberOfAngles());
+      return state;
+   });
+}
+
+void TGriffinEventMixer::Fill(TThreadState& state, int angle, int32_t xBin, int32_t yBin) const
+{
+   int32_t row = fRow[yBin];
+   if(row < 0) {
+      return;
+   }
+   auto& counts = state.fCounts[angle];
+   if(counts.empty()) {
+      counts.assign(static_cast<size_t>(fNofRows) * fNofBins, 0);
+   }
+   ++counts[static_cast<size_t>(row) * fNofBins + xBin];
+}
+
+void TGriffinEventMixer::AddEvent(size_t n, const int* detector, const int* crystal, const double* energy)
+{
+   /// Hits outside of the histogram range or with an invalid detector/crystal are ignored. Events without any hits left
+   /// are not added to the buffer.
+   if(fDepth == 0) {
+      return;
+   }
+   auto& state = State();
+
+   state.fCurrent.clear();
+   const double binsPerEnergy = fNofBins / (fHigh - fLow);
+   for(size_t i = 0; i < n; ++i) {
+      if(detector[i] < 1 || detector[i] > 16 || crystal[i] < 0 || crystal[i] > 3 || energy[i] < fLow || energy[i] >= fHigh) {
+         continue;
+      }
+      auto bin = static_cast<int32_t>((energy[i] - fLow) * binsPerEnergy);
+      if(bin >= fNofBins) {
+         bin = fNofBins - 1;
+      }
+      state.fCurrent.push_back({static_cast<int16_t>(4 * (detector[i] - 1) + crystal[i]), bin});
+   }
+   if(state.fCurrent.empty()) {
+      return;
+   }
+
+   for(const auto& event : state.fEvents) {
+      for(const auto& hit : state.fCurrent) {
+         for(const auto& previous : event) {
+            int angle = fAngles->Index(hit.fCrystal / 4 + 1, hit.fCrystal % 4, previous.fCrystal / 4 + 1, previous.fCrystal % 4);
+            if(angle < 0) {
+               continue;
+            }
+            Fill(state, angle, hit.fBin, previous.fBin);
+            if(fSymmetric) {
+               Fill(state, angle, previous.fBin, hit.fBin);
+            }
+            ++state.fPairs;
+         }
+      }
+   }
+
+   if(state.fEvents.size() < fDepth) {
+      state.fEvents.push_back(state.fCurrent);
+   } else {
+      state.fEvents[state.fNext].swap(state.fCurrent);
+      state.fNext = (state.fNext + 1) % state.fEvents.size();
+   }
+}
+
+void TGriffinEventMixer::AddEvent(TGriffin* griffin, TGriffinBgo* bgo)
+{
+   std::vector<int>    detector;
+   std::vector<int>    crystal;
+   std::vector<double> energy;
+   int                 multiplicity = fAngles->Addback() ? griffin->GetSuppressedAddbackMultiplicity(bgo) : griffin->GetSuppressedMultiplicity(bgo);
+   for(int i = 0; i < multiplicity; ++i) {
+      auto* hit = fAngles->Addback() ? griffin->GetSuppressedAddbackHit(i) : griffin->GetSuppressedHit(i);
+      detector.push_back(hit->GetDetector());
+      crystal.push_back(hit->GetCrystal());
+      energy.push_back(hit->GetEnergy());
+   }
+   AddEvent(energy.size(), detector.data(), crystal.data(), energy.data());
+}
+
+std::vector<TH2D*> TGriffinEventMixer::Histograms(const char* baseName) const
+{
+   std::vector<TH2D*> result;
+   for(int angle = 0; angle < fAngles->NumberOfAngles(); ++angle) {
+      TH2D* hist = nullptr;
+      fStates.ForEach([&](const TThreadState& state) {
+         const auto& counts = state.fCounts[angle];
+         if(counts.empty()) {
+            return;
+         }
+         if(hist == nullptr) {
+            hist = new TH2D(Form("%s%d", baseName, angle), Form("event mixed #gamma-#gamma matrix at %.1f^{o}", fAngles->AverageAngle(angle)), fNofBins, fLow, fHigh, fNofBins, fLow, fHigh);
+         }
+         for(int yBin = 0; yBin < fNofBins; ++yBin) {
+            int32_t row = fRow[yBin];
+            if(row < 0) {
+               continue;
+            }
+            const uint32_t* rowCounts = counts.data() + static_cast<size_t>(row) * fNofBins;
+            for(int xBin = 0; xBin < fNofBins; ++xBin) {
+               if(rowCounts[xBin] > 0) {
+                  hist->AddBinContent(hist->GetBin(xBin + 1, yBin + 1), rowCounts[xBin]);
+               }
+            }
+         }
+      });
+      if(hist != nullptr) {
+         hist->ResetStats();
+      }
+      result.push_back(hist);
+   }
+   return result;
+}
+
+size_t TGriffinEventMixer::NumberOfPairs() const
+{
+   size_t result = 0;
+   fStates.ForEach([&result](const TThreadState& state) { result += state.fPairs; });
+   return result;
+}
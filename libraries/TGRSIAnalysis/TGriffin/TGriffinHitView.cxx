@@ -0,0 +1,92 @@
+#include "TGriffinHitView.h"
+
+#include <limits>
+
+#include "TGriffin.h"
+#include "TGriffinHit.h"
+
+void TGriffinHitView::Clear()
+{
+   fEnergy.clear();
+   fTime.clear();
+   fDetector.clear();
+   fCrystal.clear();
+   fArrayNumber.clear();
+   fCrystalIndex.clear();
+   fNofFragments.clear();
+   fHits.clear();
+}
+
+void TGriffinHitView::UpdateTable(double dist)
+{
+   if(!fCosAngles.empty() && fDistance == dist) {
+      return;
+   }
+   /// The last row and column are for hits with invalid crystals and filled with NaN, so any angle with such a hit
+   /// is obviously wrong instead of looking like 90 degrees.
+   fDistance = dist;
+   fCosAngles.assign(kTableSize * kTableSize, std::numeric_limits<double>::quiet_NaN());
+   const double* table = TGriffin::GetCosCrystalAngleTable(dist);
+   for(int first = 0; first < 64; ++first) {
+      for(int second = 0; second < 64; ++second) {
+         fCosAngles[kTableSize * first + second] = table[64 * first + second];
+      }
+   }
+}
+
+void TGriffinHitView::Add(TDetectorHit* hit, uint16_t nofFragments)
+{
+   auto* griffinHit = static_cast<TGriffinHit*>(hit);
+   int   detector   = griffinHit->GetDetector();
+   int   crystal    = griffinHit->GetCrystal();
+   fEnergy.push_back(griffinHit->GetEnergy());
+   fTime.push_back(griffinHit->GetTime());
+   fDetector.push_back(static_cast<int16_t>(detector));
+   fCrystal.push_back(static_cast<int16_t>(crystal));
+   fArrayNumber.push_back(griffinHit->GetArrayNumber());
+   fCrystalIndex.push_back(static_cast<int16_t>((detector >= 1 && detector <= 16 && crystal >= 0 && crystal < 4) ? 4 * (detector - 1) + crystal : kTableSize - 1));
+   fNofFragments.push_back(nofFragments);
+   fHits.push_back(griffinHit);
+}
+
+size_t TGriffinHitView::Fill(TGriffin* griffin, EHitType type, const TBgo* bgo, double dist)
+{
+   /// Builds the addback and suppressed hits if necessary, the same way the accessors of TGriffin do.
+   Clear();
+   fType = type;
+   UpdateTable(dist);
+   if(griffin == nullptr) {
+      return 0;
+   }
+
+   switch(type) {
+   case EHitType::kRaw:
+      if(!griffin->IsCrossTalkSet()) {
+         griffin->FixCrossTalk();
+      }
+      for(auto* hit : griffin->Hits()) {
+         Add(hit, 1);
+      }
+      break;
+   case EHitType::kAddback:
+      griffin->GetAddbackMultiplicity();
+      for(size_t i = 0; i < griffin->fAddbackHits.size(); ++i) {
+         Add(griffin->fAddbackHits[i], griffin->fAddbackFrags[i]);
+      }
+      break;
+   case EHitType::kSuppressed:
+      griffin->GetSuppressedMultiplicity(bgo);
+      for(auto* hit : griffin->fSuppressedHits) {
+         Add(hit, 1);
+      }
+      break;
+   case EHitType::kSuppressedAddback:
+      griffin->GetSuppressedAddbackMultiplicity(bgo);
+      for(size_t i = 0; i < griffin->fSuppressedAddbackHits.size(); ++i) {
+         Add(griffin->fSuppressedAddbackHits[i], griffin->fSuppressedAddbackFrags[i]);
+      }
+      break;
+   }
+
+   return Size();
+}
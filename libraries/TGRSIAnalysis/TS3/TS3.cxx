@@ -1,6 +1,8 @@
 #include "TS3.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include "TMath.h"
 
 #include "TGRSIOptions.h"
@@ -110,209 +112,221 @@ void TS3::BuildPixels()
    }
 
    if(fS3PixelHits.empty()) {
-
-      // We are going to want energies several times
-      // So build a quick vector
-      std::vector<double> EneR;
-      std::vector<double> EneS;
-      std::vector<bool>   UsedRing;
-      std::vector<bool>   UsedSector;
-      for(auto& fS3RingHit : fS3RingHits) {
-         EneR.push_back(fS3RingHit.GetEnergy());
-         UsedRing.push_back(false);
+      // We are going to want energies, times, and array positions several times
+      // So build quick vectors
+      const size_t        nofRings   = fS3RingHits.size();
+      const size_t        nofSectors = fS3SectorHits.size();
+      std::vector<double> EneR(nofRings);
+      std::vector<double> EneS(nofSectors);
+      std::vector<double> TimeR(nofRings);
+      std::vector<double> TimeS(nofSectors);
+      std::vector<int>    PosR(nofRings);
+      std::vector<int>    PosS(nofSectors);
+      std::vector<bool>   UsedRing(nofRings, false);
+      std::vector<bool>   UsedSector(nofSectors, false);
+      for(size_t i = 0; i < nofRings; ++i) {
+         EneR[i]  = fS3RingHits[i].GetEnergy();
+         TimeR[i] = fS3RingHits[i].GetTime();
+         PosR[i]  = fS3RingHits[i].GetArrayPosition();
       }
-      for(auto& fS3SectorHit : fS3SectorHits) {
-         EneS.push_back(fS3SectorHit.GetEnergy());
-         UsedSector.push_back(false);
+      for(size_t i = 0; i < nofSectors; ++i) {
+         EneS[i]  = fS3SectorHits[i].GetEnergy();
+         TimeS[i] = fS3SectorHits[i].GetTime();
+         PosS[i]  = fS3SectorHits[i].GetArrayPosition();
       }
 
-      // new
-      /// Loop over two vectors and build energy+time matching hits
-      for(size_t i = 0; i < fS3RingHits.size(); ++i) {
-         for(size_t j = 0; j < fS3SectorHits.size(); ++j) {
-            if(fS3RingHits[i].GetArrayPosition() != fS3SectorHits[j].GetArrayPosition()) { continue; }
-
-            if(abs(fS3RingHits[i].GetTime() - fS3SectorHits[j].GetTime()) * 1.6 < fFrontBackTime) {   // check time
-               if((EneR[i] - fFrontBackOffset) * fFrontBackEnergy < EneS[j] &&
-                  (EneS[j] - fFrontBackOffset) * fFrontBackEnergy < EneR[i]) {   // if time is good check energy
-
-                  // Now we have accepted a good event, build it
-                  if(SectorPreference()) {
-                     TS3Hit dethit = fS3SectorHits[j];   // Sector defines all data ring just gives position
-                     dethit.SetRingNumber(fS3RingHits[i].GetRing());
-                     fS3PixelHits.push_back(dethit);
-                  } else {
-                     TS3Hit dethit = fS3RingHits[i];   // Ring defines all data sector just gives position (default)
-                     dethit.SetSectorNumber(fS3SectorHits[j].GetSector());
-                     fS3PixelHits.push_back(dethit);
-                  }
-
-                  // Although set to used for MultiHit, continue to check all combinations in this loop.
-                  UsedRing[i]   = true;
-                  UsedSector[j] = true;
-                  // This is desired behaviour for telescope, debugging, etc, when one would set fFrontBackEnergy=0 and
-                  // build all combinations
-               }
+      auto timeMatch = [](double ringTime, double sectorTime) {
+         return abs(ringTime - sectorTime) * 1.6 < fFrontBackTime;
+      };
+
+      /// Sort both sides by array position and time and find all ring/sector pairs of the same array position that
+      /// pass the time condition with a two-pointer sweep. The sweep window is a bit wider than the time condition, which
+      /// is then checked for each candidate, so the pairs are exactly the same as for a loop over all combinations.
+      std::vector<size_t> ringOrder(nofRings);
+      std::vector<size_t> sectorOrder(nofSectors);
+      std::iota(ringOrder.begin(), ringOrder.end(), 0);
+      std::iota(sectorOrder.begin(), sectorOrder.end(), 0);
+      std::sort(ringOrder.begin(), ringOrder.end(), [&PosR, &TimeR](size_t a, size_t b) { return PosR[a] < PosR[b] || (PosR[a] == PosR[b] && TimeR[a] < TimeR[b]); });
+      std::sort(sectorOrder.begin(), sectorOrder.end(), [&PosS, &TimeS](size_t a, size_t b) { return PosS[a] < PosS[b] || (PosS[a] == PosS[b] && TimeS[a] < TimeS[b]); });
+
+      const double                           window = fFrontBackTime / 1.6 + 1.;
+      std::vector<std::pair<size_t, size_t>> pairs;   // (ring, sector)
+      size_t                                 first = 0;
+      for(auto ring : ringOrder) {
+         while(first < nofSectors && (PosS[sectorOrder[first]] < PosR[ring] || (PosS[sectorOrder[first]] == PosR[ring] && TimeS[sectorOrder[first]] < TimeR[ring] - window))) {
+            ++first;
+         }
+         for(size_t s = first; s < nofSectors && PosS[sectorOrder[s]] == PosR[ring] && TimeS[sectorOrder[s]] < TimeR[ring] + window; ++s) {
+            if(timeMatch(TimeR[ring], TimeS[sectorOrder[s]])) {
+               pairs.emplace_back(ring, sectorOrder[s]);
             }
          }
       }
-
-      if(MultiHit()) {
-
-         int ringcount   = 0;
-         int sectorcount = 0;
-         for(auto&& i : UsedRing) {
-            if(!i) {
-               ringcount++;
+      // process the pairs in the same order as the loop over all rings and sectors
+      std::sort(pairs.begin(), pairs.end());
+
+      /// Build energy+time matching hits
+      for(const auto& pair : pairs) {
+         size_t i = pair.first;
+         size_t j = pair.second;
+         if((EneR[i] - fFrontBackOffset) * fFrontBackEnergy < EneS[j] &&
+            (EneS[j] - fFrontBackOffset) * fFrontBackEnergy < EneR[i]) {   // time is good, check energy
+
+            // Now we have accepted a good event, build it
+            if(SectorPreference()) {
+               TS3Hit dethit = fS3SectorHits[j];   // Sector defines all data ring just gives position
+               dethit.SetRingNumber(fS3RingHits[i].GetRing());
+               fS3PixelHits.push_back(dethit);
+            } else {
+               TS3Hit dethit = fS3RingHits[i];   // Ring defines all data sector just gives position (default)
+               dethit.SetSectorNumber(fS3SectorHits[j].GetSector());
+               fS3PixelHits.push_back(dethit);
             }
+
+            // Although set to used for MultiHit, continue to check all combinations in this loop.
+            UsedRing[i]   = true;
+            UsedSector[j] = true;
+            // This is desired behaviour for telescope, debugging, etc, when one would set fFrontBackEnergy=0 and
+            // build all combinations
          }
+      }
 
-         for(auto&& i : UsedSector) {
-            if(!i) {
-               sectorcount++;
-            }
+      if(MultiHit()) {
+         // Shared strips can only be combined from the time-matched pairs, so instead of looping over all rings and
+         // pairs of sectors (or vice versa) we only go through the pairs found above, in the same order and with the
+         // same greedy use of the strips as the loops over all combinations.
+         std::vector<size_t> ringStart(nofRings + 1, 0);   // pairs[ringStart[i], ringStart[i+1]) have ring i
+         for(const auto& pair : pairs) {
+            ++ringStart[pair.first + 1];
          }
+         std::partial_sum(ringStart.begin(), ringStart.end(), ringStart.begin());
+
+         auto unused = [](const std::vector<bool>& used) { return std::count(used.begin(), used.end(), false); };
 
          /// If we have parts of hit left here they are possibly a shared strip hit not easy singles
-         if(ringcount > 1 || sectorcount > 1) {
+         if(unused(UsedRing) > 1 || unused(UsedSector) > 1) {
 
             // Shared Ring loop
-            for(size_t i = 0; i < fS3RingHits.size(); ++i) {
-               if(UsedRing.at(i)) {
+            for(size_t i = 0; i < nofRings; ++i) {
+               if(UsedRing[i]) {
                   continue;
                }
-               for(size_t j = 0; j < fS3SectorHits.size(); ++j) {
-                  if(UsedSector.at(j)) {
+               for(size_t a = ringStart[i]; a < ringStart[i + 1]; ++a) {
+                  size_t j = pairs[a].second;
+                  if(UsedSector[j]) {
                      continue;
                   }
-                  if(fS3RingHits[i].GetArrayPosition() != fS3SectorHits[j].GetArrayPosition()) { continue; }
-
-                  for(size_t k = j + 1; k < fS3SectorHits.size(); ++k) {
-                     if(UsedSector.at(k)) {
+                  for(size_t b = a + 1; b < ringStart[i + 1]; ++b) {
+                     size_t k = pairs[b].second;
+                     if(UsedSector[k]) {
                         continue;
                      }
-                     if(fS3SectorHits[j].GetArrayPosition() != fS3SectorHits[k].GetArrayPosition()) { continue; }
-
-                     if(abs(fS3RingHits[i].GetTime() - fS3SectorHits[j].GetTime()) * 1.6 < fFrontBackTime &&
-                        abs(fS3RingHits[i].GetTime() - fS3SectorHits[k].GetTime()) * 1.6 < fFrontBackTime) {   // check time
-                        if((EneR[i] - fFrontBackOffset) * fFrontBackEnergy < (EneS[j] + EneS[k]) &&
-                           (EneS[j] + EneS[k] - fFrontBackOffset) * fFrontBackEnergy < EneR[i]) {   // if time is good check energy
-
-                           int SectorSep = fS3SectorHits[j].GetSector() - fS3SectorHits[k].GetSector();
-                           if(abs(SectorSep) == 1 || abs(SectorSep) == fSectorNumber) {
-                              // Same ring and neighbour sectors, almost certainly charge sharing
-                              // Experiments with breakup might get real mult2 events like this but most will be
-                              // charge
-                              // sharing
-
-                              if(KeepShared()) {
-                                 TS3Hit dethit = fS3RingHits[i];   // Ring defines all data sector just gives position
-                                 // Selecting one of the sectors is currently the best class allows, some loss of
-                                 // position information
-                                 if(fS3SectorHits[k].GetEnergy() < fS3SectorHits[j].GetEnergy()) {
-                                    dethit.SetSectorNumber(fS3SectorHits[j].GetSector());
-                                 } else {
-                                    dethit.SetSectorNumber(fS3SectorHits[k].GetSector());
-                                 }
-                                 fS3PixelHits.push_back(dethit);
+                     if((EneR[i] - fFrontBackOffset) * fFrontBackEnergy < (EneS[j] + EneS[k]) &&
+                        (EneS[j] + EneS[k] - fFrontBackOffset) * fFrontBackEnergy < EneR[i]) {   // time is good, check energy
+
+                        int SectorSep = fS3SectorHits[j].GetSector() - fS3SectorHits[k].GetSector();
+                        if(abs(SectorSep) == 1 || abs(SectorSep) == fSectorNumber) {
+                           // Same ring and neighbour sectors, almost certainly charge sharing
+                           // Experiments with breakup might get real mult2 events like this but most will be
+                           // charge
+                           // sharing
+
+                           if(KeepShared()) {
+                              TS3Hit dethit = fS3RingHits[i];   // Ring defines all data sector just gives position
+                              // Selecting one of the sectors is currently the best class allows, some loss of
+                              // position information
+                              if(EneS[k] < EneS[j]) {
+                                 dethit.SetSectorNumber(fS3SectorHits[j].GetSector());
+                              } else {
+                                 dethit.SetSectorNumber(fS3SectorHits[k].GetSector());
                               }
-                           } else {
-                              // 2 separate hits with shared ring
-
-                              // Now we have accepted a good event, build it
-                              TS3Hit dethit = fS3SectorHits[j];   // Sector now defines all data ring just gives position
-                              dethit.SetRingNumber(fS3RingHits[i].GetRing());
                               fS3PixelHits.push_back(dethit);
-
-                              // Now we have accepted a good event, build it
-                              TS3Hit dethitB = fS3SectorHits[k];   // Sector now defines all data ring just gives position
-                              dethitB.SetRingNumber(fS3RingHits[i].GetRing());
-                              fS3PixelHits.push_back(dethitB);
                            }
-
-                           UsedRing[i]   = true;
-                           UsedSector[j] = true;
-                           UsedSector[k] = true;
+                        } else {
+                           // 2 separate hits with shared ring
+
+                           // Now we have accepted a good event, build it
+                           TS3Hit dethit = fS3SectorHits[j];   // Sector now defines all data ring just gives position
+                           dethit.SetRingNumber(fS3RingHits[i].GetRing());
+                           fS3PixelHits.push_back(dethit);
+
+                           // Now we have accepted a good event, build it
+                           TS3Hit dethitB = fS3SectorHits[k];   // Sector now defines all data ring just gives position
+                           dethitB.SetRingNumber(fS3RingHits[i].GetRing());
+                           fS3PixelHits.push_back(dethitB);
                         }
+
+                        UsedRing[i]   = true;
+                        UsedSector[j] = true;
+                        UsedSector[k] = true;
                      }
                   }
                }
             }   // End Shared Ring loop
          }
 
-         ringcount   = 0;
-         sectorcount = 0;
-         for(auto&& i : UsedRing) {
-            if(!i) {
-               ringcount++;
+         if(unused(UsedRing) > 1 || unused(UsedSector) > 1) {
+            // the same pairs sorted by sector
+            std::sort(pairs.begin(), pairs.end(), [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) { return a.second < b.second || (a.second == b.second && a.first < b.first); });
+            std::vector<size_t> sectorStart(nofSectors + 1, 0);   // pairs[sectorStart[i], sectorStart[i+1]) have sector i
+            for(const auto& pair : pairs) {
+               ++sectorStart[pair.second + 1];
             }
-         }
+            std::partial_sum(sectorStart.begin(), sectorStart.end(), sectorStart.begin());
 
-         for(auto&& i : UsedSector) {
-            if(!i) {
-               sectorcount++;
-            }
-         }
-
-         if(ringcount > 1 || sectorcount > 1) {
             // Shared Sector loop
-            for(size_t i = 0; i < fS3SectorHits.size(); ++i) {
-               if(UsedSector.at(i)) {
+            for(size_t i = 0; i < nofSectors; ++i) {
+               if(UsedSector[i]) {
                   continue;
                }
-               for(size_t j = 0; j < fS3RingHits.size(); ++j) {
-                  if(UsedRing.at(j)) {
+               for(size_t a = sectorStart[i]; a < sectorStart[i + 1]; ++a) {
+                  size_t j = pairs[a].first;
+                  if(UsedRing[j]) {
                      continue;
                   }
-                  if(fS3SectorHits[i].GetArrayPosition() != fS3RingHits[j].GetArrayPosition()) { continue; }
-
-                  for(size_t k = j + 1; k < fS3RingHits.size(); ++k) {
-                     if(UsedRing.at(k)) {
+                  for(size_t b = a + 1; b < sectorStart[i + 1]; ++b) {
+                     size_t k = pairs[b].first;
+                     if(UsedRing[k]) {
                         continue;
                      }
-                     if(fS3RingHits[j].GetArrayPosition() != fS3RingHits[k].GetArrayPosition()) { continue; }
-
-                     if(abs(fS3SectorHits[i].GetTime() - fS3RingHits[j].GetTime()) * 1.6 < fFrontBackTime &&
-                        abs(fS3SectorHits[i].GetTime() - fS3RingHits[k].GetTime()) * 1.6 < fFrontBackTime) {   // first check time
-                        if((EneS[i] - fFrontBackOffset) * fFrontBackEnergy < (EneR[j] + EneR[k]) &&
-                           (EneR[j] + EneR[k] - fFrontBackOffset) * fFrontBackEnergy < EneS[i]) {   // if time is good check energy
-
-                           if(abs(fS3RingHits[j].GetRing() - fS3RingHits[k].GetRing()) == 1) {
-                              // Same sector and neighbour rings, almost certainly charge sharing
-                              // Experiments with breakup might get real mult2 events like this but most
-                              // will be charge
-                              // sharing
-
-                              if(KeepShared()) {
-                                 TS3Hit dethit = fS3SectorHits[i];   // Sector defines all data ring just gives position
-                                 // Selecting one of the sectors is currently the best class allows, some
-                                 // loss of
-                                 // position information
-                                 if(fS3RingHits[k].GetEnergy() < fS3RingHits[j].GetEnergy()) {
-                                    dethit.SetRingNumber(fS3RingHits[j].GetRing());
-                                 } else {
-                                    dethit.SetRingNumber(fS3RingHits[k].GetRing());
-                                 }
-                                 fS3PixelHits.push_back(dethit);
+                     if((EneS[i] - fFrontBackOffset) * fFrontBackEnergy < (EneR[j] + EneR[k]) &&
+                        (EneR[j] + EneR[k] - fFrontBackOffset) * fFrontBackEnergy < EneS[i]) {   // time is good, check energy
+
+                        if(abs(fS3RingHits[j].GetRing() - fS3RingHits[k].GetRing()) == 1) {
+                           // Same sector and neighbour rings, almost certainly charge sharing
+                           // Experiments with breakup might get real mult2 events like this but most
+                           // will be charge
+                           // sharing
+
+                           if(KeepShared()) {
+                              TS3Hit dethit = fS3SectorHits[i];   // Sector defines all data ring just gives position
+                              // Selecting one of the sectors is currently the best class allows, some
+                              // loss of
+                              // position information
+                              if(EneR[k] < EneR[j]) {
+                                 dethit.SetRingNumber(fS3RingHits[j].GetRing());
+                              } else {
+                                 dethit.SetRingNumber(fS3RingHits[k].GetRing());
                               }
-                           } else {
-                              // 2 separate hits with shared sector
-
-                              // Now we have accepted a good event, build it
-                              TS3Hit dethit = fS3RingHits[j];   // Ring defines all data sector just gives position
-                              dethit.SetSectorNumber(fS3SectorHits[i].GetSector());
                               fS3PixelHits.push_back(dethit);
-
-                              // Now we have accepted a good event, build it
-                              TS3Hit dethitB = fS3RingHits[k];   // Ring defines all data sector just gives position
-                              dethitB.SetSectorNumber(fS3SectorHits[i].GetSector());
-                              fS3PixelHits.push_back(dethitB);
                            }
-
-                           UsedSector[i] = true;
-                           UsedRing[j]   = true;
-                           UsedRing[k]   = true;
+                        } else {
+                           // 2 separate hits with shared sector
+
+                           // Now we have accepted a good event, build it
+                           TS3Hit dethit = fS3RingHits[j];   // Ring defines all data sector just gives position
+                           dethit.SetSectorNumber(fS3SectorHits[i].GetSector());
+                           fS3PixelHits.push_back(dethit);
+
+                           // Now we have accepted a good event, build it
+                           TS3Hit dethitB = fS3RingHits[k];   // Ring defines all data sector just gives position
+                           dethitB.SetSectorNumber(fS3SectorHits[i].GetSector());
+                           fS3PixelHits.push_back(dethitB);
                         }
+
+                        UsedSector[i] = true;
+                        UsedRing[j]   = true;
+                        UsedRing[k]   = true;
                      }
                   }
                }
@@ -330,6 +344,19 @@ TVector3 TS3::GetPosition(int ring, int sector, bool smear)
 }
 
 TVector3 TS3::GetPosition(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream, bool smear)
+{
+   if(smear) {
+      return GetSmearedPosition(ring, sector, offsetphi, offsetZ, sectorsdownstream, TCounterRandom::ThreadLocal());
+   }
+   return Position(ring, sector, offsetphi, offsetZ, sectorsdownstream, nullptr);
+}
+
+TVector3 TS3::GetSmearedPosition(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream, TCounterRandom& random)
+{
+   return Position(ring, sector, offsetphi, offsetZ, sectorsdownstream, &random);
+}
+
+TVector3 TS3::Position(int ring, int sector, double offsetphi, double offsetZ, bool sectorsdownstream, TCounterRandom* random)
 {
 
    double ring_width   = (fOuterDiameter - fInnerDiameter) * 0.5 / fRingNumber;   // 24 rings   radial width!
@@ -349,13 +376,13 @@ TVector3 TS3::GetPosition(int ring, int sector, double offsetphi, double offsetZ
    phi += offsetphi;
 
    //This produces a uniform distribution over the area of a pixel
-   if(smear) {
+   if(random != nullptr) {
       double sep    = ring_width * 0.025;
       double r1     = radius - ring_width * 0.5 + sep;
       double r2     = radius + ring_width * 0.5 - sep;
-      radius        = sqrt(gRandom->Uniform(r1 * r1, r2 * r2));
+      radius        = sqrt(random->Uniform(r1 * r1, r2 * r2));
       double sepphi = sep / radius;
-      phi           = gRandom->Uniform(phi - phi_width * 0.5 + sepphi, phi + phi_width * 0.5 - sepphi);
+      phi           = random->Uniform(phi - phi_width * 0.5 + sepphi, phi + phi_width * 0.5 - sepphi);
    }
 
    return {cos(phi) * radius, sin(phi) * radius, offsetZ};
@@ -3,6 +3,7 @@
 #include "TMath.h"
 
 #include "TS3.h"
+#include "TCounterRandom.h"
 #include "TPulseAnalyzer.h"
 #include "TGRSIMnemonic.h"
 #include "TMnemonic.h"
@@ -76,17 +77,23 @@ Bool_t TS3Hit::SectorsDownstream() const
 
 TVector3 TS3Hit::GetPosition(Double_t phioffset, Double_t dist, bool smear) const
 {
-   return TS3::GetPosition(GetRing(), GetSector(), phioffset, dist, SectorsDownstream(), smear);
+   /// The smearing uses random numbers seeded with the time stamp and address of the hit, so the position of a hit
+   /// is reproducible.
+   if(smear) {
+      TCounterRandom random(GetTimeStamp(), GetAddress(), TCounterRandom::EStream::kPosition);
+      return TS3::GetSmearedPosition(GetRing(), GetSector(), phioffset, dist, SectorsDownstream(), random);
+   }
+   return TS3::GetPosition(GetRing(), GetSector(), phioffset, dist, SectorsDownstream(), false);
 }
 
 TVector3 TS3Hit::GetPosition(Double_t phioffset, bool smear) const
 {
-   return TS3::GetPosition(GetRing(), GetSector(), phioffset, GetDefaultDistance(), SectorsDownstream(), smear);
+   return GetPosition(phioffset, GetDefaultDistance(), smear);
 }
 
 TVector3 TS3Hit::GetPosition(bool smear) const
 {
-   return TS3::GetPosition(GetRing(), GetSector(), GetDefaultPhiOffset(), GetDefaultDistance(), SectorsDownstream(), smear);
+   return GetPosition(GetDefaultPhiOffset(), GetDefaultDistance(), smear);
 }
 
 void TS3Hit::Print(Option_t*) const
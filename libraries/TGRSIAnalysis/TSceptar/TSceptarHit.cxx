@@ -1,4 +1,5 @@
 #include "TSceptarHit.h"
+#include "TWaveformKernels.h"
 
 #include <iostream>
 #include <algorithm>
@@ -100,9 +101,6 @@ bool TSceptarHit::AnalyzeWaveform()
       return false;   // Error!
    }
 
-   std::vector<Int_t>   baselineCorrections(8, 0);
-   std::vector<Short_t> newWaveform(*GetWaveform());
-
    // all timing algorithms use interpolation with this many steps between two samples (all times are stored as
    // integers)
    unsigned int interpolationSteps  = 256;
@@ -111,17 +109,9 @@ bool TSceptarHit::AnalyzeWaveform()
    int          halfsmoothingwindow = 0;   // 2*halfsmoothingwindow + 1 = number of samples in moving window.
 
    // baseline algorithm: correct each adc with average of first two samples in that adc
-   for(size_t i = 0; i < 8 && i < WaveSize(); ++i) {
-      baselineCorrections[i] = GetWaveform()->at(i);
-   }
-   for(size_t i = 8; i < 16 && i < WaveSize(); ++i) {
-      baselineCorrections[i - 8] =
-         ((baselineCorrections[i - 8] + GetWaveform()->at(i)) + ((baselineCorrections[i - 8] + GetWaveform()->at(i)) > 0 ? 1 : -1)) >>
-         1;
-   }
-   for(size_t i = 0; i < WaveSize(); ++i) {
-      newWaveform[i] -= baselineCorrections[i % 8];
-   }
+   thread_local std::vector<Short_t> newWaveform;
+   newWaveform.resize(WaveSize());
+   TWaveformKernels::BaselineCorrect(GetWaveform()->data(), WaveSize(), newWaveform.data());
    SetWaveform(newWaveform);
 
    SetCfd(CalculateCfd(attenuation, delay, halfsmoothingwindow, interpolationSteps));
@@ -129,66 +119,35 @@ bool TSceptarHit::AnalyzeWaveform()
    return !error;
 }
 
-Int_t TSceptarHit::CalculateCfd(double attenuation, unsigned int delay, int halfsmoothingwindow,
-                                unsigned int interpolationSteps)
+Int_t TSceptarHit::CalculateCfd(double attenuation, unsigned int delay, int halfsmoothingwindow, unsigned int interpolationSteps)
 {
    // Used when calculating the CFD from the waveform
-   std::vector<Short_t> monitor;
+   thread_local std::vector<Short_t> monitor;
 
    return CalculateCfdAndMonitor(attenuation, delay, halfsmoothingwindow, interpolationSteps, monitor);
 }
 
-Int_t TSceptarHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfsmoothingwindow,
-                                          unsigned int interpolationSteps, std::vector<Short_t>& monitor)
+Int_t TSceptarHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfsmoothingwindow, unsigned int interpolationSteps, std::vector<Short_t>& monitor)
 {
    // Used when calculating the CFD from the waveform
-
-   Short_t monitormax = 0;
-
-   bool armed = false;
-
-   Int_t cfd = 0;
-
-   std::vector<Short_t> smoothedWaveform;
-
    if(!HasWave()) {
       return INT_MAX;   // Error!
    }
 
-   if(static_cast<unsigned int>(WaveSize()) > delay + 1) {
-
+   Int_t cfd = 0;
+   if(WaveSize() > delay + 1) {
+      const Short_t* waveform = GetWaveform()->data();
+      size_t         size     = WaveSize();
       if(halfsmoothingwindow > 0) {
-         smoothedWaveform = TSceptarHit::CalculateSmoothedWaveform(halfsmoothingwindow);
-      } else {
-         smoothedWaveform = *GetWaveform();
-      }
-
-      monitor.resize(smoothedWaveform.size() - delay);
-      monitor[0] = static_cast<Short_t>(attenuation * smoothedWaveform[delay] - smoothedWaveform[0]);
-      if(monitor[0] > monitormax) {
-         armed      = true;
-         monitormax = monitor[0];
+         thread_local std::vector<Short_t> smoothedWaveform;
+         smoothedWaveform.resize(TWaveformKernels::SmoothedSize(size, halfsmoothingwindow));
+         size     = TWaveformKernels::Smooth(waveform, size, halfsmoothingwindow, smoothedWaveform.data());
+         waveform = smoothedWaveform.data();
       }
 
-      for(unsigned int i = delay + 1; i < smoothedWaveform.size(); ++i) {
-         monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-         if(monitor[i - delay] > monitormax) {
-            armed      = true;
-            monitormax = monitor[i - delay];
-         } else {
-            if(armed && monitor[i - delay] < 0) {
-               armed = false;
-               if(monitor[i - delay - 1] - monitor[i - delay] != 0) {
-                  // Linear interpolation.
-                  cfd = (i - delay - 1) * interpolationSteps +
-                        (monitor[i - delay - 1] * interpolationSteps) / (monitor[i - delay - 1] - monitor[i - delay]);
-               } else {
-                  // Should be impossible, since monitor[i-delay-1] => 0 and monitor[i-delay] > 0
-                  cfd = 0;
-               }
-            }
-         }
-      }
+      monitor.resize(size > delay ? size - delay : 0);
+      TWaveformKernels::CfdMonitor(waveform, size, attenuation, delay, monitor.data());
+      cfd = TWaveformKernels::CfdZeroCrossing(monitor.data(), monitor.size(), interpolationSteps);
    } else {
       monitor.resize(0);
    }
@@ -199,19 +158,12 @@ Int_t TSceptarHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay
 std::vector<Short_t> TSceptarHit::CalculateSmoothedWaveform(unsigned int halfsmoothingwindow)
 {
    // Used when calculating the CFD from the waveform
-
    if(!HasWave()) {
       return {};   // Error!
    }
 
-   std::vector<Short_t> smoothedWaveform(std::max(static_cast<size_t>(0), WaveSize() - 2 * halfsmoothingwindow),
-                                         0);
-
-   for(size_t i = halfsmoothingwindow; i < WaveSize() - halfsmoothingwindow; ++i) {
-      for(int j = -static_cast<int>(halfsmoothingwindow); j <= static_cast<int>(halfsmoothingwindow); ++j) {
-         smoothedWaveform[i - halfsmoothingwindow] += GetWaveform()->at(i + j);
-      }
-   }
+   std::vector<Short_t> smoothedWaveform(TWaveformKernels::SmoothedSize(WaveSize(), halfsmoothingwindow));
+   TWaveformKernels::Smooth(GetWaveform()->data(), WaveSize(), halfsmoothingwindow, smoothedWaveform.data());
 
    return smoothedWaveform;
 }
@@ -219,7 +171,6 @@ std::vector<Short_t> TSceptarHit::CalculateSmoothedWaveform(unsigned int halfsmo
 std::vector<Short_t> TSceptarHit::CalculateCfdMonitor(double attenuation, int delay, int halfsmoothingwindow)
 {
    // Used when calculating the CFD from the waveform
-
    if(!HasWave()) {
       return {};   // Error!
    }
@@ -232,11 +183,8 @@ std::vector<Short_t> TSceptarHit::CalculateCfdMonitor(double attenuation, int de
       smoothedWaveform = *GetWaveform();
    }
 
-   std::vector<Short_t> monitor(std::max(static_cast<size_t>(0), smoothedWaveform.size() - delay), 0);
-
-   for(size_t i = delay; i < smoothedWaveform.size(); ++i) {
-      monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-   }
+   std::vector<Short_t> monitor(smoothedWaveform.size() > static_cast<size_t>(delay) ? smoothedWaveform.size() - delay : 0);
+   TWaveformKernels::CfdMonitor(smoothedWaveform.data(), smoothedWaveform.size(), attenuation, delay, monitor.data());
 
    return monitor;
 }
@@ -34,6 +34,9 @@ double TSharc::fXoffset = +0.00;   //
 double TSharc::fYoffset = +0.00;   //
 double TSharc::fZoffset = +0.00;   //
 
+double TSharc::fFrontBackEnergy = 0.;
+double TSharc::fFrontBackTime   = 0.;
+
 double TSharc::fXdim   = +72.0;   // total X dimension of all boxes
 double TSharc::fYdim   = +72.0;   // total Y dimension of all boxes
 double TSharc::fZdim   = +48.0;   // total Z dimension of all boxes
@@ -91,13 +94,13 @@ void TSharc::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel*
    switch(chan->GetMnemonic()->ArraySubPosition()) {
    case TMnemonic::EMnemonic::kD:
       if(chan->GetMnemonic()->CollectedCharge() == TMnemonic::EMnemonic::kP) {
-         fFrontFragments.push_back(*frag);
+         fBuilder.AddFront(frag);
       } else {
-         fBackFragments.push_back(*frag);
+         fBuilder.AddBack(frag);
       }
       break;
    case TMnemonic::EMnemonic::kE:
-      fPadFragments.push_back(*frag);
+      fBuilder.AddPad(frag);
       break;
    default:
       break;
@@ -106,41 +109,8 @@ void TSharc::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel*
 
 void TSharc::BuildHits()
 {
-   std::vector<TFragment>::iterator front;
-   std::vector<TFragment>::iterator back;
-   std::vector<TFragment>::iterator pad;
-
-   for(front = fFrontFragments.begin(); front != fFrontFragments.end();) {
-      bool front_used = false;
-      bool back_used  = false;
-      for(back = fBackFragments.begin(); back != fBackFragments.end(); back++) {
-         if(front->GetDetector() == back->GetDetector()) {
-            front_used = true;
-            back_used  = true;
-            break;
-         }
-      }
-      if(front_used && back_used) {
-         auto* hit = new TSharcHit;
-         hit->SetFront(*front);
-         hit->SetBack(*back);
-         AddHit(hit);
-         front = fFrontFragments.erase(front);
-         back  = fBackFragments.erase(back);
-      } else {
-         front++;
-      }
-   }
-
-   for(auto& fSharcHit : Hits()) {
-      for(pad = fPadFragments.begin(); pad != fPadFragments.end(); pad++) {
-         if(fSharcHit->GetDetector() == pad->GetDetector()) {
-            static_cast<TSharcHit*>(fSharcHit)->SetPad(*pad);
-            pad = fPadFragments.erase(pad);
-            break;
-         }
-      }
-   }
+   /// Each front is combined with a back (and a pad) of the same detector, see TSharcHitBuilder.
+   fBuilder.Build(fFrontBackEnergy, fFrontBackTime, [this](TSharcHit* hit) { AddHit(hit); });
 }
 
 void TSharc::RemoveHits(std::vector<TSharcHit>* hits, std::set<int>* to_remove)
@@ -157,9 +127,7 @@ void TSharc::Clear(Option_t* option)
 {
    TDetector::Clear(option);
 
-   fFrontFragments.clear();   //!
-   fBackFragments.clear();    //!
-   fPadFragments.clear();     //!
+   fBuilder.Clear();
 
    if(strcmp(option, "ALL") == 0) {
       fXoffset = 0.00;
@@ -8,6 +8,8 @@
 #include "TClass.h"
 #include "TMath.h"
 
+#include "TCounterRandom.h"
+
 //==========================================================================//
 //==========================================================================//
 //==========================================================================//
@@ -21,6 +23,9 @@ double TSharc2::fXoffset = +0.00;   //
 double TSharc2::fYoffset = +0.00;   //
 double TSharc2::fZoffset = +0.00;   //
 
+double TSharc2::fFrontBackEnergy = 0.;
+double TSharc2::fFrontBackTime   = 0.;
+
 //UBOX details
 double TSharc2::fXdim   = +72.0;   // total X dimension of all boxes
 double TSharc2::fYdim   = +72.0;   // total Y dimension of all boxes
@@ -76,9 +81,9 @@ void TSharc2::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel
    switch(chan->GetMnemonic()->ArraySubPosition()) {
    case TMnemonic::EMnemonic::kD:
       if(chan->GetMnemonic()->CollectedCharge() == TMnemonic::EMnemonic::kP) {
-         fFrontFragments.push_back(*frag);
+         fBuilder.AddFront(frag);
       } else {
-         fBackFragments.push_back(*frag);
+         fBuilder.AddBack(frag);
       }
       break;
    default:
@@ -88,31 +93,8 @@ void TSharc2::AddFragment(const std::shared_ptr<const TFragment>& frag, TChannel
 
 void TSharc2::BuildHits()
 {
-   std::vector<TFragment>::iterator front;
-   std::vector<TFragment>::iterator back;
-   std::vector<TFragment>::iterator pad;
-
-   for(front = fFrontFragments.begin(); front != fFrontFragments.end();) {
-      bool front_used = false;
-      bool back_used  = false;
-      for(back = fBackFragments.begin(); back != fBackFragments.end(); back++) {
-         if(front->GetDetector() == back->GetDetector()) {
-            front_used = true;
-            back_used  = true;
-            break;
-         }
-      }
-      if(front_used && back_used) {
-         auto* hit = new TSharc2Hit;
-         hit->SetFront(*front);
-         hit->SetBack(*back);
-         AddHit(hit);
-         front = fFrontFragments.erase(front);
-         back  = fBackFragments.erase(back);
-      } else {
-         front++;
-      }
-   }
+   /// Each front is combined with a back of the same detector, see TSharcHitBuilder.
+   fBuilder.Build(fFrontBackEnergy, fFrontBackTime, [this](TSharc2Hit* hit) { AddHit(hit); });
 }
 
 void TSharc2::RemoveHits(std::vector<TSharc2Hit>* hits, std::set<int>* to_remove)
@@ -129,8 +111,7 @@ void TSharc2::Clear(Option_t* option)
 {
    TDetector::Clear(option);
 
-   fFrontFragments.clear();   //!
-   fBackFragments.clear();    //!
+   fBuilder.Clear();
 
    if(strcmp(option, "ALL") == 0) {
       fXoffset = 0.00;
@@ -188,14 +169,14 @@ TVector3 TSharc2::GetPosition(int detector, int frontstrip, int backstrip, doubl
       double y = 0;                                              //we start this with the hit oriented at beam left (+x,y=0). Will rotate afterwards
       double z = fZposDS2;
       position.SetXYZ(x, y, z);
-      position.RotateZ(fSectorWidthDS2 * nrots + (fSectorWidthDS2 * gRandom->Uniform(-1, 1)));   //the addition does randomization over the sector width
+      position.RotateZ(fSectorWidthDS2 * nrots + (fSectorWidthDS2 * TCounterRandom::ThreadLocal().Uniform(-1, 1)));   //the addition does randomization over the sector width
    } else if(FrontDet == 16) {                                                                   // backward (upstream) compact S2
       nrots    = (BackStr - 15) + 0.5;                                                           //sector 15 is the sector just clockwise from (+x,y=0). We remove that number to get the nrots needed. We add 0.5 to rotate to the middle of the sector too
       double x = fXminUS2 + fStripPitchUS2 * (FrontStr + 0.5);                                   //Counting from the inside radius to the outside radius. Add 0.5 to center in the middle of the ring.
       double y = 0;                                                                              //we start this with the hit oriented at beam left (+x,y=0). Will rotate afterwards
       double z = -1 * fZposUS2;                                                                  //minus because we are upstream of the reaction target
       position.SetXYZ(x, y, z);
-      position.RotateZ(-1 * fSectorWidthUS2 * nrots + (fSectorWidthUS2 * gRandom->Uniform(-1, 1)));   //we multiply this one by -1 because the upstream cS2 needs to be rotated the opposite direction. Both cS2 detectors are rotated CW relative to beam, but they are mounted opposite
+      position.RotateZ(-1 * fSectorWidthUS2 * nrots + (fSectorWidthUS2 * TCounterRandom::ThreadLocal().Uniform(-1, 1)));   //we multiply this one by -1 because the upstream cS2 needs to be rotated the opposite direction. Both cS2 detectors are rotated CW relative to beam, but they are mounted opposite
    }
 
    return (position + position_offset);
@@ -1,5 +1,7 @@
 #include "TSiLi.h"
 
+#include "TCounterRandom.h"
+
 // Having these in Clear() caused issues as functions can be called abstract with out initialising a TSiLi
 int    TSiLi::fRingNumber     = 10;
 int    TSiLi::fSectorNumber   = 12;
@@ -18,6 +20,7 @@ double TSiLi::fSiLiCoincidenceTime     = 200;
 bool   TSiLi::fRejectPossibleCrosstalk = false;
 
 int TSiLi::fFitSiLiShape = 0;   // 0 no. 1 try if normal fit fail. 2 yes
+bool TSiLi::fSiLiTemplateFit = false;
 
 TSiLi::TSiLi()
 {
@@ -85,12 +88,13 @@ TVector3 TSiLi::GetPosition(int ring, int sector, bool smear)
    phi += fOffsetPhi;
    double radius = inner_radius + ring_width * (ring + 0.5);
    if(smear) {
-      double sep    = ring_width * 0.025;
-      double r1     = radius - ring_width * 0.5 + sep;
-      double r2     = radius + ring_width * 0.5 - sep;
-      radius        = sqrt(gRandom->Uniform(r1 * r1, r2 * r2));
-      double sepphi = sep / radius;
-      phi           = gRandom->Uniform(phi - phi_width * 0.5 + sepphi, phi + phi_width * 0.5 - sepphi);
+      TCounterRandom& random = TCounterRandom::ThreadLocal();
+      double          sep    = ring_width * 0.025;
+      double          r1     = radius - ring_width * 0.5 + sep;
+      double          r2     = radius + ring_width * 0.5 - sep;
+      radius                 = sqrt(random.Uniform(r1 * r1, r2 * r2));
+      double sepphi          = sep / radius;
+      phi                    = random.Uniform(phi - phi_width * 0.5 + sepphi, phi + phi_width * 0.5 - sepphi);
    }
 
    return {cos(phi) * radius, sin(phi) * radius, dist};
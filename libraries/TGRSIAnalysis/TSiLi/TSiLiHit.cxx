@@ -1,5 +1,6 @@
 #include "TSiLi.h"
 #include "TSiLiHit.h"
+#include "TSiLiShapeFitter.h"
 
 TSiLiHit::TSiLiHit()
 {
@@ -29,6 +30,9 @@ void TSiLiHit::Copy(TObject& rhs, bool suppress) const
    static_cast<TSiLiHit&>(rhs).fFitCharge   = fFitCharge;
    static_cast<TSiLiHit&>(rhs).fFitBase     = fFitBase;
    static_cast<TSiLiHit&>(rhs).fSiLiHitBits = 0;
+
+   static_cast<TSiLiHit&>(rhs).fTemplateSig2Noise = fTemplateSig2Noise;
+   static_cast<TSiLiHit&>(rhs).fTemplateSmirnov   = fTemplateSmirnov;
    if(!suppress) {
       static_cast<TSiLiHit&>(rhs).fAddBackSegments = fAddBackSegments;
       static_cast<TSiLiHit&>(rhs).fAddBackEnergy   = fAddBackEnergy;
@@ -45,6 +49,9 @@ void TSiLiHit::Clear(Option_t* opt)
    fSig2Noise = -1;
    fSmirnov   = -1;
 
+   fTemplateSig2Noise = -1;
+   fTemplateSmirnov   = -1;
+
    fAddBackSegments.clear();
    fAddBackEnergy.clear();
    fSiLiHitBits.Clear();
@@ -53,15 +60,57 @@ void TSiLiHit::Clear(Option_t* opt)
 
 void TSiLiHit::SetWavefit(const TFragment& frag)
 {
-   TPulseAnalyzer* pulse = FitFrag(frag, TSiLi::fFitSiLiShape, GetChannel());
-   if(pulse != nullptr) {
-      fTimeFit   = pulse->Get_wpar_T0();
-      fFitBase   = pulse->Get_wpar_baselinefin();
-      fFitCharge = pulse->Get_wpar_amplitude();
-      fSig2Noise = pulse->get_sig2noise();
-      fSmirnov   = pulse->GetsiliSmirnov();
-      delete pulse;
+   int shapeFit = TSiLi::fFitSiLiShape;
+   if(TSiLi::fSiLiTemplateFit && (shapeFit == 1 || shapeFit == 2)) {
+      // the template fit replaces the TF1 fit, for 1 only if the quick method fails
+      // if the template fit fails as well (e.g. too short a waveform) we still try the TF1 fit
+      if(shapeFit == 2 || !SetWavefit(FitFrag(frag, 0, GetChannel()))) {
+         if(!SetTemplateWavefit(frag)) {
+            SetWavefit(FitFrag(frag, 2, GetChannel()));
+         }
+      }
+      return;
+   }
+   SetWavefit(FitFrag(frag, shapeFit, GetChannel()));
+}
+
+bool TSiLiHit::SetWavefit(TPulseAnalyzer* pulse)
+{
+   if(pulse == nullptr) {
+      return false;
+   }
+   fTimeFit   = pulse->Get_wpar_T0();
+   fFitBase   = pulse->Get_wpar_baselinefin();
+   fFitCharge = pulse->Get_wpar_amplitude();
+   fSig2Noise = pulse->get_sig2noise();
+   fSmirnov   = pulse->GetsiliSmirnov();
+   delete pulse;
+   return true;
+}
+
+bool TSiLiHit::SetTemplateWavefit(const TFragment& frag)
+{
+   /// Fits the SiLi shape with TSiLiShapeFitter, which doesn't allocate anything per hit. The signal-to-noise and
+   /// Smirnov values are defined differently from TPulseAnalyzer, so they go into their own members.
+   if(!frag.HasWave()) {
+      return false;
+   }
+   double decay = 0.;
+   double rise  = 0.;
+   double base  = 0.;
+   GetShapeParameters(GetChannel(), decay, rise, base);
+
+   thread_local TSiLiShapeFitter fitter;
+   auto                          result = fitter.Fit(frag.GetWaveform()->data(), frag.GetWaveform()->size(), decay, rise);
+   if(!result.fGood) {
+      return false;
    }
+   fTimeFit           = result.fT0;
+   fFitBase           = result.fBaseline;
+   fFitCharge         = result.fAmplitude;
+   fTemplateSig2Noise = result.fSig2Noise;
+   fTemplateSmirnov   = result.fSmirnov;
+   return true;
 }
 
 // Broken up for external analysis script use
@@ -100,19 +149,7 @@ int TSiLiHit::FitPulseAnalyzer(TPulseAnalyzer* pulse, int ShapeFit, TChannel* ch
       double Decay = 0.;
       double Rise  = 0.;
       double Base  = 0.;
-
-      if(channel != nullptr) {
-         if(channel->UseWaveParam()) {
-            Rise  = channel->GetWaveRise();
-            Decay = channel->GetWaveDecay();
-            Base  = channel->GetWaveBaseLine();
-         }
-      }
-      // 		std::cout<<std::endl<<Decay<<" "<<Rise<<" "<<Base;
-
-      if(Decay == 0.) { Decay = TSiLi::fSiLiDefaultDecay; }
-      if(Rise == 0.) { Rise = TSiLi::fSiLiDefaultRise; }
-      if(Base == 0.) { Base = TSiLi::fSiLiDefaultBaseline; }
+      GetShapeParameters(channel, Decay, Rise, Base);
 
       bool goodfit = false;
       if(ShapeFit < 2) { goodfit = pulse->GetSiliShape(Decay, Rise); }
@@ -124,6 +161,24 @@ int TSiLiHit::FitPulseAnalyzer(TPulseAnalyzer* pulse, int ShapeFit, TChannel* ch
    return 0;
 }
 
+void TSiLiHit::GetShapeParameters(TChannel* channel, double& decay, double& rise, double& base)
+{
+   decay = 0.;
+   rise  = 0.;
+   base  = 0.;
+   if(channel != nullptr) {
+      if(channel->UseWaveParam()) {
+         rise  = channel->GetWaveRise();
+         decay = channel->GetWaveDecay();
+         base  = channel->GetWaveBaseLine();
+      }
+   }
+
+   if(decay == 0.) { decay = TSiLi::fSiLiDefaultDecay; }
+   if(rise == 0.) { rise = TSiLi::fSiLiDefaultRise; }
+   if(base == 0.) { base = TSiLi::fSiLiDefaultBaseline; }
+}
+
 TVector3 TSiLiHit::GetPosition(Double_t, bool smear) const
 {
    return TSiLi::GetPosition(GetRing(), GetSector(), smear);
@@ -3,12 +3,14 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 #include "TInterpreter.h"
 #include "TMnemonic.h"
 #include "TDetectorHit.h"
 #include "TGRSIOptions.h"
 #include "TSortingDiagnostics.h"
+#include "TWaveformBatch.h"
 
 ////////////////////////////////////////////////////////////
 //
@@ -46,6 +48,7 @@ TTransientBits<uint8_t> TTigress::fGlobalTigressBits = TTransientBits<uint8_t>(s
 TTigress::TTigress()
 {
    /// Default ctor. Ignores TObjectStreamer in ROOT < 6
+   ClearCrystalHits();
    Clear();
 }
 
@@ -77,6 +80,8 @@ void TTigress::Copy(TObject& rhs) const
    static_cast<TTigress&>(rhs).fSuppressedHits.clear();
    static_cast<TTigress&>(rhs).fSuppressedAddbackHits.clear();
    static_cast<TTigress&>(rhs).fSuppressedAddbackFrags.clear();
+   // the hits are copied in the same order, so the indices stay valid
+   static_cast<TTigress&>(rhs).fCrystalHitIndex = fCrystalHitIndex;
 }
 
 TTigress::~TTigress()
@@ -114,6 +119,7 @@ void TTigress::Clear(Option_t* opt)
    fSuppressedHits.clear();
    fSuppressedAddbackHits.clear();
    fSuppressedAddbackFrags.clear();
+   ClearCrystalHits();
 }
 
 void TTigress::Print(Option_t*) const
@@ -230,16 +236,27 @@ void TTigress::BuildHits()
    // using remove_if the elements to be removed are left in an undefined state so we can only log how many we are removing!
    TSortingDiagnostics::Get()->RemovedHits(IsA(), std::distance(remove, Hits().end()), Hits().size());
    Hits().erase(remove, Hits().end());
+   const bool                waveformFitting = TGRSIOptions::AnalysisOptions()->IsWaveformFitting();
+   std::vector<TTigressHit*> fitHits;
    for(auto& hit : Hits()) {
       auto* tigressHit = static_cast<TTigressHit*>(hit);
       if(tigressHit->GetNSegments() > 1) {
          tigressHit->SortSegments();
       }
 
-      if(tigressHit->HasWave() && TGRSIOptions::AnalysisOptions()->IsWaveformFitting()) {
-         tigressHit->SetWavefit();
+      if(waveformFitting && tigressHit->HasWave()) {
+         fitHits.push_back(tigressHit);
       }
    }
+   // the waveform fits are by far the most expensive part, so they are done in one batch spread over the waveform
+   // analysis pool (which has no extra threads unless the user asks for them)
+   // ForEach only returns once all fits are done, so the hits are complete (and in the same order) afterwards
+   // running the fits in parallel is safe: SetWavefit only writes to its own hit, and TPulseAnalyzer only works on its
+   // own copy of the waveform (fit_newT0 solves its linear equations itself, without any TF1, gROOT, or static state),
+   // the only shared state is TChannel (via GetName), which is only read
+   if(!fitHits.empty()) {
+      WaveformAnalysisPool().ForEach(fitHits.size(), [&fitHits](size_t i) { fitHits[i]->SetWavefit(); });
+   }
    std::sort(Hits().begin(), Hits().end());   // sorting an empty vector is fine, no need to check for that
 }
 
@@ -263,36 +280,33 @@ void TTigress::AddFragment(const std::shared_ptr<const TFragment>& frag, TChanne
 
    // check whether we have a core (0 or 9) or a segment (any other number)
    if(chan->GetSegmentNumber() == 0 || chan->GetSegmentNumber() == 9) {
-      // loop over existing hits to see if this core was already created by a previously found segment
+      // check if this core was already created by a previously found segment
       // of course this means if we have a core in "coincidence" with itself we will overwrite the first hit
-      for(Short_t i = 0; i < GetMultiplicity(); ++i) {
-         TTigressHit* hit = GetTigressHit(i);
-         if((hit->GetDetector() == chan->GetDetectorNumber()) &&
-            (hit->GetCrystal() == chan->GetCrystalNumber())) {   // we have a match;
-
-            // B cores will not replace A cores, but they will replace no-core hits created if segments are processed first.
-            if(chan->GetMnemonic()->OutputSensor() == TMnemonic::EMnemonic::kB) {
-               TChannel* channel = hit->GetChannel();
-               if(channel != nullptr && channel->GetMnemonic()->OutputSensor() == TMnemonic::EMnemonic::kA) {
-                  return;
-               }
+      TTigressHit* hit = FindCrystalHit(chan->GetDetectorNumber(), chan->GetCrystalNumber());
+      if(hit != nullptr) {
+         // B cores will not replace A cores, but they will replace no-core hits created if segments are processed first.
+         if(chan->GetMnemonic()->OutputSensor() == TMnemonic::EMnemonic::kB) {
+            TChannel* channel = hit->GetChannel();
+            if(channel != nullptr && channel->GetMnemonic()->OutputSensor() == TMnemonic::EMnemonic::kA) {
+               return;
             }
+         }
 
-            hit->CopyFragment(*frag);
-            hit->CoreSet(true);
-            if(TestGlobalBit(ETigressGlobalBits::kSetCoreWave)) {
-               frag->CopyWave(*hit);
-            }
-            return;
+         hit->CopyFragment(*frag);
+         hit->CoreSet(true);
+         if(TestGlobalBit(ETigressGlobalBits::kSetCoreWave)) {
+            frag->CopyWave(*hit);
          }
+         return;
       }
       // we haven't found this crystal in the existing hits, so we create a new one
-      auto* hit = new TTigressHit(*frag);
+      hit = new TTigressHit(*frag);
       hit->CoreSet(true);
       if(TestGlobalBit(ETigressGlobalBits::kSetCoreWave)) {
          frag->CopyWave(*hit);
       }
       AddHit(hit);
+      SetCrystalHit(chan->GetDetectorNumber(), chan->GetCrystalNumber());
       return;
    } else {
       // create a temporary segment hit (with waveform if requested)
@@ -301,19 +315,17 @@ void TTigress::AddFragment(const std::shared_ptr<const TFragment>& frag, TChanne
          frag->CopyWave(temp);
       }
       // check if the crystal this segment belongs to already exists
-      for(Short_t i = 0; i < GetMultiplicity(); ++i) {
-         TTigressHit* hit = GetTigressHit(i);
-         if((hit->GetDetector() == chan->GetDetectorNumber()) &&
-            (hit->GetCrystal() == chan->GetCrystalNumber())) {   // we have a match;
-            hit->AddSegment(temp);
-            return;
-         }
+      TTigressHit* hit = FindCrystalHit(chan->GetDetectorNumber(), chan->GetCrystalNumber());
+      if(hit != nullptr) {
+         hit->AddSegment(temp);
+         return;
       }
       // haven't found matching crystal, so we create a new core hit with a fake address
       auto* corehit = new TTigressHit;
       corehit->SetAddress(frag->GetAddress());   // fake it till you make it
       corehit->AddSegment(temp);
       AddHit(corehit);
+      SetCrystalHit(chan->GetDetectorNumber(), chan->GetCrystalNumber());
       return;
    }
 
@@ -321,6 +333,43 @@ void TTigress::AddFragment(const std::shared_ptr<const TFragment>& frag, TChanne
    frag->Print();
 }
 
+TTigressHit* TTigress::FindCrystalHit(int detector, int crystal)
+{
+   /// Returns the hit of this detector and crystal, or a null pointer if AddFragment hasn't created it yet. Detectors
+   /// and crystals outside of the index table are searched for in the hit vector.
+   /// This does not use GetTigressHit, as the cross-talk corrections should only be applied once the event is complete.
+   auto& hits = Hits();
+   if(detector < 0 || detector >= static_cast<int>(fCrystalHitIndex.size()) || crystal < 0 || crystal >= static_cast<int>(fCrystalHitIndex[0].size())) {
+      for(auto* hit : hits) {
+         if(hit->GetDetector() == detector && hit->GetCrystal() == crystal) {
+            return static_cast<TTigressHit*>(hit);
+         }
+      }
+      return nullptr;
+   }
+   int16_t index = fCrystalHitIndex[detector][crystal];
+   if(index < 0 || static_cast<size_t>(index) >= hits.size()) {
+      return nullptr;
+   }
+   return static_cast<TTigressHit*>(hits[index]);
+}
+
+void TTigress::SetCrystalHit(int detector, int crystal)
+{
+   /// Stores the last hit of the hit vector as the hit of this detector and crystal.
+   if(detector < 0 || detector >= static_cast<int>(fCrystalHitIndex.size()) || crystal < 0 || crystal >= static_cast<int>(fCrystalHitIndex[0].size())) {
+      return;
+   }
+   fCrystalHitIndex[detector][crystal] = static_cast<int16_t>(Hits().size() - 1);
+}
+
+void TTigress::ClearCrystalHits()
+{
+   for(auto& detector : fCrystalHitIndex) {
+      detector.fill(-1);
+   }
+}
+
 void TTigress::ResetFlags() const
 {
    fTigressBits = 0;
@@ -556,32 +605,52 @@ UShort_t TTigress::GetNSuppressedAddbackFrags(const size_t& idx)
 
 TVector3 TTigress::GetPosition(const TTigressHit* hit, double dist, bool smear)
 {
-   return GetPosition(hit->GetDetector(), hit->GetCrystal(), hit->GetFirstSegment(), dist, smear);
+   /// The smearing uses random numbers seeded with the time stamp and address of the hit, so the position of a hit
+   /// is reproducible.
+   if(smear) {
+      TCounterRandom random(hit->GetTimeStamp(), hit->GetAddress(), TCounterRandom::EStream::kPosition);
+      return GetSmearedPosition(hit->GetDetector(), hit->GetCrystal(), hit->GetFirstSegment(), dist, random);
+   }
+   return GetPosition(hit->GetDetector(), hit->GetCrystal(), hit->GetFirstSegment(), dist, false);
 }
 
 TVector3 TTigress::GetPosition(int DetNbr, int CryNbr, int SegNbr, double dist, bool smear)
 {
+   if(smear) {
+      return GetSmearedPosition(DetNbr, CryNbr, SegNbr, dist, TCounterRandom::ThreadLocal());
+   }
+
    if(!TestGlobalBit(ETigressGlobalBits::kVectorsBuilt)) { BuildVectors(); }
 
-   // 0 - forward position, 1 - backward position
-   int position = 0;
-   if(dist > 0) {
-      if(dist > 140.) { position = 1; }
-   } else if(TestGlobalBit(ETigressGlobalBits::kArrayBackPos)) {
-      position = 1;
-   }
+   return fPositionVectors[PositionIndex(dist)][DetNbr][CryNbr][SegNbr];
+}
+
+TVector3 TTigress::GetSmearedPosition(int DetNbr, int CryNbr, int SegNbr, double dist, TCounterRandom& random)
+{
+   /// Core positions are smeared uniformly over a disk with a radius of 20 mm perpendicular to the clover.
+   if(!TestGlobalBit(ETigressGlobalBits::kVectorsBuilt)) { BuildVectors(); }
 
-   if(smear && SegNbr == 0) {
+   int position = PositionIndex(dist);
+   if(SegNbr == 0) {
       double x = 0.;
       double y = 0.;
-      double r = sqrt(gRandom->Uniform(0, 400));
-      gRandom->Circle(x, y, r);
+      double r = sqrt(random.Uniform(0, 400));
+      random.Circle(x, y, r);
       return fPositionVectors[position][DetNbr][CryNbr][SegNbr] + fCloverCross[DetNbr][0] * x + fCloverCross[DetNbr][1] * y;
    }
 
    return fPositionVectors[position][DetNbr][CryNbr][SegNbr];
 }
 
+int TTigress::PositionIndex(double dist)
+{
+   /// 0 - forward position, 1 - backward position
+   if(dist > 0) {
+      return (dist > 140.) ? 1 : 0;
+   }
+   return TestGlobalBit(ETigressGlobalBits::kArrayBackPos) ? 1 : 0;
+}
+
 void TTigress::BuildVectors()
 {
    for(int position = 0; position < 2; position++) {
@@ -660,11 +729,45 @@ void TTigress::BuildVectors()
       fCloverCross[DetNbr][1] = b.Unit();
    }
 
+   for(int position = 0; position < 2; position++) {
+      fDopplerTables[position].Resize(17 * 4 * 9);
+      for(int DetNbr = 0; DetNbr < 17; DetNbr++) {
+         for(int CryNbr = 0; CryNbr < 4; CryNbr++) {
+            for(int SegNbr = 0; SegNbr < 9; SegNbr++) {
+               fDopplerTables[position].Set((DetNbr * 4 + CryNbr) * 9 + SegNbr, fPositionVectors[position][DetNbr][CryNbr][SegNbr]);
+            }
+         }
+      }
+   }
+
    SetGlobalBit(ETigressGlobalBits::kVectorsBuilt, true);
 }
 
+void TTigress::GetDopplerEnergies(size_t n, const int* detector, const int* crystal, const int* segment, const double* energy, const TVector3& beta, double* corrected, double dist)
+{
+   /// The hits are processed in chunks, first the index into the Doppler table is calculated for all hits of a chunk, then
+   /// all of them are corrected in one go. Hits with an invalid detector, crystal, or segment are only corrected for the
+   /// time dilation.
+   if(!TestGlobalBit(ETigressGlobalBits::kVectorsBuilt)) { BuildVectors(); }
+
+   const TDopplerTable&     table = fDopplerTables[PositionIndex(dist)];
+   std::array<int32_t, 256> index;
+   for(size_t first = 0; first < n; first += index.size()) {
+      size_t chunk = std::min(n - first, index.size());
+      for(size_t i = 0; i < chunk; ++i) {
+         int  det   = detector[first + i];
+         int  cry   = crystal[first + i];
+         int  seg   = segment[first + i];
+         bool valid = det >= 0 && det < 17 && cry >= 0 && cry < 4 && seg >= 0 && seg < 9;
+         index[i]   = valid ? (det * 4 + cry) * 9 + seg : table.InvalidIndex();
+      }
+      table.Correct(chunk, index.data(), energy + first, beta, corrected + first);
+   }
+}
+
 std::array<std::array<std::array<std::array<TVector3, 9>, 4>, 17>, 2> TTigress::fPositionVectors;
 std::array<std::array<TVector3, 2>, 17>                               TTigress::fCloverCross;
+std::array<TDopplerTable, 2>                                          TTigress::fDopplerTables;
 
 std::array<TVector3, 17> TTigress::fCloverRadial = {TVector3(0., 0., 0.),
                                                     TVector3(0.9239, 0.3827, 1.),
@@ -231,6 +231,7 @@ void TTigressHit::SetWavefit(const TFragment& frag)
 
 void TTigressHit::SetWavefit()
 {
+   /// Only changes this hit, so the fits of different hits can run in parallel (see TTigress::BuildHits).
    TPulseAnalyzer pulse(*GetWaveform(), 0, GetName());
    if(pulse.IsSet()) {
       fTimeFit   = static_cast<Float_t>(pulse.fit_newT0());
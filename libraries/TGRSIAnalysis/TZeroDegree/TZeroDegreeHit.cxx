@@ -1,10 +1,12 @@
 #include "TZeroDegreeHit.h"
+#include "TWaveformKernels.h"
 
 #include <iostream>
 #include <algorithm>
 #include <climits>
 
 #include "TGRSIOptions.h"
+#include "TCounterRandom.h"
 
 TZeroDegreeHit::TZeroDegreeHit()
 {
@@ -65,7 +67,7 @@ Float_t TZeroDegreeHit::GetCfd() const
 {
    /// special function for TZeroDegreeHit to return CFD after mapping out the high bits
    /// which are the remainder between the 125 MHz data and the 100 MHz timestamp clock
-   return static_cast<Float_t>(static_cast<Int_t>(TDetectorHit::GetCfd()) & 0x3fffff) + static_cast<Float_t>(gRandom->Uniform());
+   return static_cast<Float_t>(static_cast<Int_t>(TDetectorHit::GetCfd()) & 0x3fffff) + static_cast<Float_t>(TCounterRandom(GetTimeStamp(), GetAddress(), TCounterRandom::EStream::kCfd).Uniform());
 }
 
 Int_t TZeroDegreeHit::GetRemainder() const
@@ -109,9 +111,6 @@ bool TZeroDegreeHit::AnalyzeWaveform()
       return false;   // Error!
    }
 
-   std::vector<Int_t>   baselineCorrections(8, 0);
-   std::vector<Short_t> newWaveform(*GetWaveform());
-
    // all timing algorithms use interpolation with this many steps between two samples (all times are stored as
    // integers)
    unsigned int interpolationSteps  = 256;
@@ -120,84 +119,52 @@ bool TZeroDegreeHit::AnalyzeWaveform()
    int          halfsmoothingwindow = 0;   // 2*halfsmoothingwindow + 1 = number of samples in moving window.
 
    // baseline algorithm: correct each adc with average of first two samples in that adc
-   for(size_t i = 0; i < 8 && i < WaveSize(); ++i) {
-      baselineCorrections[i] = GetWaveform()->at(i);
-   }
-   for(size_t i = 8; i < 16 && i < WaveSize(); ++i) {
-      baselineCorrections[i - 8] = ((baselineCorrections[i - 8] + GetWaveform()->at(i)) + ((baselineCorrections[i - 8] + GetWaveform()->at(i)) > 0 ? 1 : -1)) >> 1;
-   }
-   for(size_t i = 0; i < WaveSize(); ++i) {
-      newWaveform[i] -= baselineCorrections[i % 8];
-   }
+   thread_local std::vector<Short_t> newWaveform;
+   newWaveform.resize(WaveSize());
+   TWaveformKernels::BaselineCorrect(GetWaveform()->data(), WaveSize(), newWaveform.data());
    SetWaveform(newWaveform);
 
    SetCfd(CalculateCfd(attenuation, delay, halfsmoothingwindow, interpolationSteps));
 
-   SetCharge(CalculatePartialSum().back());
+   // the charge is the sum of all samples, the partial sums are only needed when debugging
+   if(TGRSIOptions::Get()->Debug()) {
+      SetCharge(CalculatePartialSum().back());
+   } else {
+      SetCharge(TWaveformKernels::Sum(GetWaveform()->data(), WaveSize()));
+   }
 
    return !error;
 }
 
-Int_t TZeroDegreeHit::CalculateCfd(double attenuation, unsigned int delay, int halfsmoothingwindow,
-                                   unsigned int interpolationSteps)
+Int_t TZeroDegreeHit::CalculateCfd(double attenuation, unsigned int delay, int halfsmoothingwindow, unsigned int interpolationSteps)
 {
    /// Used when calculating the CFD from the waveform
-   std::vector<Short_t> monitor;
+   thread_local std::vector<Short_t> monitor;
 
    return CalculateCfdAndMonitor(attenuation, delay, halfsmoothingwindow, interpolationSteps, monitor);
 }
 
-Int_t TZeroDegreeHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfsmoothingwindow,
-                                             unsigned int interpolationSteps, std::vector<Short_t>& monitor)
+Int_t TZeroDegreeHit::CalculateCfdAndMonitor(double attenuation, unsigned int delay, int halfsmoothingwindow, unsigned int interpolationSteps, std::vector<Short_t>& monitor)
 {
    /// Used when calculating the CFD from the waveform
-
-   Short_t monitormax = 0;
-
-   bool armed = false;
-
-   Int_t cfd = 0;
-
-   std::vector<Short_t> smoothedWaveform;
-
    if(!HasWave()) {
       return INT_MAX;   // Error!
    }
 
-   if(static_cast<unsigned int>(WaveSize()) > delay + 1) {
-
+   Int_t cfd = 0;
+   if(WaveSize() > delay + 1) {
+      const Short_t* waveform = GetWaveform()->data();
+      size_t         size     = WaveSize();
       if(halfsmoothingwindow > 0) {
-         smoothedWaveform = TZeroDegreeHit::CalculateSmoothedWaveform(halfsmoothingwindow);
-      } else {
-         smoothedWaveform = *GetWaveform();
-      }
-
-      monitor.resize(smoothedWaveform.size() - delay);
-      monitor[0] = static_cast<Short_t>(attenuation * smoothedWaveform[delay] - smoothedWaveform[0]);
-      if(monitor[0] > monitormax) {
-         armed      = true;
-         monitormax = monitor[0];
+         thread_local std::vector<Short_t> smoothedWaveform;
+         smoothedWaveform.resize(TWaveformKernels::SmoothedSize(size, halfsmoothingwindow));
+         size     = TWaveformKernels::Smooth(waveform, size, halfsmoothingwindow, smoothedWaveform.data());
+         waveform = smoothedWaveform.data();
       }
 
-      for(unsigned int i = delay + 1; i < smoothedWaveform.size(); ++i) {
-         monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-         if(monitor[i - delay] > monitormax) {
-            armed      = true;
-            monitormax = monitor[i - delay];
-         } else {
-            if(armed && monitor[i - delay] < 0) {
-               armed = false;
-               if(monitor[i - delay - 1] - monitor[i - delay] != 0) {
-                  // Linear interpolation.
-                  cfd = (i - delay - 1) * interpolationSteps +
-                        (monitor[i - delay - 1] * interpolationSteps) / (monitor[i - delay - 1] - monitor[i - delay]);
-               } else {
-                  // Should be impossible, since monitor[i-delay-1] => 0 and monitor[i-delay] > 0
-                  cfd = 0;
-               }
-            }
-         }
-      }
+      monitor.resize(size > delay ? size - delay : 0);
+      TWaveformKernels::CfdMonitor(waveform, size, attenuation, delay, monitor.data());
+      cfd = TWaveformKernels::CfdZeroCrossing(monitor.data(), monitor.size(), interpolationSteps);
    } else {
       monitor.resize(0);
    }
@@ -216,19 +183,12 @@ Int_t TZeroDegreeHit::CalculateCfdAndMonitor(double attenuation, unsigned int de
 std::vector<Short_t> TZeroDegreeHit::CalculateSmoothedWaveform(unsigned int halfsmoothingwindow)
 {
    /// Used when calculating the CFD from the waveform
-
    if(!HasWave()) {
       return {};   // Error!
    }
 
-   std::vector<Short_t> smoothedWaveform(std::max(static_cast<size_t>(0), WaveSize() - 2 * halfsmoothingwindow),
-                                         0);
-
-   for(size_t i = halfsmoothingwindow; i < WaveSize() - halfsmoothingwindow; ++i) {
-      for(int j = -static_cast<int>(halfsmoothingwindow); j <= static_cast<int>(halfsmoothingwindow); ++j) {
-         smoothedWaveform[i - halfsmoothingwindow] += GetWaveform()->at(i + j);
-      }
-   }
+   std::vector<Short_t> smoothedWaveform(TWaveformKernels::SmoothedSize(WaveSize(), halfsmoothingwindow));
+   TWaveformKernels::Smooth(GetWaveform()->data(), WaveSize(), halfsmoothingwindow, smoothedWaveform.data());
 
    return smoothedWaveform;
 }
@@ -236,7 +196,6 @@ std::vector<Short_t> TZeroDegreeHit::CalculateSmoothedWaveform(unsigned int half
 std::vector<Short_t> TZeroDegreeHit::CalculateCfdMonitor(double attenuation, int delay, int halfsmoothingwindow)
 {
    /// Used when calculating the CFD from the waveform
-
    if(!HasWave()) {
       return {};   // Error!
    }
@@ -249,28 +208,20 @@ std::vector<Short_t> TZeroDegreeHit::CalculateCfdMonitor(double attenuation, int
       smoothedWaveform = *GetWaveform();
    }
 
-   std::vector<Short_t> monitor(std::max(static_cast<size_t>(0), smoothedWaveform.size() - delay), 0);
-
-   for(size_t i = delay; i < smoothedWaveform.size(); ++i) {
-      monitor[i - delay] = static_cast<Short_t>(attenuation * smoothedWaveform[i] - smoothedWaveform[i - delay]);
-   }
+   std::vector<Short_t> monitor(smoothedWaveform.size() > static_cast<size_t>(delay) ? smoothedWaveform.size() - delay : 0);
+   TWaveformKernels::CfdMonitor(smoothedWaveform.data(), smoothedWaveform.size(), attenuation, delay, monitor.data());
 
    return monitor;
 }
 
 std::vector<Int_t> TZeroDegreeHit::CalculatePartialSum()
 {
-
    if(!HasWave()) {
       return {};   // Error!
    }
 
-   std::vector<Int_t> partialSums(WaveSize(), 0);
-
-   partialSums[0] = GetWaveform()->at(0);
-   for(size_t i = 1; i < WaveSize(); ++i) {
-      partialSums[i] = partialSums[i - 1] + GetWaveform()->at(i);
-   }
+   std::vector<Int_t> partialSums(WaveSize());
+   TWaveformKernels::PartialSums(GetWaveform()->data(), WaveSize(), partialSums.data());
 
    if(TGRSIOptions::Get()->Debug()) {
       fPartialSum = partialSums;
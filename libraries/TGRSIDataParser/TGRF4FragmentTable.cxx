@@ -0,0 +1,142 @@
+#include "TGRF4FragmentTable.h"
+
+#include <iostream>
+
+void TGRF4FragmentTable::Add(const std::shared_ptr<TFragment>& frag, std::vector<Int_t>& charge, std::vector<Short_t>& intLength, TFragmentMap& fragmentMap)
+{
+   /// Adds a fragment to the group of its address. Fragments with a single charge and no open group are passed on
+   /// directly, fragments with multiple charges open (or continue) a group, and a single charge fragment closes it.
+   /// The charge and integration length vectors are swapped into the table, so the vectors passed in are left with
+   /// the (cleared) buffers of a previous fragment.
+
+   // evict all open groups whose first fragment is too old to still get its partners
+   EvictAged(frag->GetTimeStamp(), fragmentMap);
+
+   TSlot& slot = GetSlot(frag->GetAddress());
+
+   if(slot.fSize == 0 && charge.size() < 2) {
+      ++fPassed;
+      if(fOnForward) {
+         fOnForward(frag);
+      }
+      fragmentMap.Add(frag, charge, intLength);
+      return;
+   }
+
+   auto& entry     = slot.fEntries[slot.fSize++];
+   entry.fFragment = frag;
+   entry.fCharge.swap(charge);
+   entry.fIntLength.swap(intLength);
+   charge.clear();
+   intLength.clear();
+   if(slot.fSize == 1) {
+      ++fOpenGroups;
+      ++slot.fGroup;
+      fAgeQueue.push({frag->GetTimeStamp(), static_cast<int32_t>(&slot - fSlots.data()), slot.fGroup});
+   }
+
+   if(entry.fCharge.size() < 2) {
+      // the last fragment of a pile-up has only a single charge, so this group is complete
+      ++fCompleted;
+      --fOpenGroups;
+      Forward(slot, fragmentMap);
+      return;
+   }
+
+   if(slot.fSize == fCapacity) {
+      ++fEvictedByCapacity;
+      Evict(slot, fragmentMap);
+   }
+}
+
+void TGRF4FragmentTable::Flush(TFragmentMap& fragmentMap)
+{
+   /// Evicts all open groups.
+   for(auto& slot : fSlots) {
+      if(slot.fSize > 0) {
+         ++fEvictedAtFlush;
+         Evict(slot, fragmentMap);
+      }
+   }
+   fAgeQueue = decltype(fAgeQueue)();
+}
+
+void TGRF4FragmentTable::EvictAged(Long64_t timeStamp, TFragmentMap& fragmentMap)
+{
+   /// Evicts all open groups whose first fragment is more than the maximum age older than the time stamp. Entries of
+   /// groups that have been closed in the meantime are simply removed from the queue.
+   if(fMaxAge <= 0) {
+      return;
+   }
+   while(!fAgeQueue.empty() && timeStamp - fAgeQueue.top().fTimeStamp > fMaxAge) {
+      auto  group = fAgeQueue.top();
+      auto& slot  = fSlots[group.fSlot];
+      fAgeQueue.pop();
+      if(slot.fSize > 0 && slot.fGroup == group.fGroup) {
+         ++fEvictedByAge;
+         Evict(slot, fragmentMap);
+      }
+   }
+}
+
+TGRF4FragmentTable::TSlot& TGRF4FragmentTable::GetSlot(UInt_t address)
+{
+   if(fSlotIndex.empty()) {
+      fSlotIndex.assign(fNofAddresses, -1);
+   }
+   auto& index = fSlotIndex[address & (fNofAddresses - 1)];
+   if(index < 0) {
+      index = static_cast<int32_t>(fSlots.size());
+      fSlots.emplace_back();
+   }
+   return fSlots[index];
+}
+
+void TGRF4FragmentTable::Forward(TSlot& slot, TFragmentMap& fragmentMap)
+{
+   /// Hands all fragments of the slot in order to the fragment map and resets the slot.
+   /// The charge and integration length vectors are only cleared so that their buffers can be reused.
+   for(size_t i = 0; i < slot.fSize; ++i) {
+      auto& entry = slot.fEntries[i];
+      if(fOnForward) {
+         fOnForward(entry.fFragment);
+      }
+      fragmentMap.Add(entry.fFragment, entry.fCharge, entry.fIntLength);
+      entry.fFragment.reset();
+      entry.fCharge.clear();
+      entry.fIntLength.clear();
+   }
+   slot.fSize = 0;
+}
+
+void TGRF4FragmentTable::Evict(TSlot& slot, TFragmentMap& fragmentMap)
+{
+   /// Removes an incomplete group from the table according to the eviction policy.
+   --fOpenGroups;
+   if(fEvictionPolicy == EEvictionPolicy::kForward) {
+      Forward(slot, fragmentMap);
+      return;
+   }
+   for(size_t i = 0; i < slot.fSize; ++i) {
+      auto& entry = slot.fEntries[i];
+      if(fOnDrop) {
+         fOnDrop(entry.fFragment);
+      }
+      entry.fFragment.reset();
+      entry.fCharge.clear();
+      entry.fIntLength.clear();
+   }
+   fDroppedFragments += slot.fSize;
+   slot.fSize = 0;
+}
+
+void TGRF4FragmentTable::Print() const
+{
+   std::cout << "GRF4 fragment table with " << fSlots.size() << " addresses, " << fOpenGroups << " open groups:" << std::endl
+             << "\t" << fPassed << " single fragments passed on" << std::endl
+             << "\t" << fCompleted << " complete groups passed on" << std::endl
+             << "\t" << fEvictedByCapacity << " groups evicted by capacity (" << fCapacity << " fragments)" << std::endl
+             << "\t" << fEvictedByAge << " groups evicted by age (" << fMaxAge << " time stamp units)" << std::endl
+             << "\t" << fEvictedAtFlush << " groups evicted at flush" << std::endl
+             << "\t" << fDroppedFragments << " fragments dropped" << std::endl;
+}
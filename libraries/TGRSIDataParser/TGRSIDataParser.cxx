@@ -1,6 +1,10 @@
 #include "TGRSIDataParser.h"
 #include "TGRSIDataParserException.h"
 
+#include <memory>
+#include <stdexcept>
+#include <string>
+
 #include "TChannel.h"
 #include "Globals.h"
 
@@ -12,14 +16,48 @@
 #include "Rtypes.h"
 
 #include "TMidasEvent.h"
-#include "TXMLOdb.h"
+#include "TOdb.h"
 #include "TRunInfo.h"
 #include "TFragment.h"
 #include "TBadFragment.h"
+#include "TPipelineMetrics.h"
 
 TGRSIDataParser::TGRSIDataParser()
    : fState(EDataParserState::kGood), fIgnoreMissingChannel(TGRSIOptions::Get()->IgnoreMissingChannel())
 {
+   // GRF4 fragments are only counted once they leave the table, either as good (handed to the fragment map) or as bad
+   // (dropped, which isn't the default)
+   fGRF4Table.OnForward([this](const std::shared_ptr<TFragment>& frag) {
+      if(RecordDiag()) {
+         TParsingDiagnostics::Get()->GoodFragment(frag->GetDetectorType());
+      }
+   });
+   fGRF4Table.OnDrop([this](const std::shared_ptr<TFragment>& frag) {
+      if(RecordDiag()) {
+         TParsingDiagnostics::Get()->BadFragment(frag->GetDetectorType());
+      }
+      // the raw data of the fragment is long gone by the time its group is dropped
+      Push(*BadOutputQueue(), std::make_shared<TBadFragment>(*frag, nullptr, 0, -1, false));
+   });
+
+   // the eviction policy and maximum age of incomplete GRF4 groups can be set via the user settings
+   // "GRF4.EvictionPolicy" ("forward" or "drop") and "GRF4.MaxAge" (in time stamp units)
+   if(TGRSIOptions::UserSettings() != nullptr) {
+      auto* settings = TGRSIOptions::UserSettings();
+      try {
+         std::string policy = settings->GetString("GRF4.EvictionPolicy", true);
+         if(policy == "drop") {
+            fGRF4Table.EvictionPolicy(TGRF4FragmentTable::EEvictionPolicy::kDrop);
+         } else if(policy == "forward") {
+            fGRF4Table.EvictionPolicy(TGRF4FragmentTable::EEvictionPolicy::kForward);
+         } else {
+            std::cout << DYELLOW << "Unknown GRF4.EvictionPolicy \"" << policy << "\", use \"forward\" or \"drop\". Keeping the default (forward)." << RESET_COLOR << std::endl;
+         }
+      } catch(std::out_of_range&) {}
+      try {
+         fGRF4Table.MaxAge(settings->GetInt("GRF4.MaxAge", true));
+      } catch(std::out_of_range&) {}
+   }
 }
 
 int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
@@ -28,31 +66,42 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
    int                          banksize = 0;
    void*                        ptr      = nullptr;
    int                          frags    = 0;
+   // the stage of the timer is set to the bank we process, the number of fragments found is used as items
+   TPipelineMetrics::TScopedTimer timer(TPipelineMetrics::EStage::kParseOther, 0);
    try {
       switch(event->GetEventId()) {
       case 1:
          event->SetBankList();
          if((banksize = event->LocateBank(nullptr, "WFDN", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseWFDN);
             frags = TigressDataToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else if((banksize = event->LocateBank(nullptr, "GRF1", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseGRF1);
             frags = ProcessGriffin(reinterpret_cast<uint32_t*>(ptr), banksize, TGRSIDataParser::EBank::kGRF1, event);
          } else if((banksize = event->LocateBank(nullptr, "GRF2", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseGRF2);
             frags = ProcessGriffin(reinterpret_cast<uint32_t*>(ptr), banksize, TGRSIDataParser::EBank::kGRF2, event);
          } else if((banksize = event->LocateBank(nullptr, "GRF3", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseGRF3);
             frags = ProcessGriffin(reinterpret_cast<uint32_t*>(ptr), banksize, TGRSIDataParser::EBank::kGRF3, event);
          } else if((banksize = event->LocateBank(nullptr, "GRF4", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseGRF4);
             frags = ProcessGriffin(reinterpret_cast<uint32_t*>(ptr), banksize, TGRSIDataParser::EBank::kGRF4, event);
          } else if((banksize = event->LocateBank(nullptr, "CAEN", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseCAEN);
             frags = CaenPsdToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else if((banksize = event->LocateBank(nullptr, "CPHA", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseCPHA);
             frags = CaenPhaToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else if((banksize = event->LocateBank(nullptr, "MADC", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseMADC);
             frags = EmmaMadcDataToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
             if((banksize = event->LocateBank(nullptr, "EMMT", &ptr)) > 0) {
                //TODO: make this smarter so that an error in processing EMMT bank doesn't reduce frags
                frags += EmmaTdcDataToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
             }
          } else if((banksize = event->LocateBank(nullptr, "EMMT", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseEMMT);
             frags = EmmaTdcDataToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else {
             std::cout << DRED << std::endl
@@ -62,12 +111,14 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
       case 2:
          event->SetBankList();
          if((banksize = event->LocateBank(nullptr, "SRAW", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseSRAW);
             if(!TGRSIOptions::Get()->SuppressErrors()) {
                std::cout << "Found bank \"SRAW\" of size " << banksize << std::endl;
             }
             frags = EmmaRawDataToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          }
          if((banksize = event->LocateBank(nullptr, "SSUM", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseSSUM);
             if(!TGRSIOptions::Get()->SuppressErrors()) {
                std::cout << "Found bank \"SSUM\" of size " << banksize << std::endl;
             }
@@ -81,8 +132,10 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
          break;
       case 3:
          if((banksize = event->LocateBank(nullptr, "CAEN", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseCAEN);
             frags = CaenPsdToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else if((banksize = event->LocateBank(nullptr, "CPHA", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseCPHA);
             frags = CaenPhaToFragment(reinterpret_cast<uint32_t*>(ptr), banksize, event);
          } else {
             std::cout << DRED << std::endl
@@ -93,6 +146,7 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
       case 5:
          event->SetBankList();
          if((banksize = event->LocateBank(nullptr, "MSRD", &ptr)) > 0) {
+            timer.Stage(TPipelineMetrics::EStage::kParseMSRD);
             EPIXToScalar(reinterpret_cast<float*>(ptr), banksize, event->GetSerialNumber(), event->GetTimeStamp());
             // EPIXToScalar will only ever read a single fragment
             event->IncrementGoodFrags();
@@ -100,22 +154,29 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
          break;
       case 0x8001:
          // end of file ODB
-#ifdef HAS_XML
-         auto*     odb  = new TXMLOdb(event->GetData(), event->GetDataSize());
-         TXMLNode* node = odb->FindPath("/Runinfo/Stop time binary");
+         timer.Stage(TPipelineMetrics::EStage::kOdbEndOfRun);
+         std::unique_ptr<TOdb> odb;
+         try {
+            odb.reset(TOdb::Create(event->GetData(), event->GetDataSize()));
+         } catch(std::exception& e) {
+            // a broken end-of-run ODB shouldn't stop the sort, we just can't check the stop time
+            std::cout << DYELLOW << "Warning, failed to read end-of-run ODB of midas event #" << event->GetSerialNumber() << " (" << e.what() << "), not updating run stop!" << RESET_COLOR << std::endl;
+         }
+         TOdbNode* node = (odb != nullptr) ? odb->FindPath("/Runinfo/Stop time binary") : nullptr;
          if(node != nullptr) {
-            std::stringstream str(node->GetText());
-            unsigned int      odbTime = 0;
-            str >> odbTime;
+            auto odbTime = static_cast<unsigned int>(TOdb::ToInteger(node->GetText()));
             odbTime *= 10;   // convert from 10 ns to 1 ns units
-            if(atoi(node->GetText()) != 0 && odbTime != event->GetTimeStamp() && !TGRSIOptions::Get()->SuppressErrors()) {
+            if(TOdb::ToInteger(node->GetText()) != 0 && odbTime != event->GetTimeStamp() && !TGRSIOptions::Get()->SuppressErrors()) {
                std::cout << "Warning, ODB stop time of last subrun (" << odbTime << ") does not match midas time of last event in this subrun (" << event->GetTimeStamp() << ")!" << std::endl;
             }
             TRunInfo::SetRunStop(event->GetTimeStamp());
          }
          TRunInfo::SetRunLength();
-         delete odb;
-#endif
+         // no more partners can arrive for any GRF4 fragments still waiting
+         fGRF4Table.Flush(FragmentMap());
+         if(fGRF4Table.DroppedFragments() > 0 && !TGRSIOptions::Get()->SuppressErrors()) {
+            fGRF4Table.Print();
+         }
          break;
       };
    } catch(const std::bad_alloc&) {
@@ -132,6 +193,16 @@ int TGRSIDataParser::Process(std::shared_ptr<TRawEvent> rawEvent)
       frags = 0;
    }
 
+   timer.Items(frags);
+   timer.Stop();
+   if(TPipelineMetrics::Enabled()) {
+      if(event->GetEventId() == 0x8001) {
+         TPipelineMetrics::Get()->Finish();
+      } else {
+         TPipelineMetrics::Get()->PeriodicExport();
+      }
+   }
+
    return frags;
 }
 
@@ -714,10 +785,8 @@ int TGRSIDataParser::GriffinDataToFragment(uint32_t* data, int size, EBank bank,
                   throw TGRSIDataParserException(fState, failedWord, multipleErrors);
                }
                eventFrag->SetCfd(tmpCfd[0]);
-               if(RecordDiag()) {
-                  TParsingDiagnostics::Get()->GoodFragment(eventFrag->GetDetectorType());
-               }
-               FragmentMap().Add(eventFrag, tmpCharge, tmpIntLength);
+               // counted as good fragment by the table once it is handed to the fragment map
+               fGRF4Table.Add(eventFrag, tmpCharge, tmpIntLength, FragmentMap());
                return x;
             }
             if(tmpCharge.size() != tmpIntLength.size() || tmpCharge.size() != tmpCfd.size()) {
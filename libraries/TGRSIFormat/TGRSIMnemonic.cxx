@@ -1,6 +1,9 @@
 #include "TGRSIMnemonic.h"
 
 #include <algorithm>
+#include <unordered_map>
+
+#include "TCounterRandom.h"
 
 // Detector dependent includes
 #include "TGriffin.h"
@@ -38,76 +41,62 @@ void TGRSIMnemonic::Clear(Option_t*)
 
 void TGRSIMnemonic::EnumerateSystem()
 {
-   // Enumerating the fSystemString must come after the total mnemonic has been parsed as the details of other parts of
-   // the mnemonic must be known
-   if(SystemString() == "TI") {
-      if(SubSystem() == EMnemonic::kS) {
-         fSystem = ESystem::kTigressBgo;
-      } else {
-         fSystem = ESystem::kTigress;
-      }
-   } else if(SystemString() == "SH") {
-      fSystem = ESystem::kSharc;
-   } else if(SystemString() == "TR") {
-      fSystem = ESystem::kTriFoil;
-   } else if(SystemString() == "RF") {
-      fSystem = ESystem::kRF;
-   } else if(SystemString() == "SP") {
-      if(SubSystem() == EMnemonic::kI) {
-         fSystem = ESystem::kSiLi;
-      } else {
-         fSystem = ESystem::kSiLiS3;
-      }
-   } else if(SystemString() == "GD") {
-      fSystem = ESystem::kGeneric;
-   } else if(SystemString() == "CS") {
-      fSystem = ESystem::kCSM;
-   } else if(SystemString() == "GR") {
-      if(SubSystem() == EMnemonic::kS) {
-         fSystem = ESystem::kGriffinBgo;
-      } else {
-         fSystem = ESystem::kGriffin;
-      }
-   } else if(SystemString() == "SE") {
-      fSystem = ESystem::kSceptar;
-   } else if(SystemString() == "PA") {
-      fSystem = ESystem::kPaces;
-   } else if(SystemString() == "DS") {
-      fSystem = ESystem::kDescant;
-   } else if((SystemString() == "DA") || (SystemString() == "LB")) {
-      if(SubSystem() == EMnemonic::kS) {
-         fSystem = ESystem::kLaBrBgo;
-      } else if(SubSystem() == EMnemonic::kT) {
-         fSystem = ESystem::kTAC;
-      } else {
-         fSystem = ESystem::kLaBr;
-      }
-   } else if(SystemString() == "BA") {
-      fSystem = ESystem::kS3;
-   } else if(SystemString() == "ZD") {
-      fSystem = ESystem::kZeroDegree;
-   } else if(SystemString() == "TP") {
-      fSystem = ESystem::kTip;
-   } else if(SystemString() == "BG") {
-      fSystem = ESystem::kBgo;
-   } else if((SystemString() == "EM") || (SystemString() == "ET")) {
-      if(SubSystem() == EMnemonic::kE) {
-         fSystem = ESystem::kEmmaS3;
-      } else {
-         fSystem = ESystem::kEmma;
-      }
-   } else if(SystemString() == "TF") {
-      fSystem = ESystem::kTrific;
-   } else if(SystemString() == "SZ") {
-      fSystem = ESystem::kSharc2;
-   } else if(SystemString() == "RC") {
-      fSystem = ESystem::kRcmp;
-   } else if(SystemString() == "AR") {
-      fSystem = ESystem::kAries;
-   } else if(SystemString() == "DM") {
-      fSystem = ESystem::kDemand;
-   } else {
-      fSystem = ESystem::kClear;
+   /// Enumerating the fSystemString must come after the total mnemonic has been parsed as the details of other parts of
+   /// the mnemonic must be known. The system is looked up in a table indexed by the two (upper case) characters of the
+   /// system string, each entry has the default system and up to two subsystems that select a different one.
+   struct TSystemEntry {
+      ESystem   fSystem{ESystem::kClear};
+      EMnemonic fSubSystem[2]{EMnemonic::kClear, EMnemonic::kClear};
+      ESystem   fSubSystemSystem[2]{ESystem::kClear, ESystem::kClear};
+   };
+   static constexpr auto systemTable = [] {
+      std::array<TSystemEntry, 26 * 26> table{};
+      auto add = [&table](const char* code, ESystem system, EMnemonic subSystem0 = EMnemonic::kClear, ESystem system0 = ESystem::kClear, EMnemonic subSystem1 = EMnemonic::kClear, ESystem system1 = ESystem::kClear) {
+         auto& entry               = table[(code[0] - 'A') * 26 + (code[1] - 'A')];
+         entry.fSystem             = system;
+         entry.fSubSystem[0]       = subSystem0;
+         entry.fSubSystemSystem[0] = system0;
+         entry.fSubSystem[1]       = subSystem1;
+         entry.fSubSystemSystem[1] = system1;
+      };
+      add("TI", ESystem::kTigress, EMnemonic::kS, ESystem::kTigressBgo);
+      add("SH", ESystem::kSharc);
+      add("TR", ESystem::kTriFoil);
+      add("RF", ESystem::kRF);
+      add("SP", ESystem::kSiLiS3, EMnemonic::kI, ESystem::kSiLi);
+      add("GD", ESystem::kGeneric);
+      add("CS", ESystem::kCSM);
+      add("GR", ESystem::kGriffin, EMnemonic::kS, ESystem::kGriffinBgo);
+      add("SE", ESystem::kSceptar);
+      add("PA", ESystem::kPaces);
+      add("DS", ESystem::kDescant);
+      add("DA", ESystem::kLaBr, EMnemonic::kS, ESystem::kLaBrBgo, EMnemonic::kT, ESystem::kTAC);
+      add("LB", ESystem::kLaBr, EMnemonic::kS, ESystem::kLaBrBgo, EMnemonic::kT, ESystem::kTAC);
+      add("BA", ESystem::kS3);
+      add("ZD", ESystem::kZeroDegree);
+      add("TP", ESystem::kTip);
+      add("BG", ESystem::kBgo);
+      add("EM", ESystem::kEmma, EMnemonic::kE, ESystem::kEmmaS3);
+      add("ET", ESystem::kEmma, EMnemonic::kE, ESystem::kEmmaS3);
+      add("TF", ESystem::kTrific);
+      add("SZ", ESystem::kSharc2);
+      add("RC", ESystem::kRcmp);
+      add("AR", ESystem::kAries);
+      add("DM", ESystem::kDemand);
+      return table;
+   }();
+
+   fSystem                   = ESystem::kClear;
+   const std::string& system = SystemString();
+   if(system.size() != 2 || system[0] < 'A' || system[0] > 'Z' || system[1] < 'A' || system[1] > 'Z') {
+      return;
+   }
+   const auto& entry = systemTable[(system[0] - 'A') * 26 + (system[1] - 'A')];
+   fSystem           = entry.fSystem;
+   if(entry.fSubSystem[0] != EMnemonic::kClear && SubSystem() == entry.fSubSystem[0]) {
+      fSystem = entry.fSubSystemSystem[0];
+   } else if(entry.fSubSystem[1] != EMnemonic::kClear && SubSystem() == entry.fSubSystem[1]) {
+      fSystem = entry.fSubSystemSystem[1];
    }
 }
 
@@ -148,6 +137,20 @@ void TGRSIMnemonic::EnumerateDigitizer(TPriorityValue<std::string>& digitizerNam
    timeStampUnit.Set(tmpUnit, digitizerName.Priority());
 }
 
+int16_t TGRSIMnemonic::HexDigit(char character)
+{
+   if(character >= '0' && character <= '9') {
+      return static_cast<int16_t>(character - '0');
+   }
+   if(character >= 'A' && character <= 'F') {
+      return static_cast<int16_t>(character - 'A' + 10);
+   }
+   if(character >= 'a' && character <= 'f') {
+      return static_cast<int16_t>(character - 'a' + 10);
+   }
+   return -1;
+}
+
 void TGRSIMnemonic::Parse(std::string* name)
 {
    if((name == nullptr) || name->length() < 9) {
@@ -162,9 +165,12 @@ void TGRSIMnemonic::Parse(std::string* name)
    EnumerateSystem();
 
    if(fSystem == ESystem::kSiLi) {
-      std::string buf;
-      buf.assign(*name, 7, 2);
-      Segment(static_cast<int16_t>(strtol(buf.c_str(), nullptr, 16)));
+      // the segment of the SiLi is the hexadecimal number in characters 7 and 8
+      int16_t segment = 0;
+      for(size_t i = 7; i < 9 && HexDigit((*name)[i]) >= 0; ++i) {
+         segment = static_cast<int16_t>(segment * 16 + HexDigit((*name)[i]));
+      }
+      Segment(segment);
    }
 }
 
@@ -218,37 +224,154 @@ TClass* TGRSIMnemonic::GetClassType() const
 
 double TGRSIMnemonic::GetTime(Long64_t timestamp, Float_t cfd, double energy, const TChannel* channel) const
 {
+   /// The random numbers for the dithering are drawn from a counter-based generator seeded with the time stamp and
+   /// address of the hit, so the time of a hit does not depend on which thread calculates it (or how often).
    if(channel == nullptr) {
       Error("GetTime", "No TChannel provided");
-      return static_cast<double>(timestamp) + gRandom->Uniform();
+      return static_cast<double>(timestamp) + TCounterRandom(timestamp, 0, TCounterRandom::EStream::kTime).Uniform();
    }
 
-   Double_t dTime = 0.;
+   TCounterRandom random(timestamp, channel->GetAddress(), TCounterRandom::EStream::kTime);
+   Double_t       dTime = 0.;
    switch(static_cast<EDigitizer>(channel->GetDigitizerType())) {
    case EDigitizer::kGRF16:
    case EDigitizer::kFMC32:
       // we need to zero the lowest 18 bits of the timestamp as those are included in the CFD value
       // TODO: what happens close to the wrap-around of those 18 bits??? This only happens every 2^18 * 10e-8 so 2.5 ms so 400 Hz
-      dTime = static_cast<Double_t>((timestamp & (~0x3ffff)) * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + gRandom->Uniform()) / 1.6);   // CFD is in 10/16th of a nanosecond
+      dTime = static_cast<Double_t>((timestamp & (~0x3ffff)) * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + random.Uniform()) / 1.6);   // CFD is in 10/16th of a nanosecond
       return dTime - channel->GetTZero(energy) - static_cast<double>(channel->GetTimeOffset());
    case EDigitizer::kGRF4G:
-      dTime = static_cast<Double_t>(timestamp * channel->GetTimeStampUnit()) + channel->CalibrateCFD((static_cast<Int_t>(cfd) >> 22) + ((static_cast<Int_t>(cfd) & 0x3fffff) + gRandom->Uniform()) / 256.);
+      dTime = static_cast<Double_t>(timestamp * channel->GetTimeStampUnit()) + channel->CalibrateCFD((static_cast<Int_t>(cfd) >> 22) + ((static_cast<Int_t>(cfd) & 0x3fffff) + random.Uniform()) / 256.);
       return dTime - channel->GetTZero(energy) - static_cast<double>(channel->GetTimeOffset());
    case EDigitizer::kTIG10:
-      dTime = static_cast<Double_t>((timestamp & (~0x7fffff)) * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + gRandom->Uniform()) / 1.6);   // CFD is in 10/16th of a nanosecond
-      //channel->CalibrateCFD((cfd & (~0xf) + gRandom->Uniform()) / 1.6); // PBender suggests this.
+      dTime = static_cast<Double_t>((timestamp & (~0x7fffff)) * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + random.Uniform()) / 1.6);   // CFD is in 10/16th of a nanosecond
+      //channel->CalibrateCFD((cfd & (~0xf) + random.Uniform()) / 1.6); // PBender suggests this.
       return dTime - channel->GetTZero(energy) - static_cast<double>(channel->GetTimeOffset());
    case EDigitizer::kCaen:
       //10 bit CFD for 0-2ns => divide by 512
-      dTime = static_cast<Double_t>(timestamp * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + gRandom->Uniform()) / 512.);
+      dTime = static_cast<Double_t>(timestamp * channel->GetTimeStampUnit()) + channel->CalibrateCFD((cfd + random.Uniform()) / 512.);
       return dTime - channel->GetTZero(energy) - static_cast<double>(channel->GetTimeOffset());
    default:
-      dTime = (static_cast<Double_t>(timestamp) + gRandom->Uniform()) * channel->GetTimeStampUnit();
+      dTime = (static_cast<Double_t>(timestamp) + random.Uniform()) * channel->GetTimeStampUnit();
       return dTime - channel->GetTZero(energy) - static_cast<double>(channel->GetTimeOffset());
    }
    return 0.;
 }
 
+double TGRSIMnemonic::TTimingDescriptor::CalibrateCfd(double cfd) const
+{
+   /// Evaluates the CFD calibration polynomial (Horner's scheme), uses TChannel::CalibrateCFD if there are more
+   /// coefficients than we store.
+   if(fNofCfdCoefficients > fCfdCoefficients.size()) {
+      return fChannel->CalibrateCFD(cfd);
+   }
+   if(fNofCfdCoefficients == 0) {
+      return cfd;
+   }
+   double result = 0.;
+   for(size_t i = fNofCfdCoefficients; i > 0; --i) {
+      result = result * cfd + fCfdCoefficients[i - 1];
+   }
+   return result;
+}
+
+double TGRSIMnemonic::TTimingDescriptor::Time(Long64_t timestamp, Float_t cfd, double tZero, double random) const
+{
+   double time = 0.;
+   switch(fCfdMode) {
+   case ECfdMode::kFraction:
+      time = static_cast<double>((timestamp & fTimeStampMask) * fTimeStampUnit) + CalibrateCfd((cfd + random) / fCfdDivisor);
+      break;
+   case ECfdMode::kGRF4G:
+      time = static_cast<double>(timestamp * fTimeStampUnit) + CalibrateCfd((static_cast<Int_t>(cfd) >> 22) + ((static_cast<Int_t>(cfd) & 0x3fffff) + random) / 256.);
+      break;
+   case ECfdMode::kNone:
+      time = (static_cast<double>(timestamp) + random) * static_cast<double>(fTimeStampUnit);
+      break;
+   }
+   return time - tZero - fTimeOffset;
+}
+
+TGRSIMnemonic::TTimingDescriptor TGRSIMnemonic::BuildTimingDescriptor(const TChannel* channel)
+{
+   /// Translates the digitizer type of the channel into the masks and divisors used by GetTime and copies the CFD
+   /// calibration and time offset.
+   TTimingDescriptor descriptor;
+   if(channel == nullptr) {
+      return descriptor;
+   }
+   descriptor.fChannel       = channel;
+   descriptor.fTimeStampUnit = channel->GetTimeStampUnit();
+   descriptor.fTimeOffset    = static_cast<double>(channel->GetTimeOffset());
+   switch(static_cast<EDigitizer>(channel->GetDigitizerType())) {
+   case EDigitizer::kGRF16:
+   case EDigitizer::kFMC32:
+      // the lowest 18 bits of the timestamp are included in the CFD value, which is in 10/16th of a nanosecond
+      descriptor.fCfdMode       = TTimingDescriptor::ECfdMode::kFraction;
+      descriptor.fTimeStampMask = ~0x3ffffLL;
+      descriptor.fCfdDivisor    = 1.6;
+      break;
+   case EDigitizer::kGRF4G:
+      descriptor.fCfdMode = TTimingDescriptor::ECfdMode::kGRF4G;
+      break;
+   case EDigitizer::kTIG10:
+      descriptor.fCfdMode       = TTimingDescriptor::ECfdMode::kFraction;
+      descriptor.fTimeStampMask = ~0x7fffffLL;
+      descriptor.fCfdDivisor    = 1.6;
+      break;
+   case EDigitizer::kCaen:
+      // 10 bit CFD for 0-2 ns
+      descriptor.fCfdMode    = TTimingDescriptor::ECfdMode::kFraction;
+      descriptor.fCfdDivisor = 512.;
+      break;
+   default:
+      descriptor.fCfdMode = TTimingDescriptor::ECfdMode::kNone;
+      break;
+   }
+   std::vector<Float_t> coefficients = channel->GetCFDCoeff();
+   descriptor.fNofCfdCoefficients    = coefficients.size();
+   for(size_t i = 0; i < coefficients.size() && i < descriptor.fCfdCoefficients.size(); ++i) {
+      descriptor.fCfdCoefficients[i] = coefficients[i];
+   }
+
+   return descriptor;
+}
+
+void TGRSIMnemonic::GetTimes(size_t n, const Long64_t* timestamps, const Float_t* cfds, const double* energies, const TChannel* const* channels, double* times)
+{
+   /// The descriptors, walk corrections, and random numbers are collected first, so that the actual time calculation
+   /// is a tight loop without any calls. The descriptors are built once per channel and call, so calibrations changed
+   /// in place are always picked up, just as by GetTime. Consecutive hits of the same channel share the look-up.
+   std::vector<const TTimingDescriptor*>                  descriptors(n, nullptr);
+   std::vector<double>                                    tZero(n, 0.);
+   std::vector<double>                                    random(n, 0.);
+   std::unordered_map<const TChannel*, TTimingDescriptor> built;
+   for(size_t i = 0; i < n; ++i) {
+      if(channels[i] == nullptr) {
+         random[i] = TCounterRandom(timestamps[i], 0, TCounterRandom::EStream::kTime).Uniform();
+         continue;
+      }
+      random[i] = TCounterRandom(timestamps[i], channels[i]->GetAddress(), TCounterRandom::EStream::kTime).Uniform();
+      if(i > 0 && channels[i] == channels[i - 1] && descriptors[i - 1] != nullptr) {
+         descriptors[i] = descriptors[i - 1];
+      } else {
+         auto descriptor = built.find(channels[i]);
+         if(descriptor == built.end()) {
+            descriptor = built.emplace(channels[i], BuildTimingDescriptor(channels[i])).first;
+         }
+         descriptors[i] = &descriptor->second;
+      }
+      tZero[i] = channels[i]->GetTZero(energies[i]);
+   }
+   for(size_t i = 0; i < n; ++i) {
+      if(descriptors[i] == nullptr) {
+         times[i] = static_cast<double>(timestamps[i]) + random[i];
+         continue;
+      }
+      times[i] = descriptors[i]->Time(timestamps[i], cfds[i], tZero[i], random[i]);
+   }
+}
+
 int TGRSIMnemonic::NumericArraySubPosition() const
 {
    /// This function translates the crystal color to an index
@@ -1,4 +1,4 @@
-// TXMLOdb.h TMidasEvent.h TMidasFile.h
+// TOdb.h TXMLOdb.h TJSONOdb.h TMidasEvent.h TMidasFile.h TPipelineMetrics.h
 
 #ifdef __CINT__
 
@@ -7,8 +7,11 @@
 #pragma link off all functions;
 #pragma link         C++ nestedclasses;
 
+#pragma link C++ class TOdb + ;
 #pragma link C++ class TXMLOdb + ;
+#pragma link C++ class TJSONOdb + ;
 #pragma link C++ class TMidasEvent + ;
 #pragma link C++ class TMidasFile + ;
+#pragma link C++ class TPipelineMetrics + ;
 
 #endif
@@ -0,0 +1,244 @@
+#include "TJSONOdb.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+TJSONOdb::TJSONOdb(char* buffer, int size)
+{
+   /// Creator, tries to open buffer as input file and parse it, if that fails, parses size bytes of the buffer.
+   SetBuffer(buffer, size);
+   fPos = BufferBegin();
+   fEnd = BufferEnd();
+
+   SkipWhitespace();
+   if(fPos >= fEnd || *fPos != '{') {
+      Error("cannot find top-level object");
+   }
+   ParseObject(AddNode(nullptr, TOdbNode::EType::kDir, ""));
+}
+
+void TJSONOdb::ParseObject(TOdbNode* node)
+{
+   /// Parses the object starting at the current position, adding all members as children of the node.
+   Expect('{');
+   SkipWhitespace();
+   if(*fPos == '}') {
+      ++fPos;
+      return;
+   }
+   while(true) {
+      SkipWhitespace();
+      if(*fPos != '"') {
+         Error("expected member name");
+      }
+      const char* name = ParseString();
+      SkipWhitespace();
+      Expect(':');
+      SkipWhitespace();
+
+      if(IsMetaData(name)) {
+         SkipValue();
+      } else if(*fPos == '{') {
+         ParseObject(AddNode(node, TOdbNode::EType::kDir, name));
+      } else if(*fPos == '[') {
+         ParseArray(AddNode(node, TOdbNode::EType::kKeyArray, name));
+      } else {
+         TOdbNode* key = AddNode(node, TOdbNode::EType::kKey, name);
+         SetText(key, ParseScalar());
+      }
+
+      SkipWhitespace();
+      if(*fPos == ',') {
+         ++fPos;
+         continue;
+      }
+      Expect('}');
+      return;
+   }
+}
+
+void TJSONOdb::ParseArray(TOdbNode* node)
+{
+   /// Parses the array starting at the current position as the values of the key array node. MIDAS arrays only
+   /// contain scalars, nested objects or arrays are skipped (and leave an empty value).
+   Expect('[');
+   ResizeArray(node, 0);
+   SkipWhitespace();
+   if(*fPos == ']') {
+      ++fPos;
+      return;
+   }
+   for(size_t index = 0;; ++index) {
+      SkipWhitespace();
+      if(*fPos == '{' || *fPos == '[') {
+         SkipValue();
+         SetValue(node, index, "");
+      } else {
+         SetValue(node, index, ParseScalar());
+      }
+      SkipWhitespace();
+      if(*fPos == ',') {
+         ++fPos;
+         continue;
+      }
+      Expect(']');
+      return;
+   }
+}
+
+const char* TJSONOdb::ParseScalar()
+{
+   /// Parses a string, number, or literal (true, false, null) and returns its text. Strings are unescaped in place,
+   /// numbers and literals are followed directly by a delimiter we still need, so they are stored separately.
+   /// Null is returned as an empty string.
+   if(*fPos == '"') {
+      return ParseString();
+   }
+   char* begin = fPos;
+   while(fPos < fEnd && *fPos != ',' && *fPos != '}' && *fPos != ']' && std::isspace(static_cast<unsigned char>(*fPos)) == 0) {
+      ++fPos;
+   }
+   if(fPos == begin) {
+      Error("expected value");
+   }
+   if(fPos - begin == 4 && std::strncmp(begin, "null", 4) == 0) {
+      return "";
+   }
+   return StoreText(begin, fPos - begin);
+}
+
+char* TJSONOdb::ParseString()
+{
+   /// Parses the string starting at the current position (the opening quote), unescapes it in place, and
+   /// null-terminates it by overwriting the closing quote. The unescaped string is never longer than the original.
+   char* begin = ++fPos;
+   char* out   = begin;
+   while(true) {
+      if(fPos >= fEnd) {
+         Error("unterminated string");
+      }
+      char character = *fPos++;
+      if(character == '"') {
+         break;
+      }
+      if(character != '\\') {
+         *out++ = character;
+         continue;
+      }
+      character = *fPos++;
+      switch(character) {
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      case 'u': {
+         if(fEnd - fPos < 4) {
+            Error("incomplete unicode escape");
+         }
+         char     hex[5] = {fPos[0], fPos[1], fPos[2], fPos[3], '\0'};
+         uint32_t code   = std::strtoul(hex, nullptr, 16);
+         fPos += 4;
+         // combine surrogate pairs
+         if(code >= 0xd800 && code < 0xdc00 && fEnd - fPos >= 6 && fPos[0] == '\\' && fPos[1] == 'u') {
+            char     low[5]  = {fPos[2], fPos[3], fPos[4], fPos[5], '\0'};
+            uint32_t lowCode = std::strtoul(low, nullptr, 16);
+            if(lowCode >= 0xdc00 && lowCode < 0xe000) {
+               code = 0x10000 + ((code - 0xd800) << 10) + (lowCode - 0xdc00);
+               fPos += 6;
+            }
+         }
+         if(code < 0x80) {
+            *out++ = static_cast<char>(code);
+         } else if(code < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         } else if(code < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         } else {
+            *out++ = static_cast<char>(0xf0 | ((code >> 18) & 0x7));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         }
+         break;
+      }
+      default:
+         // '"', '\\', and '/' (or anything else) stand for themselves
+         *out++ = character;
+         break;
+      }
+   }
+   *out = '\0';
+   return begin;
+}
+
+void TJSONOdb::SkipValue()
+{
+   /// Skips the value starting at the current position (including nested objects and arrays).
+   if(*fPos == '"') {
+      ParseString();
+      return;
+   }
+   if(*fPos != '{' && *fPos != '[') {
+      ParseScalar();
+      return;
+   }
+   int depth = 0;
+   while(fPos < fEnd) {
+      if(*fPos == '"') {
+         ParseString();
+         continue;
+      }
+      if(*fPos == '{' || *fPos == '[') {
+         ++depth;
+      } else if(*fPos == '}' || *fPos == ']') {
+         --depth;
+      }
+      ++fPos;
+      if(depth == 0) {
+         return;
+      }
+   }
+   Error("unterminated object or array");
+}
+
+void TJSONOdb::SkipWhitespace()
+{
+   while(fPos < fEnd && std::isspace(static_cast<unsigned char>(*fPos)) != 0) {
+      ++fPos;
+   }
+}
+
+void TJSONOdb::Expect(char character)
+{
+   if(fPos >= fEnd || *fPos != character) {
+      std::string message = "expected '";
+      message.append(1, character).append("'");
+      Error(message.c_str());
+   }
+   ++fPos;
+}
+
+void TJSONOdb::Error(const char* message)
+{
+   std::string error = "JsonOdb::JsonOdb: Malformed ODB dump: ";
+   error.append(message).append(" at offset ").append(std::to_string(fPos - BufferBegin()));
+   throw std::runtime_error(error);
+}
+
+bool TJSONOdb::IsMetaData(const char* name)
+{
+   /// Returns true for the top-level entries like "/MIDAS version" and the "<name>/key" entries describing each key.
+   if(name[0] == '/') {
+      return true;
+   }
+   size_t length = std::strlen(name);
+   return length > 4 && std::strcmp(name + length - 4, "/key") == 0;
+}
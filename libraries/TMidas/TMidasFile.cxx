@@ -17,15 +17,15 @@
 
 #include "TMidasFile.h"
 #include "TMidasEvent.h"
+#include "TPipelineMetrics.h"
+#include "TOdbCache.h"
 #include "TRunInfo.h"
 #include "TGRSIDetectorInformation.h"
 #include "TGRSIMnemonic.h"
 #include "GRSIDataVersion.h"
 
 TMidasFile::TMidasFile()
-#ifdef HAS_XML
    : fOdb(nullptr)
-#endif
 {
    /// Default Constructor
    uint32_t endian = 0x12345678;
@@ -52,9 +52,7 @@ TMidasFile::~TMidasFile()
    Close();
    OutClose();
    fOdbEvent.reset();
-#ifdef HAS_XML
    delete fOdb;
-#endif
 }
 
 std::string TMidasFile::Status(bool)
@@ -215,6 +213,9 @@ bool TMidasFile::Open(const char* filename)
    // setup TChannel to use our mnemonics
    TChannel::SetMnemonicClass(TGRSIMnemonic::Class());
 
+   // enable the pipeline metrics if requested by the user settings
+   TPipelineMetrics::Configure();
+
    // read ODB from file
    if(fOdbEvent == nullptr) { fOdbEvent = std::make_shared<TMidasEvent>(); }
    Read(fOdbEvent);
@@ -414,7 +415,8 @@ void TMidasFile::Skip(size_t nofEvents)
 
 void TMidasFile::ReadMoreBytes(size_t bytes)
 {
-   size_t initialSize = BufferSize();
+   TPipelineMetrics::TScopedTimer timer(TPipelineMetrics::EStage::kRead, 0);
+   size_t                         initialSize = BufferSize();
    ResizeBuffer(initialSize + bytes);
    size_t rd = 0;
    if(fGzFile != nullptr) {
@@ -428,6 +430,7 @@ void TMidasFile::ReadMoreBytes(size_t bytes)
    }
 
    ResizeBuffer(initialSize + rd);
+   timer.Items(rd);
 
    if(rd == 0) {
       fLastErrno = 0;
@@ -640,7 +643,6 @@ int TMidasFile::GetSubRunNumber()
 
 void TMidasFile::SetFileOdb()
 {
-#ifdef HAS_XML
    // check if we have already set the TChannels....
    //
    delete fOdb;
@@ -652,37 +654,34 @@ void TMidasFile::SetFileOdb()
    }
 
    try {
-      fOdb = new TXMLOdb(fOdbEvent->GetData(), fOdbEvent->GetDataSize());
+      fOdb = TOdb::Create(fOdbEvent->GetData(), fOdbEvent->GetDataSize());
    } catch(std::exception& e) {
       std::cout << "Got exception '" << e.what() << "' trying to read " << fOdbEvent->GetDataSize() << " bytes (or words?) from:" << std::endl;
       std::cout << fOdbEvent->GetData() << std::endl;
       throw e;
    }
-   TChannel::DeleteAllChannels();
 
    SetRunInfo(fOdbEvent->GetTimeStamp());
 
    // Check for EPICS variables
    SetEPICSOdb();
 
-   // Check to see if we are running a GRIFFIN or TIGRESS experiment
-   TXMLNode* node = fOdb->FindPath("/Experiment");
-   if(!node->HasChildren()) {
+   // The channels and PPG cycle only depend on a few parts of the ODB, if those are unchanged (e.g. for the next
+   // subrun of the same run) we use the cached ones instead of creating them again.
+   uint64_t hash = OdbHash();
+   if(TOdbCache::Get()->Apply(hash)) {
+      std::cout << "\tODB channels and PPG cycle unchanged, using cached ones (hash 0x" << std::hex << hash << std::dec << ")." << std::endl;
       return;
    }
-   node = node->GetChildren();
-   std::string expt;
-   while(true) {
-      std::string key = fOdb->GetNodeName(node);
-      if(key == "Name") {
-         expt = node->GetText();
-         break;
-      }
-      if(!node->HasNextNode()) {
-         break;
-      }
-      node = node->GetNextNode();
+   TChannel::DeleteAllChannels();
+
+   // Check to see if we are running a GRIFFIN or TIGRESS experiment
+   TOdbNode* node = fOdb->FindPath("/Experiment/Name");
+   if(node == nullptr || node->GetText() == nullptr) {
+      return;
    }
+   std::string expt = node->GetText();
+   TOdbCache::Get()->Begin(hash);
    if(expt == "tigress") {
       if(!TGRSIOptions::Get()->IgnoreOdbChannels()) {
          SetTIGOdb();
@@ -697,17 +696,30 @@ void TMidasFile::SetFileOdb()
    } else {
       std::cerr << RED << "Unknown experiment name \"" << expt << "\", ODB won't be read!" << RESET_COLOR << std::endl;
    }
-#endif
+   TOdbCache::Get()->Commit();
+}
+
+uint64_t TMidasFile::OdbHash() const
+{
+   /// Hash of all parts of the ODB the channels and PPG cycle are created from (and of the options that change how
+   /// they are created).
+   uint64_t hash = TOdb::fHashSeed;
+   for(const char* path : {"/Experiment/Name", "/PPG/Current", "/PPG/Cycles", "/DAQ/PSC", "/DAQ/MSC",
+                           "/Equipment/Trigger/settings/Detector Settings", "/Analyzer/Shared Parameters/Config",
+                           "/Analyzer/Parameters/Cathode/Config"}) {
+      hash = fOdb->Hash(fOdb->FindPath(path), hash);
+   }
+   if(TGRSIOptions::Get()->IgnoreOdbChannels()) {
+      hash = fOdb->Hash(nullptr, hash);
+   }
+   return hash;
 }
 
 void TMidasFile::SetRunInfo(uint32_t time)
 {
-#ifdef HAS_XML
-   TXMLNode* node = fOdb->FindPath("/Runinfo/Start time binary");
+   TOdbNode* node = fOdb->FindPath("/Runinfo/Start time binary");
    if(node != nullptr) {
-      std::stringstream str(node->GetText());
-      unsigned int      odbTime = 0;
-      str >> odbTime;
+      auto odbTime = static_cast<unsigned int>(TOdb::ToInteger(node->GetText()));
       if(TRunInfo::SubRunNumber() == 0 && time != odbTime) {
          std::cout << "Warning, ODB start time of first subrun (" << odbTime << ") does not match midas time of first event in this subrun (" << time << ")!" << std::endl;
       }
@@ -725,38 +737,34 @@ void TMidasFile::SetRunInfo(uint32_t time)
       TRunInfo::SetRunComment(node->GetText());
       std::cout << "Comment: " << DBLUE << node->GetText() << RESET_COLOR << std::endl;
    }
-#endif
 }
 
 void TMidasFile::SetEPICSOdb()
 {
-#ifdef HAS_XML
-   TXMLNode*                node  = fOdb->FindPath("/Equipment/Epics/Settings/Names");
+   TOdbNode*                node  = fOdb->FindPath("/Equipment/Epics/Settings/Names");
    std::vector<std::string> names = fOdb->ReadStringArray(node);
    TEpicsFrag::SetEpicsNameList(names);
-#endif
 }
 
 void TMidasFile::SetGRIFFOdb()
 {
-#ifdef HAS_XML
    // get cycle information
    // "/Experiment/Edit on start/PPG Cycle" is a link to the PPG cycle used (always "/PPG/Current"???)
    // "/PPG/Current" gives the current PPG cycle used, e.g. 146Cs_S1468
    // "/PPG/Cycles/146Cs_S1468" then has N PPGcodes and N durations, where N is in most cases 4
-   TXMLNode*   node = fOdb->FindPath("/PPG/Current");
+   TOdbNode*   node = fOdb->FindPath("/PPG/Current");
    std::string temp;
    if(node == nullptr) {
       std::cerr << R"(Failed to find "/PPG/Current" in ODB!)" << std::endl;
       return;
    }
 
-   if(!node->HasChildren()) {
-      std::cout << "Node has no children, can't read ODB cycle" << std::endl;
+   if(node->GetText() == nullptr || node->GetText()[0] == '\0') {
+      std::cout << "Node has no text, can't read ODB cycle" << std::endl;
       return;
    }
    std::string currentCycle = "/PPG/Cycles/";
-   currentCycle.append(node->GetChildren()->GetContent());
+   currentCycle.append(node->GetText());
    temp = currentCycle;
    temp.append("/PPGcodes");
    node = fOdb->FindPath(temp.c_str());
@@ -789,7 +797,7 @@ void TMidasFile::SetGRIFFOdb()
       return;
    }
 
-   TPPG::Get()->SetOdbCycle(ppgCodes, durations);
+   TOdbCache::Get()->SetOdbCycle(ppgCodes, durations);
 
    if(TGRSIOptions::Get()->IgnoreOdbChannels()) {
       std::cout << DYELLOW << "\tskipping odb channel information stored in file." << RESET_COLOR << std::endl;
@@ -881,23 +889,21 @@ void TMidasFile::SetGRIFFOdb()
    } else {
       std::cout << BG_WHITE DRED << "problem parsing odb data, arrays are different sizes, channels not set." << RESET_COLOR << std::endl;
    }
-#endif
 }
 
 void TMidasFile::SetTIGOdb()
 {
-#ifdef HAS_XML
    std::string                                        typepath = "/Equipment/Trigger/settings/Detector Settings";
    std::map<int, std::pair<std::string, std::string>> typemap;
-   TXMLNode*                                          typenode    = fOdb->FindPath(typepath.c_str());
+   TOdbNode*                                          typenode    = fOdb->FindPath(typepath.c_str());
    int                                                typecounter = 0;
    if(typenode->HasChildren()) {
-      TXMLNode* typechild = typenode->GetChildren();
+      TOdbNode* typechild = typenode->GetChildren();
       while(true) {
          std::string tname = fOdb->GetNodeName(typechild);
          if(tname.length() > 0 && typechild->HasChildren()) {
             typecounter++;
-            TXMLNode* grandchild = typechild->GetChildren();
+            TOdbNode* grandchild = typechild->GetChildren();
             while(true) {
                std::string grandchildname = fOdb->GetNodeName(grandchild);
                if(grandchildname.compare(0, 7, "Digitis") == 0) {
@@ -919,7 +925,7 @@ void TMidasFile::SetTIGOdb()
    }
 
    std::string path = "/Analyzer/Shared Parameters/Config";
-   TXMLNode*   test = fOdb->FindPath(path.c_str());
+   TOdbNode*   test = fOdb->FindPath(path.c_str());
    if(test == nullptr) {
       path.assign("/Analyzer/Parameters/Cathode/Config");   // the old path to the useful odb info.
    }
@@ -927,7 +933,7 @@ void TMidasFile::SetTIGOdb()
 
    std::string temp = path;
    temp.append("/FSCP");
-   TXMLNode*        node    = fOdb->FindPath(temp.c_str());
+   TOdbNode*        node    = fOdb->FindPath(temp.c_str());
    std::vector<int> address = fOdb->ReadIntArray(node);
 
    temp = path;
@@ -991,12 +997,10 @@ void TMidasFile::SetTIGOdb()
       TChannel::AddChannel(tempChan, "overwrite");
    }
    std::cout << TChannel::GetNumberOfChannels() << "\t TChannels created." << std::endl;
-#endif
 }
 
 void TMidasFile::SetTIGDAQOdb()   // Basically a copy of the GRIFFIN one without the PPG (as we don't have one) and digitizer <P/M>SC key which is not in TIGDAQ
 {
-#ifdef HAS_XML
    // get calibrations
    // check if we can find new /DAQ/PSC path, otherwise default back to old /DAQ/MSC path
    std::string path = "/DAQ/PSC";
@@ -1013,7 +1017,7 @@ void TMidasFile::SetTIGDAQOdb()   // Basically a copy of the GRIFFIN one without
       temp = path;
       temp.append("/MSC");
    }
-   TXMLNode*        node    = fOdb->FindPath(temp.c_str());
+   TOdbNode*        node    = fOdb->FindPath(temp.c_str());
    std::vector<int> address = fOdb->ReadIntArray(node);
 
    temp = path;
@@ -1076,7 +1080,6 @@ void TMidasFile::SetTIGDAQOdb()   // Basically a copy of the GRIFFIN one without
    } else {
       std::cout << BG_WHITE DRED << "problem parsing odb data, arrays are different sizes, channels not set." << RESET_COLOR << std::endl;
    }
-#endif
 }
 
 // end
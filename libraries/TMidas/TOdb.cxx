@@ -0,0 +1,321 @@
+#include "TOdb.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "TXMLOdb.h"
+#include "TJSONOdb.h"
+
+TOdb* TOdb::Create(char* buffer, int size)
+{
+   /// Checks the first character that is not whitespace: '{' means a JSON dump, anything else an XML dump. If the buffer
+   /// is a file name, the first character of the file is used instead.
+   auto firstCharacter = [](const char* begin, const char* end) {
+      while(begin < end && std::isspace(static_cast<unsigned char>(*begin)) != 0) {
+         ++begin;
+      }
+      return (begin < end) ? *begin : '\0';
+   };
+
+   const char* end       = (size == 0) ? buffer + std::strlen(buffer) : buffer + size;
+   char        character = firstCharacter(buffer, end);
+   if(character != '{' && character != '<' && end - buffer < 4096) {
+      std::ifstream input(std::string(buffer, strnlen(buffer, end - buffer)));
+      if(input.is_open()) {
+         input >> std::ws;
+         character = static_cast<char>(input.peek());
+      }
+   }
+
+   if(character == '{') {
+      return new TJSONOdb(buffer, size);
+   }
+   return new TXMLOdb(buffer, size);
+}
+
+Long64_t TOdb::ToInteger(const char* text)
+{
+   if(text == nullptr) {
+      return 0;
+   }
+   while(std::isspace(static_cast<unsigned char>(*text)) != 0) {
+      ++text;
+   }
+   if(text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+      return static_cast<Long64_t>(std::strtoull(text + 2, nullptr, 16));
+   }
+   return std::strtoll(text, nullptr, 10);
+}
+
+void TOdb::SetBuffer(const char* buffer, int size)
+{
+   /// Copies the buffer, or if the buffer is a file name (which it always is if the size is zero) reads the file.
+   fBuffer.clear();
+   fNodes.clear();
+   fValues.clear();
+   fStoredText.clear();
+   fIndex.clear();
+   fRoot = nullptr;
+
+   // trim null-characters from the end of the buffer
+   while(size > 0 && buffer[size - 1] == '\0') {
+      --size;
+   }
+
+   size_t nameLength = (size == 0) ? std::strlen(buffer) : strnlen(buffer, size);
+   if(nameLength < 4096) {
+      std::ifstream input(std::string(buffer, nameLength), std::ios::in | std::ios::binary);
+      if(input.is_open()) {
+         fBuffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+         while(!fBuffer.empty() && fBuffer.back() == '\0') {
+            fBuffer.pop_back();
+         }
+      }
+   }
+   if(fBuffer.empty()) {
+      fBuffer.assign(buffer, buffer + size);
+   }
+   fBuffer.push_back('\0');
+}
+
+TOdbNode* TOdb::AddNode(TOdbNode* parent, TOdbNode::EType type, const char* name)
+{
+   /// Adds a new node as last child of the parent (or as root node if the parent is a null pointer) and adds it to the index.
+   fNodes.emplace_back();
+   TOdbNode* node = &fNodes.back();
+   node->fType    = type;
+   node->fName    = name;
+   node->fParent  = parent;
+   if(parent == nullptr) {
+      fRoot = node;
+   } else {
+      node->fPath.reserve(parent->fPath.size() + 1 + std::strlen(name));
+      node->fPath.append(parent->fPath).append(1, '/').append(name);
+      if(parent->fLastChild == nullptr) {
+         parent->fFirstChild = node;
+      } else {
+         parent->fLastChild->fNextNode = node;
+      }
+      parent->fLastChild = node;
+   }
+   // if a path is duplicated, we keep the first node (like a search of the tree would find it)
+   fIndex.emplace(node->fPath, node);
+
+   return node;
+}
+
+void TOdb::ResizeArray(TOdbNode* node, size_t nofValues)
+{
+   /// Reserves nofValues values for the key array node, all values are initialized as null pointers.
+   node->fType       = TOdbNode::EType::kKeyArray;
+   node->fFirstValue = fValues.size();
+   node->fNofValues  = nofValues;
+   fValues.resize(fValues.size() + nofValues, nullptr);
+}
+
+void TOdb::SetValue(TOdbNode* node, size_t index, const char* value)
+{
+   /// Sets the value with the index of the key array node. If the index is beyond the current size of the array and
+   /// this is the last array that was added, the array is extended, otherwise the value is ignored.
+   if(node->fType != TOdbNode::EType::kKeyArray) {
+      ResizeArray(node, 0);
+   }
+   if(index >= node->fNofValues) {
+      if(node->fFirstValue + node->fNofValues != fValues.size()) {
+         return;
+      }
+      fValues.resize(node->fFirstValue + index + 1, nullptr);
+      node->fNofValues = index + 1;
+   }
+   fValues[node->fFirstValue + index] = value;
+}
+
+const char* TOdb::StoreText(const char* text, size_t length)
+{
+   fStoredText.emplace_back(text, length);
+   return fStoredText.back().c_str();
+}
+
+const char* TOdb::Value(const TOdbNode* node, size_t index) const
+{
+   /// Returns the index-th value of a key array, or the text of a key (which is treated like an array with a single value).
+   if(node->fType == TOdbNode::EType::kKey) {
+      return node->fText;
+   }
+   return fValues[node->fFirstValue + index];
+}
+
+size_t TOdb::NumberOfValues(const TOdbNode* node)
+{
+   /// Returns the number of values of a key array (one for a key, zero for a directory).
+   switch(node->fType) {
+   case TOdbNode::EType::kKey: return 1;
+   case TOdbNode::EType::kKeyArray: return node->fNofValues;
+   default: return 0;
+   }
+}
+
+TOdbNode* TOdb::FindNode(const char* name, TOdbNode* node) const
+{
+   /// Finds the child of the node with name "name". If the provided node is a null pointer the root node is used instead.
+   /// Returns a null pointer if the search fails.
+   if(node == nullptr) {
+      node = fRoot;
+   }
+   if(node == nullptr || name == nullptr) {
+      return nullptr;
+   }
+   std::string path;
+   path.reserve(node->fPath.size() + 1 + std::strlen(name));
+   path.append(node->fPath).append(1, '/').append(name);
+   auto it = fIndex.find(path);
+   if(it == fIndex.end()) {
+      return nullptr;
+   }
+   return it->second;
+}
+
+TOdbNode* TOdb::FindPath(const char* path, TOdbNode* node) const
+{
+   /// Find path "path" under the provided node. If the node is a null pointer the root node is used instead.
+   if(node == nullptr) {
+      node = fRoot;
+   }
+   if(node == nullptr || path == nullptr) {
+      return nullptr;
+   }
+
+   std::string_view relative(path);
+   while(!relative.empty() && relative.front() == '/') {
+      relative.remove_prefix(1);
+   }
+   while(!relative.empty() && relative.back() == '/') {
+      relative.remove_suffix(1);
+   }
+   if(relative.empty()) {
+      return node;
+   }
+
+   std::string fullPath;
+   fullPath.reserve(node->fPath.size() + 1 + relative.size());
+   fullPath.append(node->fPath).append(1, '/').append(relative);
+   auto it = fIndex.find(fullPath);
+   if(it == fIndex.end()) {
+      return nullptr;
+   }
+   return it->second;
+}
+
+int TOdb::ReadInt(const char* path, int index, int defaultValue) const
+{
+   /// Reads the value of the key (or the index-th value of the key array) at path "path", returns defaultValue if that fails.
+   TOdbNode* node = FindPath(path);
+   if(node == nullptr) {
+      return defaultValue;
+   }
+   if(index < 0 || static_cast<size_t>(index) >= NumberOfValues(node)) {
+      return defaultValue;
+   }
+   const char* text = Value(node, index);
+   if(text == nullptr) {
+      return defaultValue;
+   }
+   return static_cast<int>(ToInteger(text));
+}
+
+std::vector<int> TOdb::ReadIntArray(TOdbNode* node) const
+{
+   /// Reads and returns an array of integers.
+   std::vector<int> temp;
+   if(node == nullptr) {
+      return temp;
+   }
+   temp.resize(NumberOfValues(node), 0);
+   for(size_t i = 0; i < temp.size(); ++i) {
+      const char* value = Value(node, i);
+      if(value != nullptr) {
+         // DWORDs can be larger than the maximum int, so we convert from a 64-bit integer (which is what atoi does as well)
+         temp[i] = static_cast<int>(ToInteger(value));
+      }
+   }
+   return temp;
+}
+
+std::vector<double> TOdb::ReadDoubleArray(TOdbNode* node) const
+{
+   /// Reads and returns an array of doubles.
+   std::vector<double> temp;
+   if(node == nullptr) {
+      return temp;
+   }
+   temp.resize(NumberOfValues(node), 0.);
+   for(size_t i = 0; i < temp.size(); ++i) {
+      const char* value = Value(node, i);
+      if(value != nullptr) {
+         temp[i] = std::strtod(value, nullptr);
+      }
+   }
+   return temp;
+}
+
+std::vector<std::string> TOdb::ReadStringArray(TOdbNode* node) const
+{
+   /// Reads and returns an array of strings.
+   std::vector<std::string> temp;
+   if(node == nullptr) {
+      return temp;
+   }
+   temp.resize(NumberOfValues(node));
+   for(size_t i = 0; i < temp.size(); ++i) {
+      const char* value = Value(node, i);
+      if(value != nullptr) {
+         temp[i].assign(value);
+      }
+   }
+   return temp;
+}
+
+uint64_t TOdb::Hash(const TOdbNode* node, uint64_t hash) const
+{
+   auto hashBytes = [&hash](const char* text, size_t length) {
+      for(size_t i = 0; i < length; ++i) {
+         hash ^= static_cast<unsigned char>(text[i]);
+         hash *= 1099511628211ULL;   // FNV-1a prime
+      }
+   };
+   auto hashText = [&hashBytes](const char* text) {
+      // include the terminating null-character so that "ab" + "c" differs from "a" + "bc"
+      if(text == nullptr) {
+         hashBytes("\xff", 1);
+      } else {
+         hashBytes(text, std::strlen(text) + 1);
+      }
+   };
+
+   if(node == nullptr) {
+      hashBytes("\xfe", 1);
+      return hash;
+   }
+   hashText(node->fPath.c_str());
+   auto type = static_cast<char>(node->fType);
+   hashBytes(&type, 1);
+   switch(node->fType) {
+   case TOdbNode::EType::kKey:
+      hashText(node->fText);
+      break;
+   case TOdbNode::EType::kKeyArray:
+      for(size_t i = 0; i < node->fNofValues; ++i) {
+         hashText(Value(node, i));
+      }
+      break;
+   case TOdbNode::EType::kDir:
+      for(const TOdbNode* child = node->fFirstChild; child != nullptr; child = child->fNextNode) {
+         hash = Hash(child, hash);
+      }
+      break;
+   }
+   return hash;
+}
@@ -0,0 +1,222 @@
+#include "TOdbCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "TGRSIOptions.h"
+#include "TPPG.h"
+
+TOdbCache* TOdbCache::Get()
+{
+   static TOdbCache cache;
+   return &cache;
+}
+
+bool TOdbCache::Apply(uint64_t hash)
+{
+   /// Replaces the channels with the cached ones. The channels might have been changed since they were loaded (e.g. by
+   /// reading a calibration file), so this is done even if the current channels were created from an ODB with the same
+   /// hash. Only if the user setting "OdbCache.KeepChannels" is set, and no channels have been added or removed since
+   /// they were loaded, the current channels are kept as they are.
+   fHasPending = false;
+
+   bool freshChannels = false;   // set if the channels have just been read from disk
+   auto entry         = fEntries.find(hash);
+   if(entry == fEntries.end()) {
+      TEntry fromDisk;
+      if(!ReadFromDisk(hash, fromDisk)) {
+         ++fMisses;
+         return false;
+      }
+      entry = fEntries.emplace(hash, std::move(fromDisk)).first;
+      // reading the cal-file already created the channels
+      fHasLoaded      = true;
+      fLoadedHash     = hash;
+      fLoadedChannels = TChannel::GetNumberOfChannels();
+      freshChannels   = true;
+   }
+   ++fHits;
+
+   if(entry->second.fHasCycle) {
+      TPPG::Get()->SetOdbCycle(entry->second.fPPGCodes, entry->second.fDurations);
+   }
+   if(freshChannels) {
+      return true;
+   }
+   if(KeepChannels() && fHasLoaded && fLoadedHash == hash && TChannel::GetNumberOfChannels() == fLoadedChannels) {
+      return true;
+   }
+   RestoreChannels(entry->second);
+   fHasLoaded      = true;
+   fLoadedHash     = hash;
+   fLoadedChannels = TChannel::GetNumberOfChannels();
+
+   return true;
+}
+
+void TOdbCache::Begin(uint64_t hash)
+{
+   fPending     = TEntry();
+   fPendingHash = hash;
+   fHasPending  = true;
+   fHasLoaded   = false;
+}
+
+void TOdbCache::SetOdbCycle(const std::vector<int16_t>& ppgCodes, const std::vector<int>& durations)
+{
+   TPPG::Get()->SetOdbCycle(ppgCodes, durations);
+   if(fHasPending) {
+      fPending.fHasCycle  = true;
+      fPending.fPPGCodes  = ppgCodes;
+      fPending.fDurations = durations;
+   }
+}
+
+void TOdbCache::Commit()
+{
+   if(!fHasPending) {
+      return;
+   }
+   fHasPending = false;
+
+   CopyChannels(fPending);
+   WriteToDisk(fPendingHash, fPending);
+   fHasLoaded      = true;
+   fLoadedHash     = fPendingHash;
+   fLoadedChannels = TChannel::GetNumberOfChannels();
+
+   fEntries[fPendingHash] = std::move(fPending);
+}
+
+void TOdbCache::Clear()
+{
+   fEntries.clear();
+   fHasPending = false;
+   fHasLoaded  = false;
+}
+
+void TOdbCache::CopyChannels(TEntry& entry)
+{
+   entry.fChannels.clear();
+   if(TChannel::GetChannelMap() == nullptr) {
+      return;
+   }
+   entry.fChannels.reserve(TChannel::GetChannelMap()->size());
+   for(const auto& iter : *(TChannel::GetChannelMap())) {
+      entry.fChannels.emplace_back(new TChannel(*iter.second));
+   }
+}
+
+void TOdbCache::RestoreChannels(const TEntry& entry)
+{
+   TChannel::DeleteAllChannels();
+   for(const auto& channel : entry.fChannels) {
+      TChannel::AddChannel(new TChannel(*channel), "overwrite");
+   }
+}
+
+std::string TOdbCache::Directory() const
+{
+   std::string directory;
+   if(TGRSIOptions::Get() == nullptr || TGRSIOptions::UserSettings() == nullptr) {
+      return directory;
+   }
+   try {
+      directory = TGRSIOptions::UserSettings()->GetString("OdbCache.Directory", true);
+   } catch(std::out_of_range&) {}
+   return directory;
+}
+
+bool TOdbCache::KeepChannels() const
+{
+   bool keep = false;
+   if(TGRSIOptions::Get() == nullptr || TGRSIOptions::UserSettings() == nullptr) {
+      return keep;
+   }
+   try {
+      keep = TGRSIOptions::UserSettings()->GetBool("OdbCache.KeepChannels", true);
+   } catch(std::out_of_range&) {}
+   return keep;
+}
+
+std::string TOdbCache::FileName(uint64_t hash, const char* extension) const
+{
+   /// The format version is part of the name, so files written in an older format are never read.
+   std::string directory = Directory();
+   if(directory.empty()) {
+      return directory;
+   }
+   char name[40];
+   snprintf(name, sizeof(name), "/odb_v%d_%016llx.", kFormatVersion, static_cast<unsigned long long>(hash));   // NOLINT(cppcoreguidelines-pro-type-vararg)
+   return directory + name + extension;
+}
+
+bool TOdbCache::ReadFromDisk(uint64_t hash, TEntry& entry) const
+{
+   /// Reads the channels and PPG cycle written by WriteToDisk. This replaces the current channel table.
+   std::string calFile = FileName(hash, "cal");
+   if(calFile.empty()) {
+      return false;
+   }
+   std::ifstream calInput(calFile);
+   if(!calInput.is_open()) {
+      return false;
+   }
+   calInput.close();
+
+   std::ifstream ppgInput(FileName(hash, "ppg"));
+   if(ppgInput.is_open()) {
+      int16_t code     = 0;
+      int     duration = 0;
+      while(ppgInput >> code >> duration) {
+         entry.fPPGCodes.push_back(code);
+         entry.fDurations.push_back(duration);
+      }
+      entry.fHasCycle = !entry.fPPGCodes.empty();
+   }
+
+   TChannel::DeleteAllChannels();
+   if(TChannel::ReadCalFile(calFile.c_str()) < 0) {
+      std::cout << DYELLOW << "Failed to read cached channels from " << calFile << ", ignoring the cache." << RESET_COLOR << std::endl;
+      TChannel::DeleteAllChannels();
+      return false;
+   }
+   CopyChannels(entry);
+   std::cout << "Read " << entry.fChannels.size() << " cached channels from " << calFile << std::endl;
+
+   return true;
+}
+
+void TOdbCache::WriteToDisk(uint64_t hash, const TEntry& entry) const
+{
+   /// Writes the current channel table as cal-file, and the PPG cycle of the entry as text file. Files are first
+   /// written under a temporary name and then renamed, so concurrent jobs never read an incomplete file.
+   std::string calFile = FileName(hash, "cal");
+   if(calFile.empty()) {
+      return;
+   }
+   std::ifstream existing(calFile);
+   if(existing.is_open()) {
+      return;
+   }
+
+   if(entry.fHasCycle) {
+      std::string ppgFile = FileName(hash, "ppg");
+      std::string tmpFile = ppgFile + ".tmp";
+      {
+         std::ofstream output(tmpFile);
+         for(size_t i = 0; i < entry.fPPGCodes.size() && i < entry.fDurations.size(); ++i) {
+            output << entry.fPPGCodes[i] << " " << entry.fDurations[i] << std::endl;
+         }
+      }
+      std::rename(tmpFile.c_str(), ppgFile.c_str());
+   }
+
+   std::string tmpFile = calFile + ".tmp";
+   TChannel::WriteCalFile(tmpFile);
+   if(std::rename(tmpFile.c_str(), calFile.c_str()) != 0) {
+      std::cout << DYELLOW << "Failed to write channel cache " << calFile << RESET_COLOR << std::endl;
+   }
+}
@@ -0,0 +1,279 @@
+#include "TPipelineMetrics.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "TFile.h"
+
+#include "TGRSIOptions.h"
+
+std::atomic<bool> TPipelineMetrics::fEnabled{false};
+
+namespace {
+/// Counters of a single stage. Each thread has its own set, so only one thread ever writes to them,
+/// the atomics are only needed to allow the exporting thread to read them.
+struct TStageCounters {
+   std::atomic<uint64_t> fCalls{0};
+   std::atomic<uint64_t> fItems{0};
+   std::atomic<uint64_t> fTicks{0};
+};
+
+using TThreadCounters = std::array<TStageCounters, static_cast<size_t>(TPipelineMetrics::EStage::kNumberOfStages)>;
+
+std::mutex                                    gThreadMutex;
+std::vector<std::unique_ptr<TThreadCounters>> gThreadCounters;
+thread_local TThreadCounters*                 gLocalCounters = nullptr;
+
+uint64_t                              gStartTicks = 0;
+std::chrono::steady_clock::time_point gStartTime;
+std::atomic<uint64_t>                 gNextExport{0};
+
+TThreadCounters* RegisterThread()
+{
+   /// Creates the counters for the calling thread, this is the only time we need to lock.
+   std::lock_guard<std::mutex> lock(gThreadMutex);
+   gThreadCounters.emplace_back(new TThreadCounters);
+   return gThreadCounters.back().get();
+}
+
+bool IsSortOutputFile(const std::string& fileName)
+{
+   /// The output files of the sort are still being written when the metrics are written, so they must not be used.
+   /// Besides the names set in the options, this also catches the default names (fragmentXXXXX_XXX.root and
+   /// analysisXXXXX_XXX.root).
+   if(fileName == TGRSIOptions::Get()->OutputFragmentFile() || fileName == TGRSIOptions::Get()->OutputAnalysisFile()) {
+      return true;
+   }
+   std::string baseName = fileName.substr(fileName.find_last_of('/') + 1);   // npos + 1 = 0, i.e. the whole name
+   return baseName.compare(0, 8, "fragment") == 0 || baseName.compare(0, 8, "analysis") == 0;
+}
+
+void Add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+   // single writer, so a relaxed load and store is enough and avoids a locked instruction
+   counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+}   // namespace
+
+TPipelineMetrics* TPipelineMetrics::Get()
+{
+   static TPipelineMetrics metrics;
+   return &metrics;
+}
+
+TPipelineMetrics::TPipelineMetrics()
+   : TNamed("PipelineMetrics", "pipeline metrics of read/parse/queue stages")
+{
+   for(size_t i = 0; i < static_cast<size_t>(EStage::kNumberOfStages); ++i) {
+      fStageNames.emplace_back(StageName(static_cast<EStage>(i)));
+   }
+}
+
+void TPipelineMetrics::Configure()
+{
+   /// Reads the output file names and export interval from the user settings. The metrics are only enabled
+   /// if at least one of the output files is set.
+   auto* metrics = Get();
+   if(TGRSIOptions::Get() == nullptr || TGRSIOptions::UserSettings() == nullptr) {
+      return;
+   }
+   auto* settings = TGRSIOptions::UserSettings();
+   try {
+      metrics->fPrometheusFile = settings->GetString("PipelineMetrics.PrometheusFile", true);
+   } catch(std::out_of_range&) {}
+   try {
+      metrics->fRootFile = settings->GetString("PipelineMetrics.RootFile", true);
+   } catch(std::out_of_range&) {}
+   if(!metrics->fRootFile.empty() && IsSortOutputFile(metrics->fRootFile)) {
+      std::cerr << "PipelineMetrics.RootFile \"" << metrics->fRootFile << "\" is an output file of the sort, which can't be written to at the same time. Not writing the metrics to a ROOT file!" << std::endl;
+      metrics->fRootFile.clear();
+   }
+   try {
+      metrics->fInterval = settings->GetDouble("PipelineMetrics.Interval", true);
+   } catch(std::out_of_range&) {}
+
+   if(!fEnabled && (!metrics->fPrometheusFile.empty() || !metrics->fRootFile.empty())) {
+      gStartTicks = Ticks();
+      gStartTime  = std::chrono::steady_clock::now();
+      fEnabled    = true;
+   }
+}
+
+void TPipelineMetrics::Record(EStage stage, uint64_t ticks, uint64_t items)
+{
+   if(gLocalCounters == nullptr) {
+      gLocalCounters = RegisterThread();
+   }
+   auto& counters = (*gLocalCounters)[static_cast<size_t>(stage)];
+   Add(counters.fCalls, 1);
+   Add(counters.fItems, items);
+   Add(counters.fTicks, ticks);
+}
+
+const char* TPipelineMetrics::StageName(EStage stage)
+{
+   switch(stage) {
+   case EStage::kRead: return "read";
+   case EStage::kParseWFDN: return "parse_wfdn";
+   case EStage::kParseGRF1: return "parse_grf1";
+   case EStage::kParseGRF2: return "parse_grf2";
+   case EStage::kParseGRF3: return "parse_grf3";
+   case EStage::kParseGRF4: return "parse_grf4";
+   case EStage::kParseCAEN: return "parse_caen";
+   case EStage::kParseCPHA: return "parse_cpha";
+   case EStage::kParseMADC: return "parse_madc";
+   case EStage::kParseEMMT: return "parse_emmt";
+   case EStage::kParseSRAW: return "parse_sraw";
+   case EStage::kParseSSUM: return "parse_ssum";
+   case EStage::kParseMSRD: return "parse_msrd";
+   case EStage::kParseOther: return "parse_other";
+   case EStage::kPushGood: return "push_good";
+   case EStage::kPushBad: return "push_bad";
+   case EStage::kOdbEndOfRun: return "odb_end_of_run";
+   default: return "unknown";
+   }
+}
+
+void TPipelineMetrics::Snapshot()
+{
+   /// Sums the counters of all threads. This can be called while other threads are still recording,
+   /// in which case the snapshot might miss the calls that are in flight.
+   size_t nofStages = static_cast<size_t>(EStage::kNumberOfStages);
+   fCalls.assign(nofStages, 0);
+   fItems.assign(nofStages, 0);
+   fTicks.assign(nofStages, 0);
+   fThreadTicks.clear();
+
+   std::lock_guard<std::mutex> lock(gThreadMutex);
+   for(auto& thread : gThreadCounters) {
+      fThreadTicks.emplace_back(nofStages, 0);
+      for(size_t i = 0; i < nofStages; ++i) {
+         fCalls[i] += (*thread)[i].fCalls.load(std::memory_order_relaxed);
+         fItems[i] += (*thread)[i].fItems.load(std::memory_order_relaxed);
+         fThreadTicks.back()[i] = (*thread)[i].fTicks.load(std::memory_order_relaxed);
+         fTicks[i] += fThreadTicks.back()[i];
+      }
+   }
+
+   // calibrate the ticks by comparing them to the steady clock since the metrics were enabled
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - gStartTime).count();
+   if(seconds > 0. && Ticks() > gStartTicks) {
+      fTicksPerSecond = static_cast<double>(Ticks() - gStartTicks) / seconds;
+   }
+}
+
+void TPipelineMetrics::PeriodicExport()
+{
+   /// Writes a Prometheus snapshot if the export interval has passed since the last one.
+   /// Only one thread will win the exchange of the next export time, all others return immediately.
+   if(!fEnabled || fPrometheusFile.empty()) {
+      return;
+   }
+   uint64_t now  = Ticks();
+   uint64_t next = gNextExport.load(std::memory_order_relaxed);
+   if(now < next) {
+      return;
+   }
+   auto interval = static_cast<uint64_t>(fInterval * fTicksPerSecond);
+   if(!gNextExport.compare_exchange_strong(next, now + interval)) {
+      return;
+   }
+   ExportPrometheus(fPrometheusFile);
+}
+
+void TPipelineMetrics::Finish()
+{
+   /// Writes the final snapshot of a sub-run to the Prometheus file (if it is set).
+   /// This is called from the parser thread, so it must not do any ROOT I/O, see EndOfRun for that.
+   if(!fEnabled || fPrometheusFile.empty()) {
+      return;
+   }
+   ExportPrometheus(fPrometheusFile);
+}
+
+void TPipelineMetrics::EndOfRun()
+{
+   /// Adds the final snapshot to the ROOT file (if it is set). This opens the ROOT file, so it must
+   /// only be called once all reading and parsing threads are done (i.e. from the main thread).
+   if(!fEnabled || fRootFile.empty()) {
+      return;
+   }
+   WriteToRootFile(fRootFile);
+}
+
+bool TPipelineMetrics::ExportPrometheus(const std::string& fileName)
+{
+   /// Writes a snapshot in the Prometheus text exposition format. The snapshot is first written to a
+   /// temporary file which is then renamed, so a scraper never sees a partially written file.
+   Snapshot();
+
+   std::string   tmpName = fileName + ".tmp";
+   std::ofstream output(tmpName);
+   if(!output.is_open()) {
+      std::cerr << "Failed to open \"" << tmpName << "\" to write pipeline metrics!" << std::endl;
+      return false;
+   }
+
+   output << "# HELP grsidata_stage_calls_total Number of calls of each pipeline stage." << std::endl
+          << "# TYPE grsidata_stage_calls_total counter" << std::endl;
+   for(size_t i = 0; i < fCalls.size(); ++i) {
+      output << "grsidata_stage_calls_total{stage=\"" << fStageNames[i] << "\"} " << fCalls[i] << std::endl;
+   }
+   output << "# HELP grsidata_stage_items_total Number of items (bytes read or fragments) of each pipeline stage." << std::endl
+          << "# TYPE grsidata_stage_items_total counter" << std::endl;
+   for(size_t i = 0; i < fItems.size(); ++i) {
+      output << "grsidata_stage_items_total{stage=\"" << fStageNames[i] << "\"} " << fItems[i] << std::endl;
+   }
+   output << "# HELP grsidata_stage_seconds_total Time spent in each pipeline stage per thread." << std::endl
+          << "# TYPE grsidata_stage_seconds_total counter" << std::endl;
+   for(size_t t = 0; t < fThreadTicks.size(); ++t) {
+      for(size_t i = 0; i < fThreadTicks[t].size(); ++i) {
+         output << "grsidata_stage_seconds_total{stage=\"" << fStageNames[i] << "\",thread=\"" << t << "\"} " << static_cast<double>(fThreadTicks[t][i]) / fTicksPerSecond << std::endl;
+      }
+   }
+   output.close();
+
+   if(std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+      std::cerr << "Failed to rename \"" << tmpName << "\" to \"" << fileName << "\"!" << std::endl;
+      return false;
+   }
+   return true;
+}
+
+bool TPipelineMetrics::WriteToRootFile(const std::string& fileName)
+{
+   /// Adds the current snapshot to the ROOT file (overwriting any previous snapshot).
+   Snapshot();
+
+   TDirectory* oldDir = gDirectory;
+   TFile       file(fileName.c_str(), "update");
+   if(file.IsZombie()) {
+      std::cerr << "Failed to open \"" << fileName << "\" to write pipeline metrics!" << std::endl;
+      oldDir->cd();
+      return false;
+   }
+   file.cd();
+   Write(GetName(), TObject::kOverwrite);
+   file.Close();
+   oldDir->cd();
+
+   return true;
+}
+
+void TPipelineMetrics::Print(Option_t*) const
+{
+   std::cout << GetTitle() << " (" << fThreadTicks.size() << " threads, " << fTicksPerSecond << " ticks/s):" << std::endl;
+   std::cout << std::setw(16) << "stage" << std::setw(16) << "calls" << std::setw(20) << "items" << std::setw(16) << "seconds" << std::endl;
+   for(size_t i = 0; i < fCalls.size(); ++i) {
+      if(fCalls[i] == 0) { continue; }
+      std::cout << std::setw(16) << fStageNames[i] << std::setw(16) << fCalls[i] << std::setw(20) << fItems[i] << std::setw(16) << static_cast<double>(fTicks[i]) / fTicksPerSecond << std::endl;
+   }
+}
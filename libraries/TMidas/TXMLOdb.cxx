@@ -1,268 +1,251 @@
-#ifdef HAS_XML
-
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
 
 #include "TXMLOdb.h"
 
-#include "TList.h"
-#include "TXMLAttr.h"
-
-std::array<char, 256> TXMLOdb::fTextBuffer;
-
 TXMLOdb::TXMLOdb(char* buffer, int size)
-   : fDoc(nullptr), fParser(new TDOMParser), fOdb(nullptr)
 {
    /// Creator, tries to open buffer as input file and parse it, if that fails, parses size bytes of the buffer.
-
-   // trim empty new-line from end of buffer if needed
-   while(buffer[size - 1] == '\0') {
-      // std::cout << "Found null-character at " << size - 1 << ", decrementing size from " << size;
-      --size;
-      // std::cout << " to " << size << std::endl;
-   }
-   std::ifstream input;
-   input.open(buffer);
-   fParser->SetValidate(false);
-   if(input.is_open()) {
-      fParser->ParseFile(buffer);
-   } else {
-      std::string odb(buffer, size);
-      fParser->ParseBuffer(buffer, size);
-   }
-   input.close();
-   fDoc = fParser->GetXMLDocument();
-   if(fDoc == nullptr) {
-      throw std::runtime_error("XmlOdb::XmlOdb: Malformed ODB dump: cannot get XML document");
-   }
-   fOdb = fDoc->GetRootNode();
-   if(strcmp(fOdb->GetNodeName(), "odb") != 0) {
+   SetBuffer(buffer, size);
+   Parse();
+   if(Root() == nullptr) {
       throw std::runtime_error("XmlOdb::XmlOdb: Malformed ODB dump: cannot find <odb> tag");
    }
 }
 
-TXMLOdb::~TXMLOdb()
+void TXMLOdb::Parse()
 {
-   /// Default destructor, deletes the parser.
-   delete fParser;
-}
-
-TXMLNode* TXMLOdb::FindNode(const char* name, TXMLNode* node)
-{
-   /// Finds node with name "name". If a node is provided this node will be used as a starting point.
-   /// If the provided node is a null pointer fOdb is used instead. Returns a null pointer if the
-   /// search fails.
-   if(node == nullptr) {
-      if(fOdb == nullptr) {
-         return nullptr;
-      }
-      node = fOdb;   //->GetChildren();
-   }
-   if(!node->HasChildren()) {
-      return nullptr;
-   }
-   node = node->GetChildren();
-   while(node != nullptr) {
-      std::string nodename = GetNodeName(node);
-      if(nodename == name) {
-         return node;
+   /// Parses the buffer in a single pass. Only the elements used in MIDAS ODB dumps are handled, all other elements
+   /// (and processing instructions or comments) are skipped. Text of keys and values is decoded in place and
+   /// null-terminated by overwriting the start of the closing tag.
+   static char emptyText[] = "";
+
+   char*     pos          = BufferBegin();
+   char*     end          = BufferEnd();
+   TOdbNode* current      = nullptr;   // innermost open odb, dir, key, or keyarray node
+   char*     text         = nullptr;   // start of the text of the currently open key or value
+   size_t    valueIndex   = 0;         // index of the currently open value of a key array
+   size_t    valueCounter = 0;         // index of the next value without an explicit index
+
+   while(pos < end) {
+      char* tag = static_cast<char*>(std::memchr(pos, '<', end - pos));
+      if(tag == nullptr) {
+         break;
       }
-      node = node->GetNextNode();
-   }
 
-   return nullptr;
-}
-
-TXMLNode* TXMLOdb::FindPath(const char* path, TXMLNode* node)
-{
-   /// Find path "path" under the provided node. If the node is a null pointer, fOdb is used instead.
-   if(node == nullptr) {
-      if(fOdb == nullptr) {
-         return nullptr;
+      if(tag[1] == '?' || tag[1] == '!') {
+         // processing instruction, comment, or declaration
+         pos = (std::strncmp(tag, "<!--", 4) == 0) ? std::strstr(tag + 4, "-->") : std::strchr(tag, '>');
+         if(pos == nullptr) {
+            break;
+         }
+         pos = std::strchr(pos, '>') + 1;
+         continue;
       }
-      node = fOdb;   //->GetChildren();
-   }
 
-   std::string              pathname = path;
-   std::vector<std::string> elems;
-   std::size_t              last  = 0;
-   std::size_t              slash = pathname.find_first_of('/');
-   if(slash == 0) {
-      last = 1;
-   }
-   while(true) {
-      slash = pathname.find_first_of('/', last);
-      elems.push_back(pathname.substr(last, slash - last));
-      last = slash + 1;
-      if(slash == std::string::npos) {
-         break;
+      if(tag[1] == '/') {
+         // closing tag
+         char*            nameEnd = ParseName(tag + 2);
+         std::string_view element(tag + 2, nameEnd - (tag + 2));
+         if(text != nullptr && current != nullptr) {
+            *DecodeEntities(text, tag) = '\0';
+            if(element == "key") {
+               SetText(current, text);
+            } else if(element == "value") {
+               SetValue(current, valueIndex, text);
+            }
+         }
+         text = nullptr;
+         if(current != nullptr && (element == "odb" || element == "dir" || element == "key" || element == "keyarray")) {
+            current = current->GetParent();
+         }
+         pos = std::strchr(nameEnd, '>');
+         if(pos == nullptr) {
+            break;
+         }
+         ++pos;
+         continue;
       }
-   }
 
-   for(auto& elem : elems) {
-      node = FindNode(elem.c_str(), node);
-      if(node != nullptr) {
-      } else {
-         node = nullptr;
-         break;
+      // opening tag, read all attributes we are interested in
+      char*            nameEnd = ParseName(tag + 1);
+      std::string_view element(tag + 1, nameEnd - (tag + 1));
+      const char*      name        = emptyText;
+      const char*      index       = nullptr;
+      size_t           numValues   = 0;
+      bool             selfClosing = false;
+      pos                          = nameEnd;
+      while(pos != nullptr) {
+         while(std::isspace(static_cast<unsigned char>(*pos)) != 0) {
+            ++pos;
+         }
+         if(*pos == '>') {
+            ++pos;
+            break;
+         }
+         if(*pos == '/') {
+            selfClosing = true;
+            pos         = std::strchr(pos, '>');
+            if(pos != nullptr) {
+               ++pos;
+            }
+            break;
+         }
+         char* attrName  = nullptr;
+         char* attrValue = nullptr;
+         pos             = ParseAttribute(pos, attrName, attrValue);
+         if(pos == nullptr) {
+            break;
+         }
+         if(std::strcmp(attrName, "name") == 0) {
+            name = attrValue;
+         } else if(std::strcmp(attrName, "num_values") == 0) {
+            numValues = std::strtoul(attrValue, nullptr, 10);
+         } else if(std::strcmp(attrName, "index") == 0) {
+            index = attrValue;
+         }
+      }
+      if(pos == nullptr) {
+         throw std::runtime_error("XmlOdb::XmlOdb: Malformed ODB dump: unterminated tag");
       }
-   }
-
-   return node;
-}
-
-const char* TXMLOdb::GetNodeName(TXMLNode* node)
-{
-   /// Returns the name of a node.
-   TList* list = node->GetAttributes();
-   if(list != nullptr) {
-      std::string buffer = (static_cast<TXMLAttr*>(list->At(0)))->GetValue();
-      strlcpy(fTextBuffer.data(), buffer.c_str(), fTextBuffer.size());
-      return fTextBuffer.data();
-   }
-   return "";
-}
-
-int TXMLOdb::ReadInt(const char* path, int, int defaultValue)
-{
-   /// tries to find the path "path", returns defaultValue if that fails, otherwise returns 0.
-   TXMLNode* node = FindPath(path);
-   if(node == nullptr) {
-      return defaultValue;
-   }
-   return 0;
-}
-
-std::vector<int> TXMLOdb::ReadIntArray(TXMLNode* node)
-{
-   /// Reads and returns an array of integers.
 
-   std::vector<int> temp;
-   if(node == nullptr) {
-      return temp;
-   }
-   if(!node->HasChildren()) {
-      return temp;
-   }
-   TList* list = node->GetAttributes();
-   if(list == nullptr) {
-      return temp;
-   }
-   TIter iter(list);
-   int   size = 0;
-   while(auto* attr = static_cast<TXMLAttr*>(iter.Next())) {
-      if(strcmp(attr->GetName(), "num_values") == 0) {
-         size = atoi(attr->GetValue());
+      text = nullptr;
+      if(element == "odb") {
+         if(current == nullptr && Root() == nullptr) {
+            current = AddNode(nullptr, TOdbNode::EType::kDir, emptyText);
+         }
+         continue;
       }
-   }
-   temp.assign(size, 0);
-   TXMLNode* child   = node->GetChildren();
-   int       counter = 0;
-   while(true) {
-      if(TList* index = child->GetAttributes()) {
-         int indexnum      = atoi((static_cast<TXMLAttr*>(index->At(0)))->GetValue());
-         int value         = atoi(child->GetText());
-         temp.at(indexnum) = value;
-      } else if(child->GetText() != nullptr) {
-         int indexnum      = counter++;
-         temp.at(indexnum) = atoi(child->GetText());
+      if(current == nullptr) {
+         // anything outside of the odb element is ignored
+         continue;
       }
-      child = child->GetNextNode();
-      if(child == nullptr) {
-         break;
+      if(element == "dir") {
+         current = AddNode(current, TOdbNode::EType::kDir, name);
+         if(selfClosing) {
+            current = current->GetParent();
+         }
+      } else if(element == "key") {
+         current = AddNode(current, TOdbNode::EType::kKey, name);
+         if(selfClosing) {
+            SetText(current, emptyText);
+            current = current->GetParent();
+         } else {
+            text = pos;
+         }
+      } else if(element == "keyarray") {
+         current = AddNode(current, TOdbNode::EType::kKeyArray, name);
+         ResizeArray(current, numValues);
+         valueCounter = 0;
+         if(selfClosing) {
+            current = current->GetParent();
+         }
+      } else if(element == "value") {
+         valueIndex = (index != nullptr) ? std::strtoul(index, nullptr, 10) : valueCounter++;
+         if(selfClosing) {
+            SetValue(current, valueIndex, emptyText);
+         } else {
+            text = pos;
+         }
       }
    }
-   return temp;
 }
 
-std::vector<std::string> TXMLOdb::ReadStringArray(TXMLNode* node)
+char* TXMLOdb::ParseName(char* pos)
 {
-   /// Reads and returns an array of strings.
+   /// Returns the end of the element or attribute name starting at pos.
+   while(*pos != '\0' && *pos != '=' && *pos != '>' && *pos != '/' && std::isspace(static_cast<unsigned char>(*pos)) == 0) {
+      ++pos;
+   }
+   return pos;
+}
 
-   std::vector<std::string> temp;
-   if(node == nullptr) {
-      return temp;
+char* TXMLOdb::ParseAttribute(char* pos, char*& name, char*& value)
+{
+   /// Parses the attribute starting at pos, null-terminates and decodes its name and value in place, and returns the
+   /// position after the attribute (or a null pointer if the attribute is malformed).
+   name          = pos;
+   char* nameEnd = ParseName(pos);
+   pos           = nameEnd;
+   while(std::isspace(static_cast<unsigned char>(*pos)) != 0) {
+      ++pos;
+   }
+   if(*pos != '=') {
+      return nullptr;
    }
-   if(!node->HasChildren()) {
-      return temp;
+   ++pos;
+   while(std::isspace(static_cast<unsigned char>(*pos)) != 0) {
+      ++pos;
    }
-   TList* list = node->GetAttributes();
-   if(list == nullptr) {
-      return temp;
+   if(*pos != '"' && *pos != '\'') {
+      return nullptr;
    }
-   TIter iter(list);
-   int   size = 0;
-   while(auto* attr = static_cast<TXMLAttr*>(iter.Next())) {
-      if(strcmp(attr->GetName(), "num_values") == 0) {
-         size = atoi(attr->GetValue());
-      }
+   value          = pos + 1;
+   char* valueEnd = std::strchr(value, *pos);
+   if(valueEnd == nullptr) {
+      return nullptr;
    }
-   temp.assign(size, "");
-   TXMLNode* child   = node->GetChildren();
-   int       counter = 0;
-   while(true) {
-      if(TList* index = child->GetAttributes()) {
-         int         indexnum = atoi((static_cast<TXMLAttr*>(index->At(0)))->GetValue());
-         const char* value    = child->GetText();
+   // the name is followed by either whitespace or the '=' we already parsed, so we can overwrite it
+   *nameEnd                          = '\0';
+   *DecodeEntities(value, valueEnd) = '\0';
 
-         // Make sure we actually read a word
-         std::string value_str;
-         if(value == nullptr) {
-            value_str = "";
-         } else {
-            value_str = value;
-         }
-         temp.at(indexnum) = value_str;
-      } else if(child->GetText() != nullptr) {
-         int indexnum = counter++;
-         temp.at(indexnum).assign(child->GetText());
-      }
-      child = child->GetNextNode();
-      if(child == nullptr) {
-         break;
-      }
-   }
-   return temp;
+   return valueEnd + 1;
 }
 
-std::vector<double> TXMLOdb::ReadDoubleArray(TXMLNode* node)
+char* TXMLOdb::DecodeEntities(char* begin, char* end)
 {
-   /// Reads and returns an array of doubles.
-
-   std::vector<double> temp;
-   if(node == nullptr) {
-      return temp;
-   }
-   if(!node->HasChildren()) {
-      return temp;
-   }
-   TList* list = node->GetAttributes();
-   if(list == nullptr) {
-      return temp;
-   }
-   TIter iter(list);
-   int   size = 0;
-   while(auto* attr = static_cast<TXMLAttr*>(iter.Next())) {
-      if(strcmp(attr->GetName(), "num_values") == 0) {
-         size = atoi(attr->GetValue());
+   /// Replaces the XML entities between begin and end in place and returns the new end. The decoded text is never longer
+   /// than the original text. Character references below 256 are kept as a single byte (MIDAS writes ISO-8859-1), larger
+   /// ones are encoded as UTF-8.
+   char* out = begin;
+   for(char* in = begin; in < end;) {
+      if(*in != '&') {
+         *out++ = *in++;
+         continue;
       }
-   }
-   temp.assign(size, 0.0);
-   TXMLNode* child   = node->GetChildren();
-   int       counter = 0;
-   while(true) {
-      if(TList* index = child->GetAttributes()) {
-         int    indexnum   = atoi((static_cast<TXMLAttr*>(index->At(0)))->GetValue());
-         double value      = atof(child->GetText());
-         temp.at(indexnum) = value;
-      } else if(child->GetText() != nullptr) {
-         int indexnum      = counter++;
-         temp.at(indexnum) = atof(child->GetText());
+      auto* semicolon = static_cast<char*>(std::memchr(in, ';', std::min<ptrdiff_t>(end - in, 12)));
+      if(semicolon == nullptr) {
+         *out++ = *in++;
+         continue;
       }
-      child = child->GetNextNode();
-      if(child == nullptr) {
-         break;
+      std::string_view entity(in + 1, semicolon - in - 1);
+      if(entity == "amp") {
+         *out++ = '&';
+      } else if(entity == "lt") {
+         *out++ = '<';
+      } else if(entity == "gt") {
+         *out++ = '>';
+      } else if(entity == "quot") {
+         *out++ = '"';
+      } else if(entity == "apos") {
+         *out++ = '\'';
+      } else if(entity.size() > 1 && entity[0] == '#') {
+         uint32_t code = (entity[1] == 'x' || entity[1] == 'X') ? std::strtoul(in + 3, nullptr, 16) : std::strtoul(in + 2, nullptr, 10);
+         if(code < 0x100) {
+            *out++ = static_cast<char>(code);
+         } else if(code < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         } else if(code < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (code >> 12));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         } else {
+            *out++ = static_cast<char>(0xf0 | ((code >> 18) & 0x7));
+            *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (code & 0x3f));
+         }
+      } else {
+         // unknown entity, keep it as it is
+         *out++ = *in++;
+         continue;
       }
+      in = semicolon + 1;
    }
-   return temp;
+   return out;
 }
-#endif
@@ -6,12 +6,18 @@
 #include "TGRSIDataParser.h"
 #include "GRSIDataVersion.h"
 #include "TChannel.h"
+#include "TPipelineMetrics.h"
 
 extern "C" TMidasFile* CreateFile(std::string& fileName) { return new TMidasFile(fileName.c_str()); }
 extern "C" void        DestroyFile(TMidasFile* obj) { delete obj; }
 
 extern "C" TGRSIDataParser* CreateParser() { return new TGRSIDataParser; }
-extern "C" void             DestroyParser(TGRSIDataParser* obj) { delete obj; }
+extern "C" void             DestroyParser(TGRSIDataParser* obj)
+{
+   delete obj;
+   // the parser is destroyed once all threads are done, so this is the one place the metrics can be written to a ROOT file safely
+   TPipelineMetrics::Get()->EndOfRun();
+}
 
 extern "C" std::string LibraryVersion() { return {GRSIDATA_RELEASE}; }
 
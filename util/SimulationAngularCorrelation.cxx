@@ -7,7 +7,6 @@
 #include "TH2D.h"
 
 #include "Globals.h"
-#include "TRedirect.h"
 #include "TUserSettings.h"
 #include "TGriffin.h"
 #include "TGriffinBgo.h"
@@ -331,20 +330,14 @@ int main(int argc, char** argv)
                for(int g2 = g1 + 1; g2 < (addback ? griffin.GetSuppressedAddbackMultiplicity(&grifBgo) : griffin.GetSuppressedMultiplicity(&grifBgo)); ++g2) {
                   if(singleCrystal && griffin.GetNSuppressedAddbackFrags(g2) > 1) { continue; }
                   auto* grif2 = (addback ? griffin.GetSuppressedAddbackHit(g2) : griffin.GetSuppressedHit(g2));
-                  // calculate the angle
-                  double angle = grif1->GetPosition(distance).Angle(grif2->GetPosition(distance)) * 180. / TMath::Pi();
+                  // look up the angle index of this pair of crystals
+                  int angleIndex = angles.Index(grif1->GetDetector(), grif1->GetCrystal(), grif2->GetDetector(), grif2->GetCrystal());
                   if(verboseLevel > 4) {
+                     double angle = TGriffin::GetCrystalAngle(grif1->GetDetector(), grif1->GetCrystal(), grif2->GetDetector(), grif2->GetCrystal(), distance) * 180. / TMath::Pi();
                      std::cout << "det,/cry. " << grif1->GetDetector() << "/" << grif1->GetCrystal() << " with " << grif2->GetDetector() << "/" << grif2->GetCrystal() << " = " << angle << std::endl;
-                  }
-                  int angleIndex = 0;
-                  if(verboseLevel < 3) {
-                     TRedirect r("/dev/null");
-                     angleIndex = angles.Index(angle);
-                  } else {
-                     angleIndex = angles.Index(angle);
-                  }
-                  if(verboseLevel > 4) {
                      std::cout << "Filling histograms at index " << angleIndex << " = " << angle << " degree, with " << grif1->GetEnergy() << ", " << grif2->GetEnergy() << std::endl;
+                  } else if(verboseLevel > 2 && angleIndex < 0) {
+                     std::cout << "Failed to find angle index for det./cry. " << grif1->GetDetector() << "/" << grif1->GetCrystal() << " with " << grif2->GetDetector() << "/" << grif2->GetCrystal() << std::endl;
                   }
                   if(angleIndex >= 0) {
                      angleMatrix[c].at(angleIndex)->Fill(grif1->GetEnergy(), grif2->GetEnergy());
@@ -0,0 +1,145 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TChain.h"
+
+#include "Globals.h"
+#include "TChannel.h"
+#include "TDescant.h"
+#include "TSceptar.h"
+#include "TWaveformBatch.h"
+#include "TZeroDegree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// This program compares the inline waveform analysis (AnalyzeWaveform called
+/// on one hit after the other) with the batch mode of TWaveformBatch, for all
+/// DESCANT, ZeroDegree, and SCEPTAR hits with waveforms in the AnalysisTree(s).
+/// The hits are read into memory first, so only the analysis itself is timed.
+/// It also checks that both modes give the same CFD and charge for each hit.
+///
+/// The number of threads is set by the user setting "Waveform.AnalysisThreads"
+/// (by default none, i.e. the batches are analysed by the main thread alone).
+///
+////////////////////////////////////////////////////////////////////////////////
+
+template <class TDet, class THit>
+std::vector<THit> ReadHits(TChain& chain, const char* branchName, int64_t maxHits)
+{
+   std::vector<THit> hits;
+   if(chain.FindBranch(branchName) == nullptr) {
+      return hits;
+   }
+   TDet* detector = nullptr;
+   chain.SetBranchAddress(branchName, &detector);
+   for(int64_t entry = 0; entry < chain.GetEntries() && static_cast<int64_t>(hits.size()) < maxHits; ++entry) {
+      chain.GetEntry(entry);
+      for(int i = 0; i < detector->GetMultiplicity(); ++i) {
+         auto* hit = static_cast<THit*>(detector->GetHit(i));
+         if(hit->HasWave()) {
+            hits.emplace_back();
+            hit->Copy(hits.back(), true);
+         }
+      }
+   }
+   chain.ResetBranchAddress(chain.GetBranch(branchName));
+   delete detector;
+   return hits;
+}
+
+template <class THit>
+std::vector<THit> CopyHits(const std::vector<THit>& hits)
+{
+   std::vector<THit> copies;
+   copies.reserve(hits.size());
+   for(const auto& hit : hits) {
+      copies.emplace_back();
+      hit.Copy(copies.back(), true);
+   }
+   return copies;
+}
+
+template <class THit>
+void Benchmark(const char* name, const std::vector<THit>& hits, const std::vector<size_t>& chunkSizes)
+{
+   if(hits.empty()) {
+      std::cout << name << ": no hits with waveforms" << std::endl;
+      return;
+   }
+
+   // inline
+   std::vector<THit> inlineHits = CopyHits(hits);
+   auto start = std::chrono::steady_clock::now();
+   for(auto& hit : inlineHits) {
+      hit.AnalyzeWaveform();
+   }
+   double inlineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << DGREEN << name << ": " << hits.size() << " hits, inline " << inlineSeconds << " s (" << hits.size() / inlineSeconds << " hits/s)" << RESET_COLOR << std::endl;
+
+   // batch mode with the different chunk sizes
+   for(auto chunkSize : chunkSizes) {
+      // the batch analyses the hits in place, so each chunk size gets its own copy (made before the timing starts)
+      std::vector<THit> batchHits  = CopyHits(hits);
+      size_t            index      = 0;
+      size_t            mismatches = 0;
+      auto              compare    = [&](THit& hit, bool) {
+         if(hit.GetCfd() != inlineHits[index].GetCfd() || hit.GetCharge() != inlineHits[index].GetCharge()) {
+            ++mismatches;
+         }
+         ++index;
+      };
+      TWaveformBatch<THit> batch(compare, chunkSize);
+      start = std::chrono::steady_clock::now();
+      for(auto& hit : batchHits) {
+         batch.Add(hit);
+      }
+      batch.Flush();
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "   chunk size " << chunkSize << ": " << seconds << " s (" << hits.size() / seconds << " hits/s, speed-up " << inlineSeconds / seconds << ")";
+      if(mismatches > 0) {
+         std::cout << DRED << ", " << mismatches << " hits differ from the inline analysis!" << RESET_COLOR;
+      }
+      std::cout << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   if(argc < 2) {
+      std::cout << "Usage: " << argv[0] << " <analysis tree file(s)> [-c <chunk size>] [-n <max. number of hits per detector>]" << std::endl;
+      return 1;
+   }
+
+   std::vector<size_t> chunkSizes;
+   int64_t             maxHits = 1000000;
+   TChain              chain("AnalysisTree");
+   for(int i = 1; i < argc; ++i) {
+      std::string argument = argv[i];
+      if(argument == "-c" && i + 1 < argc) {
+         chunkSizes.push_back(std::strtoul(argv[++i], nullptr, 10));
+      } else if(argument == "-n" && i + 1 < argc) {
+         maxHits = std::strtoll(argv[++i], nullptr, 10);
+      } else {
+         chain.Add(argv[i]);
+      }
+   }
+   if(chunkSizes.empty()) {
+      chunkSizes = {1, 16, 64, 256, 1024};
+   }
+   if(chain.GetEntries() == 0) {
+      std::cout << "Failed to find any entries in the AnalysisTree(s)!" << std::endl;
+      return 1;
+   }
+   TChannel::ReadCalFromTree(&chain);
+
+   std::cout << "Using " << WaveformAnalysisPool().Size() << " worker thread(s) plus the main thread" << std::endl;
+
+   Benchmark("DESCANT", ReadHits<TDescant, TDescantHit>(chain, "TDescant", maxHits), chunkSizes);
+   Benchmark("ZeroDegree", ReadHits<TZeroDegree, TZeroDegreeHit>(chain, "TZeroDegree", maxHits), chunkSizes);
+   Benchmark("SCEPTAR", ReadHits<TSceptar, TSceptarHit>(chain, "TSceptar", maxHits), chunkSizes);
+
+   return 0;
+}